@@ -12,7 +12,6 @@ from ServoController import execute, move_to_default
 from subprocess import run, Popen, PIPE
 from numpy import zeros, asarray
 from time import sleep
-from io import TextIOWrapper
 
 setwarnings(False) # Ignore warnings from GPIO
 setmode(BOARD) # Use physical pin numbering
@@ -20,6 +19,58 @@ setup(10, IN, pull_up_down=PUD_DOWN) # Set pin 10 to be an input pin and set ini
 setup(11, OUT)
 output(11, LOW)
 
+# Keep one solver running in server mode so the F2L, last layer and servo tables
+# are only loaded once instead of on every solve. servostream hands the servocode
+# over in chunks so the robot can start on the xcross while the rest is solved,
+# but those solves run about 4 seconds longer on the robot, so it's off by default
+STREAM_SERVOCODE = False
+
+def startSolver():
+    return Popen(
+        ["/home/pi/Documents/rubiks-cube-solver/solverc/shiftcube/solverpi",
+         "--server", "-i", "shiftcube", "-o", "servostream" if STREAM_SERVOCODE else "servocode"],
+        cwd="/home/pi/Documents/rubiks-cube-solver/solverc/shiftcube/",
+        stdin=PIPE, stdout=PIPE, close_fds=True, text=True, bufsize=1)
+
+solver = startSolver()
+
+def solverExited():
+    # the solver is started again so the next solve gets a fresh one
+    global solver
+    code = solver.wait()
+    solver = startSolver()
+    return f"solver exited with code {code}, restarted it"
+
+def solveShiftCube(shiftCubeArr):
+    # executes the servocode line, or with streaming every 'chunk:' line as it
+    # arrives until 'done'. Returns the error line if the solve failed and None
+    # otherwise
+    if solver.poll() is not None:
+        print(solverExited())
+    try:
+        solver.stdin.write(" ".join(f"{face:x}" for face in shiftCubeArr[:6]) + "\n")
+        solver.stdin.flush()
+    except BrokenPipeError:
+        return solverExited()
+    while True:
+        line = solver.stdout.readline()
+        if line == "":
+            return solverExited()
+        if line.startswith("error:"):
+            return line
+        if not STREAM_SERVOCODE:
+            print(f"Executing servocode: {line}")
+            execute(line)
+            return None
+        if line.startswith("chunk:"):
+            servocode = line[len("chunk: "):]
+            print(f"Executing servocode: {servocode}")
+            execute(servocode)
+        elif line.startswith("done"):
+            return None
+        else:
+            return line
+
 
 def scanCube():
     # Start Scanning and initalize colors
@@ -72,19 +123,8 @@ while True:
         print(f"{shiftCubeArr[3]:x}")
         print(f"{shiftCubeArr[4]:x}")
         print(f"{shiftCubeArr[5]:x}")
-        solverOut = Popen(
-            "/home/pi/Documents/rubiks-cube-solver/solverc/shiftcube/solverpi " +
-            "-i shiftcube -o servocode " +
-            f"{shiftCubeArr[0]:x} " +
-            f"{shiftCubeArr[1]:x} " +
-            f"{shiftCubeArr[2]:x} " +
-            f"{shiftCubeArr[3]:x} " +
-            f"{shiftCubeArr[4]:x} " +
-            f"{shiftCubeArr[5]:x} ",
-            cwd="/home/pi/Documents/rubiks-cube-solver/solverc/shiftcube/",
-            shell=True, close_fds=True, stdout=PIPE).stdout
-        for i in TextIOWrapper(solverOut, encoding="utf-8"):
-            print(f"Executing servocode: {i}")
-            execute(i)
+        error = solveShiftCube(shiftCubeArr)
+        if error is not None:
+            print(f"Solver failed: {error}")
         move_to_default()
         print("Ready To Go!")
@@ -4,35 +4,28 @@
 #include "shift_cube.h"
 
 typedef struct {
-    cube18B_F2L_s key;
-    alg_list_s algs;
-} F2L_entry_s;
+    uint32_t num_algs;
+    uint32_t size;
+    packed_alg_t *algs;
+    // what each alg in algs does to every cubie, so applying one is a single
+    // lookup per cubie no matter how long the alg is
+    cubieTable_s *cubieTables;
+} F2L_algs_s;
 
-typedef struct F2L_table {
-    size_t entries;
-    size_t size;
+HASH_TABLE_DEFINE(F2L_map, cube18B_F2L_key_t, F2L_algs_s, compare_cube18B_keys)
 
-    F2L_entry_s *table;
+typedef struct F2L_table {
+    F2L_map_s map;
 } F2L_table_s;
 
-F2L_table_s* F2L_table_create(size_t size) {
+F2L_table_s* F2L_table_create(size_t num_entries) {
     F2L_table_s *ct = (F2L_table_s*)malloc(sizeof(F2L_table_s));
 
-    ct->table = (F2L_entry_s*)calloc(size, sizeof(F2L_entry_s));
-
-    ct->entries = 0;
-    ct->size    = size;
-    return ct;
-}
-
-size_t F2L_table_hash(const F2L_table_s *ct, const cube18B_F2L_s *key) {
-    size_t hash = 0;
-    for (uint8_t ind = 0; ind < 8; ind++) {
-        hash ^= key->cubies[ind];
-        hash  = rolq(hash, 3);
+    if (!F2L_map_init(&ct->map, num_entries)) {
+        free(ct);
+        return NULL;
     }
-
-    return hash % ct->size;
+    return ct;
 }
 
 bool F2L_table_insert(F2L_table_s *ct, const cube18B_F2L_s *key, const alg_s *moves) {
@@ -40,126 +33,110 @@ bool F2L_table_insert(F2L_table_s *ct, const cube18B_F2L_s *key, const alg_s *mo
         return false;
     }
 
-    size_t hash = F2L_table_hash(ct, key);
-    size_t index = hash;
-
-    // linear probing
-    while (ct->table[index].algs.list != NULL) {
-        if (compare_cube18B_F2L(&(ct->table[index].key), key)) {
-            if (ct->table[index].algs.num_algs == ct->table[index].algs.size) {
-                size_t new_size = 2*sizeof(alg_s)*ct->table[index].algs.size;
-                alg_s *tmp = realloc(ct->table[index].algs.list, new_size);
-
-                if (!tmp) {
-                    return false;
-                }
-
-                ct->table[index].algs.list = tmp;
-                ct->table[index].algs.size *=2;
-            }
-
-            ct->table[index].algs.list[ct->table[index].algs.num_algs] = alg_static_copy(moves);
-            ct->table[index].algs.num_algs++;
+    packed_alg_t packed;
+    if (!packed_alg_from_alg(moves, &packed)) {
+        printf("F2L algs can be at most %d moves long\n", PACKED_ALG_MAX_MOVES);
+        return false;
+    }
 
-            return true;
+    bool inserted;
+    cube18B_F2L_key_t packed_key = cube18B_F2L_pack(key);
+    F2L_map_slot_s *slot = F2L_map_insert(&ct->map, &packed_key, &inserted);
+    if (!slot) {
+        return false;
+    }
+    F2L_algs_s *entry = &slot->value;
+
+    if (inserted) {
+        entry->algs = (packed_alg_t*)malloc(sizeof(packed_alg_t));
+        entry->cubieTables = (cubieTable_s*)malloc(sizeof(cubieTable_s));
+        entry->num_algs = 0;
+        entry->size = 1;
+    } else if (entry->num_algs == entry->size) {
+        size_t new_size = 2*sizeof(packed_alg_t)*entry->size;
+        packed_alg_t *tmp = realloc(entry->algs, new_size);
+
+        if (!tmp) {
+            return false;
         }
+        entry->algs = tmp;
+
+        size_t new_tables_size = 2*sizeof(cubieTable_s)*entry->size;
+        cubieTable_s *tmp_tables = realloc(entry->cubieTables, new_tables_size);
 
-        index++;
-        if (index == hash) {
+        if (!tmp_tables) {
             return false;
         }
+        entry->cubieTables = tmp_tables;
 
-        if (index >= ct->size) {
-            index = 0;
-        }
+        entry->size *=2;
     }
 
-
-    ct->table[index].key  = *key;
-
-    ct->entries++;
-
-    ct->table[index].algs.list = (alg_s*)malloc(sizeof(alg_s));
-    ct->table[index].algs.list[0] = alg_static_copy(moves);
-
-    ct->table[index].algs.num_algs = 1;
-    ct->table[index].algs.size = 1;
+    entry->cubieTables[entry->num_algs] = alg_to_cubieTable(moves);
+    entry->algs[entry->num_algs] = packed;
+    entry->num_algs++;
 
     return true;
 }
 
-static inline size_t F2L_table_get_cube_index(const F2L_table_s *ct, const cube18B_F2L_s *cube) {
-    if (ct == NULL || cube == NULL) {
-        return ct->size;
+// returns the num_algs algs for cube, and if cubieTables isn't NULL it's
+// pointed at their cubieTables in the same order
+const packed_alg_t* F2L_table_lookup(const F2L_table_s *ct, const cube18B_F2L_s *cube, size_t *num_algs,
+                                     const cubieTable_s **cubieTables) {
+    cube18B_F2L_key_t key = cube18B_F2L_pack(cube);
+    const F2L_map_slot_s *slot = F2L_map_find(&ct->map, &key);
+    if (slot == NULL) {
+        return NULL;
     }
 
-    size_t hash = F2L_table_hash(ct, cube);
-    size_t index = hash;
-
-    while (ct->table[index].algs.list != NULL) {
-        if (compare_cube18B_F2L(&(ct->table[index].key), cube)) {
-            return index;
-        }
-
-        if (index + 1 == hash) {
-            break;
-        }
-
-        index = (index + 1 >= ct->size) ? 0 : index + 1;
+    *num_algs = slot->value.num_algs;
+    if (cubieTables) {
+        *cubieTables = slot->value.cubieTables;
     }
-
-    return ct->size;
-}
-
-const alg_list_s* F2L_table_lookup(const F2L_table_s *ct, const cube18B_F2L_s *cube) {
-    size_t index = F2L_table_get_cube_index(ct, cube);
-
-    return (index == ct->size) ? NULL : &ct->table[index].algs;
+    return slot->value.algs;
 }
 
 void F2L_table_clear(F2L_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
+    if (ct == NULL || ct->map.slots == NULL) {
         return;
     }
 
-    for (size_t index = 0; index < ct->size; index++) {
-        if (ct->table[index].algs.list != NULL) {
-            for (size_t i = 0; i < ct->table[index].algs.num_algs; i++) {
-                free(ct->table[index].algs.list[i].moves);
-            }
-
-            free(ct->table[index].algs.list);
-            ct->table[index].algs.list = NULL;
+    for (size_t index = 0; index < ct->map.capacity; index++) {
+        if (F2L_map_slot_used(&ct->map, index)) {
+            free(ct->map.slots[index].value.algs);
+            free(ct->map.slots[index].value.cubieTables);
         }
     }
 
-    ct->entries = 0;
+    F2L_map_clear(&ct->map);
 }
 
 void F2L_table_free(F2L_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
-        free(ct);
+    if (ct == NULL) {
         return;
     }
 
     F2L_table_clear(ct);
 
-    free(ct->table);
+    F2L_map_destroy(&ct->map);
     free(ct);
 }
 
 void F2L_table_print(F2L_table_s *ct) {
     printf("   index  |               cube string representation            | algorithm\n");
     printf("------------------------------------------------------------------------------\n");
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].algs.list != NULL) {
+    for (size_t idx = 0; idx < ct->map.capacity; idx++) {
+        if (F2L_map_slot_used(&ct->map, idx)) {
+            move_e moves[PACKED_ALG_MAX_MOVES];
+            alg_s alg = packed_alg_unpack(ct->map.slots[idx].value.algs[0], moves);
+            cube18B_F2L_s cube = cube18B_F2L_unpack(ct->map.slots[idx].key);
             printf("%10zu ", idx);
-            print_cube18B_F2L(&(ct->table[idx].key));
-            print_alg(&ct->table[idx].algs.list[0]);
+            print_cube18B_F2L(&cube);
+            print_alg(&alg);
         }
 
         if (idx != 0) {
-            if (ct->table[idx].algs.list == NULL && ct->table[idx-1].algs.list != NULL) {
+            if (!F2L_map_slot_used(&ct->map, idx) && F2L_map_slot_used(&ct->map, idx-1)) {
                 printf("                                    ...                                    \n");
             }
         }
@@ -167,9 +144,13 @@ void F2L_table_print(F2L_table_s *ct) {
 }
 
 size_t F2L_table_entries(const F2L_table_s *ct) {
-    return ct->entries;
+    return ct->map.entries;
 }
 
 size_t F2L_table_size(const F2L_table_s *ct) {
-    return ct->size;
+    return ct->map.capacity;
+}
+
+hash_table_stats_s F2L_table_stats(const F2L_table_s *ct) {
+    return F2L_map_stats(&ct->map);
 }
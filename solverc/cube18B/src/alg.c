@@ -66,7 +66,8 @@ bool alg_insert(alg_s *alg, move_e move, size_t index) {
     return true;
 }
 
-bool alg_delete(alg_s *alg, size_t index) {
+// alg_delete without ever giving memory back, so it's safe on arena algs too
+static bool alg_delete_keep_size(alg_s *alg, size_t index) {
     // don't try to delete if index is out of bounds
     if (index >= alg->length) {
         return false;
@@ -79,6 +80,13 @@ bool alg_delete(alg_s *alg, size_t index) {
                       sizeof(move_e) * (alg->length - (index + 1)));
     }
     alg->length--;
+    return true;
+}
+
+bool alg_delete(alg_s *alg, size_t index) {
+    if (!alg_delete_keep_size(alg, index)) {
+        return false;
+    }
 
     // for memory leak protection: decrease the size of the move moves if length <= 1/4 size
     // and the length is still greater than INIT_alg_SIZE
@@ -122,7 +130,8 @@ size_t alg_lookup(const alg_s *alg, move_e move) {
 }
 
 // simplify move sequences in the move moves
-void alg_simplify(alg_s *alg) {
+// can_shrink is false for arena algs, which must never be realloced
+static void simplify(alg_s *alg, bool can_shrink) {
     if (alg == NULL) {
         return;
     }
@@ -138,7 +147,7 @@ void alg_simplify(alg_s *alg) {
         while (move_faces[alg->moves[idx]] == move_faces[alg->moves[idx2]]) {
             alg->moves[idx] = move_e_add(alg->moves[idx], alg->moves[idx2]);
             //alg->moves[idx].turns += alg->moves[idx2].turns;
-            alg_delete(alg, idx2);
+            can_shrink ? alg_delete(alg, idx2) : alg_delete_keep_size(alg, idx2);
 
             // if we can't delete any more alg after this, stop
             if (idx2 >= alg->length || idx >= alg->length) {
@@ -153,7 +162,7 @@ void alg_simplify(alg_s *alg) {
          * to account for new potential simplifications of earlier alg.
          */
         if (alg->moves[idx] == MOVE_NULL) {
-            alg_delete(alg, idx);
+            can_shrink ? alg_delete(alg, idx) : alg_delete_keep_size(alg, idx);
             while (--idx > 0) {
                 if (!(move_faces[alg->moves[idx]] == opposite_faces[move_faces[alg->moves[idx - 1]]] ||
                     move_faces[alg->moves[idx]] == move_faces[alg->moves[idx-1]])) {
@@ -169,6 +178,10 @@ void alg_simplify(alg_s *alg) {
     }
 }
 
+void alg_simplify(alg_s *alg) {
+    simplify(alg, true);
+}
+
 ///////////////////////////// MUST CONVERT TO MOVE_E /////////////////////////////
 alg_s* alg_from_alg_str(const char *alg_str) {
     if (alg_str == NULL) {
@@ -234,6 +247,30 @@ void alg_rotate_on_y(alg_s *alg, uint8_t y_turns) {
     }
 }
 
+void alg_rotate(alg_s *alg, face_e cross_face, uint8_t y_turns) {
+    if (alg == NULL || alg->moves == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < alg->length; i++) {
+        alg->moves[i] = move_rotated[cross_face][mod4(y_turns)][alg->moves[i]];
+    }
+}
+
+void alg_rotate_back(alg_s *alg, face_e cross_face, uint8_t y_turns) {
+    if (alg == NULL || alg->moves == NULL) {
+        return;
+    }
+
+    move_e unrotated[NUM_MOVES];
+    for (move_e move = 0; move < NUM_MOVES; move++) {
+        unrotated[move_rotated[cross_face][mod4(y_turns)][move]] = move;
+    }
+    for (int i = 0; i < alg->length; i++) {
+        alg->moves[i] = unrotated[alg->moves[i]];
+    }
+}
+
 move_e* alg_concat(alg_s *dest, const alg_s *src) {
     if (!dest || !src) {
         return NULL;
@@ -281,4 +318,74 @@ void alg_list_free(alg_list_s *alg_list) {
     }
     free(alg_list->list);
     free(alg_list);
-}
\ No newline at end of file
+}
+alg_s* alg_arena_create(arena_s *arena, size_t size) {
+    alg_s *alg = (alg_s*)arena_alloc(arena, sizeof(alg_s));
+
+    alg->moves = (move_e*)arena_alloc(arena, size * sizeof(move_e));
+    alg->length = 0;
+    alg->size = size;
+
+    return alg;
+}
+
+alg_s* alg_arena_copy(arena_s *arena, const alg_s *src) {
+    if (!src) return NULL;
+
+    alg_s *copy = alg_arena_create(arena, src->length);
+
+    (void)memcpy(copy->moves, src->moves, src->length * sizeof(move_e));
+    copy->length = src->length;
+
+    return copy;
+}
+
+move_e* alg_arena_concat(arena_s *arena, alg_s *dest, const alg_s *src) {
+    if (!dest || !src) {
+        return NULL;
+    }
+
+    // the old moves stay behind in the arena
+    size_t new_len = dest->length + src->length;
+    if (new_len > dest->size) {
+        size_t new_size = (2*dest->size > new_len) ? 2*dest->size : new_len;
+        move_e *tmp = (move_e*)arena_alloc(arena, sizeof(move_e)*new_size);
+        if (!tmp) {
+            return NULL;
+        }
+        (void)memcpy(tmp, dest->moves, dest->length * sizeof(move_e));
+        dest->moves = tmp;
+        dest->size = new_size;
+    }
+
+    return alg_concat(dest, src);
+}
+
+void alg_arena_simplify(alg_s *alg) {
+    simplify(alg, false);
+}
+
+alg_list_s* alg_list_arena_create(arena_s *arena, size_t size) {
+    alg_list_s* alg_list = (alg_list_s*)arena_alloc(arena, sizeof(alg_list_s));
+
+    alg_list->list = (alg_s*)arena_alloc(arena, size * sizeof(alg_s));
+    alg_list->num_algs = 0;
+    alg_list->size = size;
+
+    return alg_list;
+}
+
+void alg_list_arena_append(arena_s *arena, alg_list_s *alg_list, const alg_s* alg) {
+    if (alg_list->num_algs == alg_list->size) {
+        alg_s *tmp = (alg_s*)arena_alloc(arena, 2 * alg_list->size * sizeof(alg_s));
+        (void)memcpy(tmp, alg_list->list, alg_list->num_algs * sizeof(alg_s));
+        alg_list->list = tmp;
+        alg_list->size *= 2;
+    }
+    alg_s *copy = &alg_list->list[alg_list->num_algs];
+    copy->moves = (move_e*)arena_alloc(arena, alg->length * sizeof(move_e));
+    (void)memcpy(copy->moves, alg->moves, alg->length * sizeof(move_e));
+    copy->length = alg->length;
+    copy->size = alg->length;
+    alg_list->num_algs++;
+}
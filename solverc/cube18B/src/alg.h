@@ -2,6 +2,7 @@
 #define ALG_H
 
 #include "main.h"
+#include "arena.h"
 #include "move.h"
 
 typedef struct {
@@ -32,6 +33,9 @@ alg_s* alg_from_alg_str(const char *alg_str);
 void alg_invert(alg_s *alg);
 void alg_simplify(alg_s *alg);
 void alg_rotate_on_y(alg_s *alg, uint8_t y_turns);
+// turns alg with the whole cube, see rotate_cube in lookup_tables.h, and back again
+void alg_rotate(alg_s *alg, face_e cross_face, uint8_t y_turns);
+void alg_rotate_back(alg_s *alg, face_e cross_face, uint8_t y_turns);
 
 move_e* alg_concat(alg_s *dest, const alg_s *src);
 
@@ -40,4 +44,14 @@ alg_list_s* alg_list_create(size_t size);
 void alg_list_append(alg_list_s *alg_list, const alg_s* alg);
 void alg_list_free(alg_list_s *alg_list);
 
+// The same as above except everything comes out of arena and is never freed on
+// its own, it all goes when the arena is reset. Growing an alg or list from an
+// arena has to go through these too, the plain versions would realloc it
+alg_s* alg_arena_create(arena_s *arena, size_t size);
+alg_s* alg_arena_copy(arena_s *arena, const alg_s *src);
+move_e* alg_arena_concat(arena_s *arena, alg_s *dest, const alg_s *src);
+void alg_arena_simplify(alg_s *alg);
+alg_list_s* alg_list_arena_create(arena_s *arena, size_t size);
+void alg_list_arena_append(arena_s *arena, alg_list_s *alg_list, const alg_s* alg);
+
 #endif // ALG_H
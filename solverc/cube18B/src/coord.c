@@ -0,0 +1,208 @@
+#include "coord.h"
+
+// ranks n distinct slots out of num_slots as a partial permutation, each slot
+// is counted among the slots the earlier ones didn't take
+static uint32_t rank_slots(const uint8_t *slots, uint8_t n, uint8_t num_slots) {
+    uint32_t rank = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t smaller_taken = 0;
+        for (uint8_t j = 0; j < i; j++) {
+            smaller_taken += slots[j] < slots[i];
+        }
+        rank = rank*(num_slots - i) + slots[i] - smaller_taken;
+    }
+    return rank;
+}
+
+static void unrank_slots(uint32_t rank, uint8_t *slots, uint8_t n, uint8_t num_slots) {
+    uint8_t relative[4];
+    for (int8_t i = n - 1; i >= 0; i--) {
+        relative[i] = rank % (num_slots - i);
+        rank /= num_slots - i;
+    }
+
+    bool taken[NUM_EDGE_SLOTS] = {false};
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t slot = 0;
+        for (uint8_t free_slots = 0; taken[slot] || free_slots < relative[i]; slot++) {
+            free_slots += !taken[slot];
+        }
+        slots[i] = slot;
+        taken[slot] = true;
+    }
+}
+
+// n pieces with num_orientations orientations each, numbered by slot then
+// orientation the way cube18B numbers its cubies
+static uint32_t pieces_coord(const cubie_e *cubies, uint8_t n, uint8_t first_cubie,
+                             uint8_t num_orientations, uint8_t num_slots) {
+    uint8_t slots[4];
+    uint32_t orientations = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        slots[i] = (cubies[i] - first_cubie) / num_orientations;
+        orientations = orientations*num_orientations + (cubies[i] - first_cubie) % num_orientations;
+    }
+
+    uint32_t num_orientation_coords = 1;
+    for (uint8_t i = 0; i < n; i++) {
+        num_orientation_coords *= num_orientations;
+    }
+    return rank_slots(slots, n, num_slots)*num_orientation_coords + orientations;
+}
+
+static void pieces_from_coord(uint32_t coord, cubie_e *cubies, uint8_t n, uint8_t first_cubie,
+                              uint8_t num_orientations, uint8_t num_slots) {
+    uint8_t orientations[4];
+    for (int8_t i = n - 1; i >= 0; i--) {
+        orientations[i] = coord % num_orientations;
+        coord /= num_orientations;
+    }
+
+    uint8_t slots[4];
+    unrank_slots(coord, slots, n, num_slots);
+    for (uint8_t i = 0; i < n; i++) {
+        cubies[i] = first_cubie + slots[i]*num_orientations + orientations[i];
+    }
+}
+
+uint32_t cross_coord_from_cubies(const cubie_e cubies[4]) {
+    return pieces_coord(cubies, 4, CUBIE_UR, 2, NUM_EDGE_SLOTS);
+}
+
+void cross_coord_to_cubies(uint32_t coord, cubie_e cubies[4]) {
+    pieces_from_coord(coord, cubies, 4, CUBIE_UR, 2, NUM_EDGE_SLOTS);
+}
+
+uint16_t LL_edges_coord_from_cubies(const cubie_e cubies[3]) {
+    return pieces_coord(cubies, 3, CUBIE_UR, 2, NUM_EDGE_SLOTS);
+}
+
+void LL_edges_coord_to_cubies(uint16_t coord, cubie_e cubies[3]) {
+    pieces_from_coord(coord, cubies, 3, CUBIE_UR, 2, NUM_EDGE_SLOTS);
+}
+
+uint16_t LL_corners_coord_from_cubies(const cubie_e cubies[3]) {
+    return pieces_coord(cubies, 3, CUBIE_FUR, 3, NUM_CORNER_SLOTS);
+}
+
+void LL_corners_coord_to_cubies(uint16_t coord, cubie_e cubies[3]) {
+    pieces_from_coord(coord, cubies, 3, CUBIE_FUR, 3, NUM_CORNER_SLOTS);
+}
+
+coord_xcross1_s coord_xcross1_from_cube18B_xcross1(const cube18B_xcross1_s *cube) {
+    coord_xcross1_s coord = {
+        .cross  = cross_coord_from_cubies(cube->cubies),
+        .edge   = cube->cubies[4] - CUBIE_UR,
+        .corner = cube->cubies[5] - CUBIE_FUR,
+    };
+    return coord;
+}
+
+cube18B_xcross1_s cube18B_xcross1_from_coord_xcross1(const coord_xcross1_s *coord) {
+    cube18B_xcross1_s cube;
+    cross_coord_to_cubies(coord->cross, cube.cubies);
+    cube.cubies[4] = CUBIE_UR + coord->edge;
+    cube.cubies[5] = CUBIE_FUR + coord->corner;
+    return cube;
+}
+
+coord_1LLL_s coord_1LLL_from_cube18B_1LLL(const cube18B_1LLL_s *cube) {
+    coord_1LLL_s coord = {
+        .edges   = LL_edges_coord_from_cubies(cube->cubies),
+        .corners = LL_corners_coord_from_cubies(cube->cubies + 3),
+    };
+    return coord;
+}
+
+cube18B_1LLL_s cube18B_1LLL_from_coord_1LLL(const coord_1LLL_s *coord) {
+    cube18B_1LLL_s cube;
+    LL_edges_coord_to_cubies(coord->edges, cube.cubies);
+    LL_corners_coord_to_cubies(coord->corners, cube.cubies + 3);
+    return cube;
+}
+
+coord_tables_s* coord_tables_create(void) {
+    coord_tables_s *tables = (coord_tables_s*)calloc(1, sizeof(coord_tables_s));
+    if (!tables) {
+        return NULL;
+    }
+
+    tables->cross      = malloc(NUM_CROSS_COORDS * sizeof(*tables->cross));
+    tables->LL_edges   = malloc(NUM_LL_EDGES_COORDS * sizeof(*tables->LL_edges));
+    tables->LL_corners = malloc(NUM_LL_CORNERS_COORDS * sizeof(*tables->LL_corners));
+    tables->cross_slots = malloc(NUM_CROSS_COORDS * sizeof(*tables->cross_slots));
+    if (!tables->cross || !tables->LL_edges || !tables->LL_corners || !tables->cross_slots) {
+        coord_tables_free(tables);
+        return NULL;
+    }
+
+    for (uint8_t coord = 0; coord < NUM_EDGE_COORDS; coord++) {
+        for (move_e move = 0; move < NUM_MOVES; move++) {
+            tables->edge[coord][move] = cubieAfterMove[move][CUBIE_UR + coord] - CUBIE_UR;
+            tables->corner[coord][move] = cubieAfterMove[move][CUBIE_FUR + coord] - CUBIE_FUR;
+        }
+    }
+
+    for (uint32_t coord = 0; coord < NUM_CROSS_COORDS; coord++) {
+        cubie_e cubies[4];
+        cross_coord_to_cubies(coord, cubies);
+        tables->cross_slots[coord] = 0;
+        for (uint8_t i = 0; i < 4; i++) {
+            tables->cross_slots[coord] |= 1 << (cubies[i] >> 1);
+        }
+        for (move_e move = 0; move < NUM_MOVES; move++) {
+            cubie_e moved[4];
+            for (uint8_t i = 0; i < 4; i++) {
+                moved[i] = cubieAfterMove[move][cubies[i]];
+            }
+            tables->cross[coord][move] = cross_coord_from_cubies(moved);
+        }
+    }
+
+    for (uint16_t coord = 0; coord < NUM_LL_EDGES_COORDS; coord++) {
+        cubie_e cubies[3];
+        LL_edges_coord_to_cubies(coord, cubies);
+        for (move_e move = 0; move < NUM_MOVES; move++) {
+            cubie_e moved[3];
+            for (uint8_t i = 0; i < 3; i++) {
+                moved[i] = cubieAfterMove[move][cubies[i]];
+            }
+            tables->LL_edges[coord][move] = LL_edges_coord_from_cubies(moved);
+        }
+    }
+
+    for (uint16_t coord = 0; coord < NUM_LL_CORNERS_COORDS; coord++) {
+        cubie_e cubies[3];
+        LL_corners_coord_to_cubies(coord, cubies);
+        for (move_e move = 0; move < NUM_MOVES; move++) {
+            cubie_e moved[3];
+            for (uint8_t i = 0; i < 3; i++) {
+                moved[i] = cubieAfterMove[move][cubies[i]];
+            }
+            tables->LL_corners[coord][move] = LL_corners_coord_from_cubies(moved);
+        }
+    }
+
+    return tables;
+}
+
+void coord_tables_free(coord_tables_s *tables) {
+    if (tables == NULL) return;
+    free(tables->cross);
+    free(tables->LL_edges);
+    free(tables->LL_corners);
+    free(tables->cross_slots);
+    free(tables);
+}
+
+void coord_xcross1_apply_alg(const coord_tables_s *tables, coord_xcross1_s *coord, const alg_s *alg) {
+    for (size_t i = 0; i < alg->length; i++) {
+        coord_xcross1_apply_move(tables, coord, alg->moves[i]);
+    }
+}
+
+void coord_1LLL_apply_alg(const coord_tables_s *tables, coord_1LLL_s *coord, const alg_s *alg) {
+    for (size_t i = 0; i < alg->length; i++) {
+        coord_1LLL_apply_move(tables, coord, alg->moves[i]);
+    }
+}
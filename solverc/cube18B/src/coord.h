@@ -0,0 +1,88 @@
+#ifndef COORD_H
+#define COORD_H
+
+#include "main.h"
+#include "move.h"
+#include "cube18B.h"
+
+// Coordinates number the states of the pieces the solver tracks densely from 0,
+// so a state can index a table directly and a move is one lookup in a
+// coord x move table instead of a cubieAfterMove lookup per cubie.
+//
+// Edge cubies 2k and 2k+1 are the two orientations of the edge in slot k and
+// corner cubies 24+3k..26+3k are the three twists of the corner in slot k. The
+// cross edges and the last layer pieces are always in different slots, so
+// their coordinates rank the slots as a partial permutation and then append
+// the orientations.
+
+#define NUM_EDGE_SLOTS   12
+#define NUM_CORNER_SLOTS  8
+
+#define NUM_CROSS_COORDS     190080 // 12*11*10*9 slots * 2^4 orientations
+#define NUM_EDGE_COORDS          24
+#define NUM_CORNER_COORDS        24
+#define NUM_LL_EDGES_COORDS   10560 // 12*11*10 slots * 2^3 orientations
+#define NUM_LL_CORNERS_COORDS  9072 // 8*7*6 slots * 3^3 twists
+
+// the pair's edge can only be in one of the 8 slots the cross isn't in
+#define NUM_XCROSS1_RANKS (NUM_CROSS_COORDS*16*NUM_CORNER_COORDS)
+
+typedef struct {
+    uint32_t cross;   // the 4 cross edges
+    uint8_t edge;     // the pair's edge
+    uint8_t corner;   // the pair's corner
+} coord_xcross1_s;
+
+typedef struct {
+    uint16_t edges;   // the 3 tracked last layer edges
+    uint16_t corners; // the 3 tracked last layer corners
+} coord_1LLL_s;
+
+typedef struct coord_tables {
+    uint32_t (*cross)[NUM_MOVES];
+    uint8_t edge[NUM_EDGE_COORDS][NUM_MOVES];
+    uint8_t corner[NUM_CORNER_COORDS][NUM_MOVES];
+    uint16_t (*LL_edges)[NUM_MOVES];
+    uint16_t (*LL_corners)[NUM_MOVES];
+
+    // bit k is set if a cross edge is in edge slot k
+    uint16_t *cross_slots;
+} coord_tables_s;
+
+coord_tables_s* coord_tables_create(void);
+void coord_tables_free(coord_tables_s *tables);
+
+uint32_t cross_coord_from_cubies(const cubie_e cubies[4]);
+void cross_coord_to_cubies(uint32_t coord, cubie_e cubies[4]);
+uint16_t LL_edges_coord_from_cubies(const cubie_e cubies[3]);
+void LL_edges_coord_to_cubies(uint16_t coord, cubie_e cubies[3]);
+uint16_t LL_corners_coord_from_cubies(const cubie_e cubies[3]);
+void LL_corners_coord_to_cubies(uint16_t coord, cubie_e cubies[3]);
+
+coord_xcross1_s coord_xcross1_from_cube18B_xcross1(const cube18B_xcross1_s *cube);
+cube18B_xcross1_s cube18B_xcross1_from_coord_xcross1(const coord_xcross1_s *coord);
+coord_1LLL_s coord_1LLL_from_cube18B_1LLL(const cube18B_1LLL_s *cube);
+cube18B_1LLL_s cube18B_1LLL_from_coord_1LLL(const coord_1LLL_s *coord);
+
+static inline void coord_xcross1_apply_move(const coord_tables_s *tables, coord_xcross1_s *coord, move_e move) {
+    coord->cross  = tables->cross[coord->cross][move];
+    coord->edge   = tables->edge[coord->edge][move];
+    coord->corner = tables->corner[coord->corner][move];
+}
+
+static inline void coord_1LLL_apply_move(const coord_tables_s *tables, coord_1LLL_s *coord, move_e move) {
+    coord->edges   = tables->LL_edges[coord->edges][move];
+    coord->corners = tables->LL_corners[coord->corners][move];
+}
+
+// a perfect index for xcross1 states, less than NUM_XCROSS1_RANKS
+static inline uint32_t coord_xcross1_rank(const coord_tables_s *tables, const coord_xcross1_s *coord) {
+    uint16_t cross_slots_below = tables->cross_slots[coord->cross] & ((1u << (coord->edge >> 1)) - 1);
+    uint32_t edge = coord->edge - 2*__builtin_popcount(cross_slots_below);
+    return (coord->cross*16 + edge)*NUM_CORNER_COORDS + coord->corner;
+}
+
+void coord_xcross1_apply_alg(const coord_tables_s *tables, coord_xcross1_s *coord, const alg_s *alg);
+void coord_1LLL_apply_alg(const coord_tables_s *tables, coord_1LLL_s *coord, const alg_s *alg);
+
+#endif // COORD_H
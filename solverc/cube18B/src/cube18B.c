@@ -1,6 +1,9 @@
 #include "cube18B.h"
 #include "main.h"
 #include "alg.h"
+#include "move_kernels.h"
+
+#include <pthread.h>
 
 void print_cube18B(const cube18B_s* cube) {
     for (int i = 0; i < 18; i++) {
@@ -377,6 +380,26 @@ void cube_list_free(cube_list_s* cube_list) {
     free(cube_list);
 }
 
+cube_list_s* cube_list_arena_create(arena_s *arena, size_t size) {
+    cube_list_s *list = (cube_list_s*)arena_alloc(arena, sizeof(cube_list_s));
+
+    list->cubes = (cube18B_xcross4_s*)arena_alloc(arena, size * sizeof(cube18B_xcross4_s));
+    list->length = 0;
+    list->size = size;
+
+    return list;
+}
+void cube_list_arena_append(arena_s *arena, cube_list_s* cube_list, const cube18B_xcross4_s* cube) {
+    if (cube_list->length == cube_list->size) {
+        cube18B_xcross4_s *tmp = (cube18B_xcross4_s*)arena_alloc(arena, 2 * cube_list->size * sizeof(cube18B_xcross4_s));
+        (void)memcpy(tmp, cube_list->cubes, cube_list->length * sizeof(cube18B_xcross4_s));
+        cube_list->cubes = tmp;
+        cube_list->size *= 2;
+    }
+    cube_list->cubes[cube_list->length] = *cube;
+    cube_list->length++;
+}
+
 cube18B_xcross4_s cube18B_xcross4_from_cube18B(const cube18B_s* cube) {
     /*
     Tables Used: None
@@ -490,6 +513,128 @@ cube18B_xcross1_s cube18B_xcross4_to_xcross1(const cube18B_xcross4_s* cube, uint
     };
     return xcross1;
 }
+// Edges only ever sit in the edge slots and corners in the corner slots, so a
+// cubie only needs its position among the 24 edge or 24 corner cubies, with 24
+// for a masked slot. That's 5 bits a slot, and 60 bits for the biggest state.
+// corner_slots has a bit set for every slot of the state that holds a corner
+#define CUBIES_KEY_CUBIE_BITS 5
+#define CUBIES_KEY_CUBIE_MASK 0x1fULL
+#define CUBIES_KEY_NULL       24
+
+#define XCROSS4_CORNER_SLOTS 0xaa0
+#define LL_CORNER_SLOTS      0x38
+#define F2L_CORNER_SLOTS     0xaa
+
+static uint64_t cubies_pack(const cubie_e* cubies, int num_cubies) {
+    uint64_t key = 0;
+    for (int i = 0; i < num_cubies; i++) {
+        uint64_t code = (cubies[i] == CUBIE_NULL) ? CUBIES_KEY_NULL : cubies[i] % 24;
+        key |= code << (CUBIES_KEY_CUBIE_BITS*i);
+    }
+    return key;
+}
+static void cubies_unpack(uint64_t key, cubie_e* cubies, int num_cubies, uint32_t corner_slots) {
+    for (int i = 0; i < num_cubies; i++) {
+        uint8_t code = (key >> (CUBIES_KEY_CUBIE_BITS*i)) & CUBIES_KEY_CUBIE_MASK;
+        if (code == CUBIES_KEY_NULL) {
+            cubies[i] = CUBIE_NULL;
+        } else {
+            cubies[i] = (corner_slots >> i & 1) ? code + 24 : code;
+        }
+    }
+}
+cube18B_xcross4_key_t cube18B_xcross4_pack(const cube18B_xcross4_s* cube) {
+    return cubies_pack(cube->cubies, 12);
+}
+cube18B_xcross4_s cube18B_xcross4_unpack(cube18B_xcross4_key_t key) {
+    cube18B_xcross4_s cube;
+    cubies_unpack(key, cube.cubies, 12, XCROSS4_CORNER_SLOTS);
+    return cube;
+}
+// Zobrist hashing: every (slot, cubie) gets a random word and a state hashes to
+// the xor of its slots' words. A move then only has to swap the words of the
+// cubies it moved in and out, instead of hashing the whole state again
+static uint64_t xcross4_zobrist[12][NUM_SEQUENCES+1];
+static uint8_t cubie_key_codes[NUM_SEQUENCES+1];
+static pthread_once_t xcross4_zobrist_once = PTHREAD_ONCE_INIT;
+
+static uint64_t splitmix64(uint64_t *seed) {
+    uint64_t z = (*seed += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+static void xcross4_zobrist_init(void) {
+    // a fixed seed, so tables hash the same way from run to run
+    uint64_t seed = 0x2545f4914f6cdd1dULL;
+    for (int slot = 0; slot < 12; slot++) {
+        for (int cubie = 0; cubie <= NUM_SEQUENCES; cubie++) {
+            xcross4_zobrist[slot][cubie] = splitmix64(&seed);
+        }
+    }
+    for (int cubie = 0; cubie <= NUM_SEQUENCES; cubie++) {
+        cubie_key_codes[cubie] = (cubie == CUBIE_NULL) ? CUBIES_KEY_NULL : cubie % 24;
+    }
+}
+uint64_t cube18B_xcross4_key_hash(const cube18B_xcross4_key_t* key) {
+    pthread_once(&xcross4_zobrist_once, xcross4_zobrist_init);
+    cube18B_xcross4_s cube = cube18B_xcross4_unpack(*key);
+    uint64_t hash = 0;
+    for (int i = 0; i < 12; i++) {
+        hash ^= xcross4_zobrist[i][cube.cubies[i]];
+    }
+    return hash;
+}
+// the hashed moves can only be reached through a state made here, which is
+// what makes sure the tables are filled in before they're used
+cube18B_xcross4_hashed_s cube18B_xcross4_hashed_from(const cube18B_xcross4_s* cube) {
+    cube18B_xcross4_hashed_s hashed = {
+        .cube = *cube,
+        .key = cube18B_xcross4_pack(cube),
+    };
+    hashed.hash = cube18B_xcross4_key_hash(&hashed.key);
+    return hashed;
+}
+cube18B_xcross4_hashed_s cube18B_xcross4_hashed_maskOnPair(const cube18B_xcross4_hashed_s* cube, uint8_t pair) {
+    cube18B_xcross4_hashed_s masked = *cube;
+    cube18B_xcross4_maskOnPair(&masked.cube, pair);
+    for (int i = 4; i < 12; i++) {
+        cubie_e cubie = cube->cube.cubies[i];
+        if (masked.cube.cubies[i] != cubie) {
+            uint64_t shift = CUBIES_KEY_CUBIE_BITS*i;
+            masked.key ^= (uint64_t)(cubie_key_codes[cubie] ^ CUBIES_KEY_NULL) << shift;
+            masked.hash ^= xcross4_zobrist[i][cubie] ^ xcross4_zobrist[i][CUBIE_NULL];
+        }
+    }
+    return masked;
+}
+// a cubie the move didn't touch xors its own word in and out again, which is
+// cheaper than branching on which ones it touched
+void cube18B_xcross4_hashed_apply_move(cube18B_xcross4_hashed_s* cube, move_e move) {
+    for (int i = 0; i < 12; i++) {
+        cubie_e cubie = cube->cube.cubies[i];
+        cubie_e moved = cubieAfterMove[move][cubie];
+        cube->key ^= (uint64_t)(cubie_key_codes[cubie] ^ cubie_key_codes[moved]) << (CUBIES_KEY_CUBIE_BITS*i);
+        cube->hash ^= xcross4_zobrist[i][cubie] ^ xcross4_zobrist[i][moved];
+        cube->cube.cubies[i] = moved;
+    }
+}
+cube18B_1LLL_key_t cube18B_1LLL_pack(const cube18B_1LLL_s* cube) {
+    return cubies_pack(cube->cubies, 6);
+}
+cube18B_1LLL_s cube18B_1LLL_unpack(cube18B_1LLL_key_t key) {
+    cube18B_1LLL_s cube;
+    cubies_unpack(key, cube.cubies, 6, LL_CORNER_SLOTS);
+    return cube;
+}
+cube18B_F2L_key_t cube18B_F2L_pack(const cube18B_F2L_s* cube) {
+    return cubies_pack(cube->cubies, 8);
+}
+cube18B_F2L_s cube18B_F2L_unpack(cube18B_F2L_key_t key) {
+    cube18B_F2L_s cube;
+    cubies_unpack(key, cube.cubies, 8, F2L_CORNER_SLOTS);
+    return cube;
+}
 void cube18B_F2L_maskOnPair(cube18B_F2L_s* cube, uint8_t pair) {
     uint8_t forbiddenI = 6-2*mod4(pair+3);
     cubie_e f2lpairE = cube->cubies[forbiddenI];
@@ -501,49 +646,20 @@ void cube18B_F2L_maskOnPair(cube18B_F2L_s* cube, uint8_t pair) {
 }
 
 bool compare_cube18Bs(const cube18B_s* cube1, const cube18B_s* cube2) {
-    bool res = true;
-    for (int i = 0; i < 18; i++) {
-        if (cube1->cubies[i] != cube2->cubies[i]) {
-            res = false;
-            break;
-        }
-    } return res;
+    // cubies are bytes with no padding, so memcmp comes down to a word compare or two
+    return memcmp(cube1->cubies, cube2->cubies, sizeof(cube1->cubies)) == 0;
 }
 bool compare_cube18B_xcross4(const cube18B_xcross4_s* cube1, const cube18B_xcross4_s* cube2) {
-    bool res = true;
-    for (int i = 0; i < 12; i++) {
-        if (cube1->cubies[i] != cube2->cubies[i]) {
-            res = false;
-            break;
-        }
-    } return res;
+    return memcmp(cube1->cubies, cube2->cubies, sizeof(cube1->cubies)) == 0;
 }
 bool compare_cube18B_xcross1(const cube18B_xcross1_s* cube1, const cube18B_xcross1_s* cube2) {
-    bool res = true;
-    for (int i = 0; i < 6; i++) {
-        if (cube1->cubies[i] != cube2->cubies[i]) {
-            res = false;
-            break;
-        }
-    } return res;
+    return memcmp(cube1->cubies, cube2->cubies, sizeof(cube1->cubies)) == 0;
 }
 bool compare_cube18B_1LLL(const cube18B_1LLL_s* cube1, const cube18B_1LLL_s* cube2) {
-    bool res = true;
-    for (int i = 0; i < 6; i++) {
-        if (cube1->cubies[i] != cube2->cubies[i]) {
-            res = false;
-            break;
-        }
-    } return res;
+    return memcmp(cube1->cubies, cube2->cubies, sizeof(cube1->cubies)) == 0;
 }
 bool compare_cube18B_F2L(const cube18B_F2L_s* cube1, const cube18B_F2L_s* cube2) {
-    bool res = true;
-    for (int i = 0; i < 8; i++) {
-        if (cube1->cubies[i] != cube2->cubies[i]) {
-            res = false;
-            break;
-        }
-    } return res;
+    return memcmp(cube1->cubies, cube2->cubies, sizeof(cube1->cubies)) == 0;
 }
 
 void cube18B_apply_move(cube18B_s* cube, move_e move) {
@@ -632,30 +748,21 @@ void cube18B_F2L_apply_move(cube18B_F2L_s* cube, move_e move) {
     cube->cubies[7] = cubieAfterMove[move][cube->cubies[7]];
 }
 
+// whole algs go through the fastest move kernel the cpu has, see move_kernels.c
 void cube18B_apply_alg(cube18B_s *cube, const alg_s *alg) {
-    for (size_t i = 0; i < alg->length; i++) {
-        cube18B_apply_move(cube, alg->moves[i]);
-    }
+    move_kernel_best()->apply_alg(cube->cubies, 18, alg);
 }
 void cube18B_xcross4_apply_alg(cube18B_xcross4_s *cube, const alg_s *alg) {
-    for (size_t i = 0; i < alg->length; i++) {
-        cube18B_xcross4_apply_move(cube, alg->moves[i]);
-    }
+    move_kernel_best()->apply_alg(cube->cubies, 12, alg);
 }
 void cube18B_xcross1_apply_alg(cube18B_xcross1_s *cube, const alg_s *alg) {
-    for (size_t i = 0; i < alg->length; i++) {
-        cube18B_xcross1_apply_move(cube, alg->moves[i]);
-    }
+    move_kernel_best()->apply_alg(cube->cubies, 6, alg);
 }
 void cube18B_1LLL_apply_alg(cube18B_1LLL_s *cube, const alg_s *alg) {
-    for (size_t i = 0; i < alg->length; i++) {
-        cube18B_1LLL_apply_move(cube, alg->moves[i]);
-    }
+    move_kernel_best()->apply_alg(cube->cubies, 6, alg);
 }
 void cube18B_F2L_apply_alg(cube18B_F2L_s* cube, const alg_s* alg) {
-    for (size_t i = 0; i < alg->length; i++) {
-        cube18B_F2L_apply_move(cube, alg->moves[i]);
-    }
+    move_kernel_best()->apply_alg(cube->cubies, 8, alg);
 }
 
 
@@ -678,6 +785,12 @@ void apply_cubieTable_to_cube(cube18B_s* cube, const cubieTable_s* table) {
     }
 }
 
+void cube18B_1LLL_apply_cubieTable(cube18B_1LLL_s* cube, const cubieTable_s* table) {
+    for (int i = 0; i < 6; i++) {
+        cube->cubies[i] = table->cubieShift[cube->cubies[i]];
+    }
+}
+
 cubieTable_s conjoin_cubeTables(const cubieTable_s* table1, const cubieTable_s* table2) {
     cubieTable_s table;
     for (cubie_e i = 0; i < NUM_CUBIES; i++) {
@@ -319,6 +319,15 @@ typedef struct {
 typedef struct {
     cubie_e cubies[12];
 } cube18B_xcross4_s;
+// an xcross4 state in one word, see cube18B_xcross4_pack
+typedef uint64_t cube18B_xcross4_key_t;
+// an xcross4 state along with its key and hash, which the hashed moves keep
+// up to date by only touching the cubies that moved, see cube18B.c
+typedef struct {
+    cube18B_xcross4_s cube;
+    cube18B_xcross4_key_t key;
+    uint64_t hash;
+} cube18B_xcross4_hashed_s;
 typedef struct {
     cubie_e cubies[6];
 } cube18B_xcross1_s;
@@ -328,6 +337,9 @@ typedef struct {
 typedef struct {
     cubie_e cubies[8];
 } cube18B_F2L_s;
+// the 1LLL and F2L states in one word each, for the tables keyed on them
+typedef uint64_t cube18B_1LLL_key_t;
+typedef uint64_t cube18B_F2L_key_t;
 typedef struct {
     cubie_e cubieShift[48];
 } cubieTable_s;
@@ -371,18 +383,34 @@ static const cube18B_F2L_s SOLVED_CUBE18B_F2L = {
 cube_list_s* cube_list_create(size_t size);
 void cube_list_append(cube_list_s* cube_list, const cube18B_xcross4_s* cube);
 void cube_list_free(cube_list_s* cube_list);
+cube_list_s* cube_list_arena_create(arena_s *arena, size_t size);
+void cube_list_arena_append(arena_s *arena, cube_list_s* cube_list, const cube18B_xcross4_s* cube);
 cube18B_xcross4_s cube18B_xcross4_from_cube18B(const cube18B_s* cube);
 cube18B_1LLL_s cube18B_1LLL_from_cube18B(const cube18B_s* cube);
 cube18B_F2L_s cube18B_F2L_from_cube18B(const cube18B_s* cube);
 cube18B_s cube18B_from_xcross4_and_1LLL(const cube18B_xcross4_s* xcross4, const cube18B_1LLL_s* LL);
 void cube18B_xcross4_maskOnPair(cube18B_xcross4_s* cube, uint8_t pair);
 cube18B_xcross1_s cube18B_xcross4_to_xcross1(const cube18B_xcross4_s* cube, uint8_t pair);
+cube18B_xcross4_key_t cube18B_xcross4_pack(const cube18B_xcross4_s* cube);
+cube18B_xcross4_s cube18B_xcross4_unpack(cube18B_xcross4_key_t key);
+uint64_t cube18B_xcross4_key_hash(const cube18B_xcross4_key_t* key);
+cube18B_xcross4_hashed_s cube18B_xcross4_hashed_from(const cube18B_xcross4_s* cube);
+cube18B_xcross4_hashed_s cube18B_xcross4_hashed_maskOnPair(const cube18B_xcross4_hashed_s* cube, uint8_t pair);
+void cube18B_xcross4_hashed_apply_move(cube18B_xcross4_hashed_s* cube, move_e move);
+cube18B_1LLL_key_t cube18B_1LLL_pack(const cube18B_1LLL_s* cube);
+cube18B_1LLL_s cube18B_1LLL_unpack(cube18B_1LLL_key_t key);
+cube18B_F2L_key_t cube18B_F2L_pack(const cube18B_F2L_s* cube);
+cube18B_F2L_s cube18B_F2L_unpack(cube18B_F2L_key_t key);
 void cube18B_F2L_maskOnPair(cube18B_F2L_s* cube, uint8_t pair);
 bool compare_cube18Bs(const cube18B_s* cube1, const cube18B_s* cube2);
 bool compare_cube18B_xcross4(const cube18B_xcross4_s* cube1, const cube18B_xcross4_s* cube2);
 bool compare_cube18B_xcross1(const cube18B_xcross1_s* cube1, const cube18B_xcross1_s* cube2);
 bool compare_cube18B_1LLL(const cube18B_1LLL_s* cube1, const cube18B_1LLL_s* cube2);
 bool compare_cube18B_F2L(const cube18B_F2L_s* cube1, const cube18B_F2L_s* cube2);
+// inline, the tables call this on every probe
+static inline bool compare_cube18B_keys(const uint64_t* key1, const uint64_t* key2) {
+    return *key1 == *key2;
+}
 void print_cube18B(const cube18B_s* cube);
 void print_cube18B_xcross4(const cube18B_xcross4_s* cube);
 void print_cube18B_xcross1(const cube18B_xcross1_s* cube);
@@ -401,6 +429,7 @@ void cube18B_F2L_apply_alg(cube18B_F2L_s* cube, const alg_s* alg);
 cubie_e apply_alg_to_cubie(cubie_e cubie, const alg_s* alg);
 cubieTable_s alg_to_cubieTable(const alg_s* alg);
 void apply_cubieTable_to_cube(cube18B_s* cube, const cubieTable_s* table);
+void cube18B_1LLL_apply_cubieTable(cube18B_1LLL_s* cube, const cubieTable_s* table);
 cubieTable_s conjoin_cubeTables(const cubieTable_s* table1, const cubieTable_s* table2);
 
 
@@ -2,36 +2,20 @@
 #include "solver_print.h"
 #include "cube_table.h"
 
-typedef struct {
-    shift_cube_s key;
-    alg_list_s algs;
-} entry_s;
+HASH_TABLE_DEFINE(cube_map, shift_cube_s, alg_list_s, compare_cubes)
 
 typedef struct cube_table {
-    size_t entries;
-    size_t size;
-
-    entry_s *table;
+    cube_map_s map;
 } cube_table_s;
 
-cube_table_s* cube_table_create(size_t size) {
+cube_table_s* cube_table_create(size_t num_entries) {
     cube_table_s *ct = (cube_table_s*)malloc(sizeof(cube_table_s));
 
-    ct->table = (entry_s*)calloc(size, sizeof(entry_s));
-
-    ct->entries = 0;
-    ct->size    = size;
-    return ct;
-}
-
-size_t cube_table_hash(const cube_table_s *ct, const shift_cube_s *key) {
-    size_t hash = 0;
-    for (face_e face = FACE_U; face < NUM_FACES; face++) {
-        hash ^= key->state[face];
-        hash  = rolq(hash, 17);
+    if (!cube_map_init(&ct->map, num_entries)) {
+        free(ct);
+        return NULL;
     }
-
-    return hash % ct->size;
+    return ct;
 }
 
 bool cube_table_insert(cube_table_s *ct, const shift_cube_s *key, const alg_s *moves) {
@@ -39,126 +23,82 @@ bool cube_table_insert(cube_table_s *ct, const shift_cube_s *key, const alg_s *m
         return false;
     }
 
-    size_t hash = cube_table_hash(ct, key);
-    size_t index = hash;
-
-    // linear probing
-    while (ct->table[index].algs.list != NULL) {
-        if (compare_cubes(&(ct->table[index].key), key)) {
-            if (ct->table[index].algs.num_algs == ct->table[index].algs.size) {
-                size_t new_size = 2*sizeof(alg_s)*ct->table[index].algs.size;
-                alg_s *tmp = realloc(ct->table[index].algs.list, new_size);
-
-                if (!tmp) {
-                    return false;
-                }
-
-                ct->table[index].algs.list = tmp;
-                ct->table[index].algs.size *=2;
-            }
-
-            ct->table[index].algs.list[ct->table[index].algs.num_algs] = alg_static_copy(moves);
-            ct->table[index].algs.num_algs++;
+    bool inserted;
+    cube_map_slot_s *slot = cube_map_insert(&ct->map, key, &inserted);
+    if (!slot) {
+        return false;
+    }
+    alg_list_s *algs = &slot->value;
 
-            return true;
-        }
+    if (inserted) {
+        algs->list = (alg_s*)malloc(sizeof(alg_s));
+        algs->num_algs = 0;
+        algs->size = 1;
+    } else if (algs->num_algs == algs->size) {
+        alg_s *tmp = realloc(algs->list, 2*sizeof(alg_s)*algs->size);
 
-        index++;
-        if (index == hash) {
+        if (!tmp) {
             return false;
         }
 
-        if (index >= ct->size) {
-            index = 0;
-        }
+        algs->list = tmp;
+        algs->size *=2;
     }
 
-
-    ct->table[index].key  = *key;
-
-    ct->entries++;
-
-    ct->table[index].algs.list = (alg_s*)malloc(sizeof(alg_s));
-    ct->table[index].algs.list[0] = alg_static_copy(moves);
-
-    ct->table[index].algs.num_algs = 1;
-    ct->table[index].algs.size = 1;
+    algs->list[algs->num_algs] = alg_static_copy(moves);
+    algs->num_algs++;
 
     return true;
 }
 
-static inline size_t cube_table_get_cube_index(const cube_table_s *ct, const shift_cube_s *cube) {
-    if (ct == NULL || cube == NULL) {
-        return ct->size;
-    }
-
-    size_t hash = cube_table_hash(ct, cube);
-    size_t index = hash;
-
-    while (ct->table[index].algs.list != NULL) {
-        if (compare_cubes(&(ct->table[index].key), cube)) {
-            return index;
-        }
-
-        if (index + 1 == hash) {
-            break;
-        }
-
-        index = (index + 1 >= ct->size) ? 0 : index + 1;
-    }
-
-    return ct->size;
-}
-
 const alg_list_s* cube_table_lookup(const cube_table_s *ct, const shift_cube_s *cube) {
-    size_t index = cube_table_get_cube_index(ct, cube);
+    const cube_map_slot_s *slot = cube_map_find(&ct->map, cube);
 
-    return (index == ct->size) ? NULL : &ct->table[index].algs;
+    return (slot == NULL) ? NULL : &slot->value;
 }
 
 void cube_table_clear(cube_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
+    if (ct == NULL || ct->map.slots == NULL) {
         return;
     }
 
-    for (size_t index = 0; index < ct->size; index++) {
-        if (ct->table[index].algs.list != NULL) {
-            for (size_t i = 0; i < ct->table[index].algs.num_algs; i++) {
-                free(ct->table[index].algs.list[i].moves);
+    for (size_t index = 0; index < ct->map.capacity; index++) {
+        if (cube_map_slot_used(&ct->map, index)) {
+            alg_list_s *algs = &ct->map.slots[index].value;
+            for (size_t i = 0; i < algs->num_algs; i++) {
+                free(algs->list[i].moves);
             }
 
-            free(ct->table[index].algs.list);
-            ct->table[index].algs.list = NULL;
+            free(algs->list);
         }
     }
 
-    ct->entries = 0;
+    cube_map_clear(&ct->map);
 }
 
 void cube_table_free(cube_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
-        free(ct);
+    if (ct == NULL) {
         return;
     }
 
     cube_table_clear(ct);
 
-    free(ct->table);
+    cube_map_destroy(&ct->map);
     free(ct);
 }
 
 void cube_table_print(cube_table_s *ct) {
     printf("   index  |               cube string representation            | algorithm\n");
     printf("------------------------------------------------------------------------------\n");
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].algs.list != NULL) {
+    for (size_t idx = 0; idx < ct->map.capacity; idx++) {
+        if (cube_map_slot_used(&ct->map, idx)) {
             printf("%10zu ", idx);
-            print_cube_line_colors(ct->table[idx].key);
-            print_alg(&ct->table[idx].algs.list[0]);
+            print_cube_line_colors(ct->map.slots[idx].key);
+            print_alg(&ct->map.slots[idx].value.list[0]);
         }
 
         if (idx != 0) {
-            if (ct->table[idx].algs.list == NULL && ct->table[idx-1].algs.list != NULL) {
+            if (!cube_map_slot_used(&ct->map, idx) && cube_map_slot_used(&ct->map, idx-1)) {
                 printf("                                    ...                                    \n");
             }
         }
@@ -166,9 +106,13 @@ void cube_table_print(cube_table_s *ct) {
 }
 
 size_t cube_table_entries(const cube_table_s *ct) {
-    return ct->entries;
+    return ct->map.entries;
 }
 
 size_t cube_table_size(const cube_table_s *ct) {
-    return ct->size;
+    return ct->map.capacity;
+}
+
+hash_table_stats_s cube_table_stats(const cube_table_s *ct) {
+    return cube_map_stats(&ct->map);
 }
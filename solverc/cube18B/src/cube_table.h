@@ -6,11 +6,12 @@
 
 #include "main.h"
 #include "alg.h"
+#include "hash_table.h"
 #include "shift_cube.h"
 
 typedef struct cube_table cube_table_s;
 
-cube_table_s* cube_table_create(size_t size);
+cube_table_s* cube_table_create(size_t num_entries);
 bool cube_table_insert(cube_table_s *ct, const shift_cube_s *key, const alg_s *moves);
 const alg_list_s* cube_table_lookup(const cube_table_s *ct, const shift_cube_s *cube);
 void cube_table_free(cube_table_s *ct);
@@ -19,5 +20,6 @@ void cube_table_print(cube_table_s *ct);
 
 size_t cube_table_entries(const cube_table_s *ct);
 size_t cube_table_size(const cube_table_s *ct);
+hash_table_stats_s cube_table_stats(const cube_table_s *ct);
 
 #endif // CUBE_TABLE_H
@@ -133,6 +133,47 @@ static const face_e rotate_on_y[4][NUM_FACES] = {
     {FACE_U, FACE_F, FACE_L, FACE_B, FACE_R, FACE_D}
 };
 
+// where each face goes when the whole cube is turned so cross_face ends up on D and
+// then turned y_turns on y. rotate_cube[FACE_D] is rotate_on_y
+static const face_e rotate_cube[NUM_FACES][4][NUM_FACES] = {
+    {
+        {FACE_D, FACE_R, FACE_B, FACE_L, FACE_F, FACE_U},
+        {FACE_D, FACE_B, FACE_L, FACE_F, FACE_R, FACE_U},
+        {FACE_D, FACE_L, FACE_F, FACE_R, FACE_B, FACE_U},
+        {FACE_D, FACE_F, FACE_R, FACE_B, FACE_L, FACE_U}
+    },
+    {
+        {FACE_R, FACE_D, FACE_F, FACE_U, FACE_B, FACE_L},
+        {FACE_B, FACE_D, FACE_R, FACE_U, FACE_L, FACE_F},
+        {FACE_L, FACE_D, FACE_B, FACE_U, FACE_F, FACE_R},
+        {FACE_F, FACE_D, FACE_L, FACE_U, FACE_R, FACE_B}
+    },
+    {
+        {FACE_F, FACE_R, FACE_D, FACE_L, FACE_U, FACE_B},
+        {FACE_R, FACE_B, FACE_D, FACE_F, FACE_U, FACE_L},
+        {FACE_B, FACE_L, FACE_D, FACE_R, FACE_U, FACE_F},
+        {FACE_L, FACE_F, FACE_D, FACE_B, FACE_U, FACE_R}
+    },
+    {
+        {FACE_L, FACE_U, FACE_F, FACE_D, FACE_B, FACE_R},
+        {FACE_F, FACE_U, FACE_R, FACE_D, FACE_L, FACE_B},
+        {FACE_R, FACE_U, FACE_B, FACE_D, FACE_F, FACE_L},
+        {FACE_B, FACE_U, FACE_L, FACE_D, FACE_R, FACE_F}
+    },
+    {
+        {FACE_B, FACE_R, FACE_U, FACE_L, FACE_D, FACE_F},
+        {FACE_L, FACE_B, FACE_U, FACE_F, FACE_D, FACE_R},
+        {FACE_F, FACE_L, FACE_U, FACE_R, FACE_D, FACE_B},
+        {FACE_R, FACE_F, FACE_U, FACE_B, FACE_D, FACE_L}
+    },
+    {
+        {FACE_U, FACE_R, FACE_F, FACE_L, FACE_B, FACE_D},
+        {FACE_U, FACE_B, FACE_R, FACE_F, FACE_L, FACE_D},
+        {FACE_U, FACE_L, FACE_B, FACE_R, FACE_F, FACE_D},
+        {FACE_U, FACE_F, FACE_L, FACE_B, FACE_R, FACE_D}
+    }
+};
+
 #define MAX_CUBE_TABLE_DEPTH 7
 
 static const uint32_t cube_table_depth_sizes[MAX_CUBE_TABLE_DEPTH + 1] = {
@@ -4,9 +4,38 @@
 #include "cube18B.h"
 #include "translators.h"
 #include "solver.h"
+#include "move_kernels.h"
+#include "coord.h"
+#include "hash_table.h"
 
 #include <time.h>
 
+// the linker sends every malloc, calloc, realloc and free our code makes through
+// these (see LDFLAGS in the Makefile) so the tests can count them
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static size_t heap_calls = 0;
+
+void *__wrap_malloc(size_t size) {
+    __atomic_fetch_add(&heap_calls, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+void *__wrap_calloc(size_t num, size_t size) {
+    __atomic_fetch_add(&heap_calls, 1, __ATOMIC_RELAXED);
+    return __real_calloc(num, size);
+}
+void *__wrap_realloc(void *ptr, size_t size) {
+    __atomic_fetch_add(&heap_calls, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+void __wrap_free(void *ptr) {
+    if (ptr) __atomic_fetch_add(&heap_calls, 1, __ATOMIC_RELAXED);
+    __real_free(ptr);
+}
+
 static void test_translation(const shift_cube_s* shiftcube, const cube18B_s* cube18B)  {
     cube18B_s translated_cube18B = cube18B_from_shiftCube(shiftcube);
     if (!compare_cube18Bs(&translated_cube18B, cube18B)) {
@@ -66,6 +95,36 @@ static void stress_test_cube18B_xcross4(size_t apply_alg_times, const alg_s* alg
 
     printf("Cube18B_xcross time: %fs\n", (double)(end_cube18b - start_cube18b)/CLOCKS_PER_SEC);
 }
+static void stress_test_move_kernel(size_t apply_alg_times, const alg_s* alg, const move_kernel_s* kernel) {
+    cube18B_s cube18B = SOLVED_CUBE18B;
+    cube18B_xcross4_s xcross = SOLVED_CUBE18B_XCROSS4;
+    printf("Stress-testing the %s move kernel with %zu moves...\n", kernel->name, apply_alg_times*(alg->length));
+
+    clock_t start_cube18b = clock();
+    for (int i = 0; i < apply_alg_times; i++) {
+        kernel->apply_alg(cube18B.cubies, 18, alg);
+    } clock_t end_cube18b = clock();
+
+    clock_t start_xcross = clock();
+    for (int i = 0; i < apply_alg_times; i++) {
+        kernel->apply_alg(xcross.cubies, 12, alg);
+    } clock_t end_xcross = clock();
+
+    printf("Cube18B time: %fs\n", (double)(end_cube18b - start_cube18b)/CLOCKS_PER_SEC);
+    printf("Cube18B_xcross time: %fs\n", (double)(end_xcross - start_xcross)/CLOCKS_PER_SEC);
+
+    // checking the results against the scalar kernel's keeps the loops from being
+    // optimized out, and catches a kernel that is only fast because it's wrong
+    cube18B_s expected = SOLVED_CUBE18B;
+    cube18B_xcross4_s expected_xcross = SOLVED_CUBE18B_XCROSS4;
+    for (int i = 0; i < apply_alg_times; i++) {
+        MOVE_KERNEL_SCALAR.apply_alg(expected.cubies, 18, alg);
+        MOVE_KERNEL_SCALAR.apply_alg(expected_xcross.cubies, 12, alg);
+    }
+    if (!compare_cube18Bs(&cube18B, &expected) || !compare_cube18B_xcross4(&xcross, &expected_xcross)) {
+        printf("The %s move kernel doesn't match the scalar kernel\n", kernel->name);
+    }
+}
 static void stress_test(size_t apply_alg_times, const char* algstr) {
     alg_s* alg = alg_from_alg_str(algstr);
     printf("alg to stress test %zu times: \n", apply_alg_times);
@@ -73,6 +132,10 @@ static void stress_test(size_t apply_alg_times, const char* algstr) {
     stress_test_shiftcube(apply_alg_times, alg);
     stress_test_cube18B(apply_alg_times, alg);
     stress_test_cube18B_xcross4(apply_alg_times, alg);
+    stress_test_move_kernel(apply_alg_times, alg, &MOVE_KERNEL_SCALAR);
+    if (move_kernel_best() != &MOVE_KERNEL_SCALAR) {
+        stress_test_move_kernel(apply_alg_times, alg, move_kernel_best());
+    }
     printf("Finished stress-testing!\n");
     printf("\n");
     alg_free(alg);
@@ -147,11 +210,223 @@ static void test_cube18B_moves() {
     apply_move(&cube, MOVE_D2); cube18B_apply_move(&cube18B, MOVE_D2); test_translation(&cube, &cube18B);
     printf("\n");
 }
-static void test_cube_solve(const char** scrambles, int NUM_TESTS) {
-    init_solver1();
+// the best move kernel has to agree with the scalar one on every cube size
+static void test_move_kernels(const char** algs, int num_algs) {
+    const move_kernel_s *kernel = move_kernel_best();
+    for (int test = 0; test < num_algs; test++) {
+        alg_s *alg = alg_from_alg_str(algs[test]);
+        for (size_t num_cubies = 1; num_cubies <= 18; num_cubies++) {
+            cube18B_s expected = SOLVED_CUBE18B;
+            cube18B_s cube = SOLVED_CUBE18B;
+            MOVE_KERNEL_SCALAR.apply_alg(expected.cubies, num_cubies, alg);
+            kernel->apply_alg(cube.cubies, num_cubies, alg);
+            if (!compare_cube18Bs(&cube, &expected)) {
+                printf("The %s move kernel doesn't match the scalar kernel on %zu cubies:\n", kernel->name, num_cubies);
+                print_alg(alg);
+                print_cube18B(&expected);
+                print_cube18B(&cube);
+            }
+        }
+        alg_free(alg);
+    }
+}
+// moving coordinates through the move tables has to match moving the cubies
+static void test_coords(const char** algs, int num_algs) {
+    coord_tables_s *tables = coord_tables_create();
+    for (int test = 0; test < num_algs; test++) {
+        alg_s *alg = alg_from_alg_str(algs[test]);
+        for (uint8_t pair = 0; pair < 4; pair++) {
+            cube18B_xcross1_s cube = cube18B_xcross4_to_xcross1(&SOLVED_CUBE18B_XCROSS4, pair);
+            cube18B_1LLL_s LL = SOLVED_CUBE18B_1LLL;
+            coord_xcross1_s coord = coord_xcross1_from_cube18B_xcross1(&cube);
+            coord_1LLL_s LL_coord = coord_1LLL_from_cube18B_1LLL(&LL);
+            for (size_t i = 0; i < alg->length; i++) {
+                cube18B_xcross1_apply_move(&cube, alg->moves[i]);
+                cube18B_1LLL_apply_move(&LL, alg->moves[i]);
+                coord_xcross1_apply_move(tables, &coord, alg->moves[i]);
+                coord_1LLL_apply_move(tables, &LL_coord, alg->moves[i]);
+
+                cube18B_xcross1_s from_coord = cube18B_xcross1_from_coord_xcross1(&coord);
+                cube18B_1LLL_s LL_from_coord = cube18B_1LLL_from_coord_1LLL(&LL_coord);
+                if (!compare_cube18B_xcross1(&cube, &from_coord) || !compare_cube18B_1LLL(&LL, &LL_from_coord)) {
+                    printf("Coordinates went wrong after move %zu of:\n", i);
+                    print_alg(alg);
+                    print_cube18B_xcross1(&cube);
+                    print_cube18B_xcross1(&from_coord);
+                    print_cube18B_1LLL(&LL);
+                    print_cube18B_1LLL(&LL_from_coord);
+                    break;
+                }
+            }
+        }
+        alg_free(alg);
+    }
+    coord_tables_free(tables);
+}
+HASH_TABLE_DEFINE(test_map, cube18B_xcross4_s, uint32_t, compare_cube18B_xcross4)
 
+// starts out as small as a table gets so every scramble's states make it grow a
+// few times, and everything has to still be there afterwards and gone after a clear
+static void test_hash_table(const char** algs, int num_algs) {
+    test_map_s map;
+    test_map_init(&map, 1);
+
+    uint32_t num_states = 0;
+    cube18B_xcross4_s first_state = SOLVED_CUBE18B_XCROSS4;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int test = 0; test < num_algs; test++) {
+            alg_s *alg = alg_from_alg_str(algs[test]);
+            cube18B_s cube = SOLVED_CUBE18B;
+            for (size_t i = 0; i < alg->length; i++) {
+                cube18B_apply_move(&cube, alg->moves[i]);
+                cube18B_xcross4_s key = cube18B_xcross4_from_cube18B(&cube);
+
+                bool inserted = false;
+                test_map_slot_s *slot = test_map_insert(&map, &key, &inserted);
+                if (pass == 0 && inserted) {
+                    if (num_states == 0) first_state = key;
+                    slot->value = num_states++;
+                } else if (pass == 1 && (inserted || test_map_find(&map, &key) != slot)) {
+                    printf("The hash table lost a state after growing to %zu slots\n", map.capacity);
+                }
+            }
+            alg_free(alg);
+        }
+    }
+
+    hash_table_stats_s stats = test_map_stats(&map);
+    if (stats.entries != num_states || map.entries > map.max_entries || stats.mean_probe < 1.0) {
+        hash_table_print_stats("test map", &stats);
+    }
+
+    test_map_clear(&map);
+    if (map.entries != 0 || test_map_find(&map, &first_state) != NULL) {
+        printf("The hash table still had %zu entries after clearing\n", map.entries);
+    }
+    test_map_destroy(&map);
+}
+// the key and hash carried along with a state by the hashed moves have to be
+// the ones it would get from scratch
+static void test_xcross4_hashed(const cube18B_xcross4_hashed_s *hashed) {
+    if (hashed->key != cube18B_xcross4_pack(&hashed->cube) ||
+        hashed->hash != cube18B_xcross4_key_hash(&hashed->key)) {
+        printf("The carried key or hash of an xcross4 state went wrong:\n");
+        print_cube18B_xcross4(&hashed->cube);
+    }
+}
+// packing has to keep every state apart, masked pairs included, and unpack
+// back to the same state
+static void test_cube18B_keys(const char** algs, int num_algs) {
+    for (int test = 0; test < num_algs; test++) {
+        alg_s *alg = alg_from_alg_str(algs[test]);
+        cube18B_s cube = SOLVED_CUBE18B;
+        cube18B_xcross4_hashed_s hashed = cube18B_xcross4_hashed_from(&SOLVED_CUBE18B_XCROSS4);
+        for (size_t i = 0; i < alg->length; i++) {
+            cube18B_xcross4_s prev = cube18B_xcross4_from_cube18B(&cube);
+            cube18B_apply_move(&cube, alg->moves[i]);
+            cube18B_xcross4_hashed_apply_move(&hashed, alg->moves[i]);
+            test_xcross4_hashed(&hashed);
+            cube18B_xcross4_s xcross4 = cube18B_xcross4_from_cube18B(&cube);
+            cube18B_F2L_s F2L = cube18B_F2L_from_cube18B(&cube);
+            cube18B_1LLL_s LL = cube18B_1LLL_from_cube18B(&cube);
+
+            cube18B_1LLL_s LL_unpacked = cube18B_1LLL_unpack(cube18B_1LLL_pack(&LL));
+            if (!compare_cube18B_1LLL(&LL, &LL_unpacked)) {
+                printf("Packing changed a 1LLL state:\n");
+                print_cube18B_1LLL(&LL);
+                print_cube18B_1LLL(&LL_unpacked);
+            }
+            for (uint8_t pair = 0; pair <= 4; pair++) {
+                cube18B_xcross4_s xcross4_masked = xcross4;
+                cube18B_F2L_s F2L_masked = F2L;
+                if (pair < 4) {
+                    cube18B_xcross4_maskOnPair(&xcross4_masked, pair);
+                    cube18B_F2L_maskOnPair(&F2L_masked, pair);
+                    cube18B_xcross4_hashed_s hashed_masked = cube18B_xcross4_hashed_maskOnPair(&hashed, pair);
+                    test_xcross4_hashed(&hashed_masked);
+                }
+                cube18B_xcross4_s xcross4_unpacked = cube18B_xcross4_unpack(cube18B_xcross4_pack(&xcross4_masked));
+                cube18B_F2L_s F2L_unpacked = cube18B_F2L_unpack(cube18B_F2L_pack(&F2L_masked));
+                if (!compare_cube18B_xcross4(&xcross4_masked, &xcross4_unpacked)) {
+                    printf("Packing changed an xcross4 state:\n");
+                    print_cube18B_xcross4(&xcross4_masked);
+                    print_cube18B_xcross4(&xcross4_unpacked);
+                }
+                if (!compare_cube18B_F2L(&F2L_masked, &F2L_unpacked)) {
+                    printf("Packing changed an F2L state:\n");
+                    print_cube18B_F2L(&F2L_masked);
+                    print_cube18B_F2L(&F2L_unpacked);
+                }
+            }
+            if (cube18B_xcross4_pack(&prev) == cube18B_xcross4_pack(&xcross4)) {
+                printf("Two xcross4 states packed to the same key:\n");
+                print_cube18B_xcross4(&prev);
+                print_cube18B_xcross4(&xcross4);
+            }
+        }
+        alg_free(alg);
+    }
+}
+// a move changes the distance to the solved xcross by at most one, and a
+// scramble can't be further away than its own length
+static void test_xcross1_pruning_table(const xcross1_pruning_table_s *pt, const char** algs, int num_algs) {
+    coord_tables_s *tables = coord_tables_create();
+    cube18B_xcross1_s solved = cube18B_xcross4_to_xcross1(&SOLVED_CUBE18B_XCROSS4, 0);
+    for (int test = 0; test < num_algs; test++) {
+        alg_s *alg = alg_from_alg_str(algs[test]);
+        coord_xcross1_s coord = coord_xcross1_from_cube18B_xcross1(&solved);
+        uint8_t distance = xcross1_pruning_table_distance(pt, coord_xcross1_rank(tables, &coord));
+        for (size_t i = 0; i < alg->length; i++) {
+            coord_xcross1_apply_move(tables, &coord, alg->moves[i]);
+            uint8_t new_distance = xcross1_pruning_table_distance(pt, coord_xcross1_rank(tables, &coord));
+            if (new_distance > i + 1 || new_distance > distance + 1 || new_distance + 1 < distance) {
+                printf("The xcross pruning table went from %u to %u moves after move %zu of:\n", distance, new_distance, i);
+                print_alg(alg);
+                break;
+            }
+            distance = new_distance;
+        }
+        alg_free(alg);
+    }
+    coord_tables_free(tables);
+}
+// once its arenas have grown to fit, the only heap calls a solve makes are the
+// two mallocs for the solution it returns
+static void test_solve_heap_calls(const coord_tables_s *coord_tables, const xcross1_pruning_table_s *xcross1_pt,
+                                  const char** scrambles, int num_scrambles) {
+    F2L_table_s *f2l_table = generate_f2l_table("../../ALGORITHMS/FULL_F2L_ALGORITHMS.txt");
+    LL_table_s *last_layer_table = generate_last_layer_table("../../ALGORITHMS/FULL_1LLL_ALGORITHMS.txt");
+    solver_ctx_s *ctx = solver_ctx_create(f2l_table, last_layer_table, coord_tables, xcross1_pt, 1);
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int test = 0; test < num_scrambles; test++) {
+            cube18B_s cube = SOLVED_CUBE18B;
+            alg_s *alg = alg_from_alg_str(scrambles[test]);
+            cube18B_apply_alg(&cube, alg);
+
+            size_t before = __atomic_load_n(&heap_calls, __ATOMIC_RELAXED);
+            alg_s *solve = solve_cube(ctx, cube);
+            size_t calls = __atomic_load_n(&heap_calls, __ATOMIC_RELAXED) - before;
+            // the first pass is what grows the arenas
+            if (pass == 1 && calls != 2) {
+                printf("Solving %s made %zu heap calls instead of 2\n", scrambles[test], calls);
+            }
+
+            alg_free(solve);
+            alg_free(alg);
+        }
+    }
+
+    solver_ctx_free(ctx);
+    F2L_table_free(f2l_table);
+    LL_table_free(last_layer_table);
+}
+static void test_cube_solve(const coord_tables_s *coord_tables, const xcross1_pruning_table_s *xcross1_pt,
+                            const char** scrambles, int NUM_TESTS) {
     F2L_table_s *f2l_table = generate_f2l_table("../../ALGORITHMS/FULL_F2L_ALGORITHMS.txt");
     LL_table_s *last_layer_table = generate_last_layer_table("../../ALGORITHMS/FULL_1LLL_ALGORITHMS.txt");
+    solver_ctx_s *ctx = solver_ctx_create(f2l_table, last_layer_table, coord_tables, xcross1_pt, 0);
+    solver_ctx_track_peak_rss(ctx, true);
 
     alg_s *alg = NULL;
     cube18B_s cube = SOLVED_CUBE18B;
@@ -163,7 +438,7 @@ static void test_cube_solve(const char** scrambles, int NUM_TESTS) {
         alg = alg_from_alg_str(scrambles[test]);
         printf("Testing scramble: %s\n", scrambles[test]);
         cube18B_apply_alg(&cube, alg);
-        alg_s *solve = solve_cube(cube, f2l_table, last_layer_table);
+        alg_s *solve = solve_cube(ctx, cube);
         cube18B_apply_alg(&cube, solve);
         if (!compare_cube18Bs(&cube, &SOLVED_CUBE18B)) {
             printf("It didn't solve it, this is bad...\n");
@@ -176,12 +451,164 @@ static void test_cube_solve(const char** scrambles, int NUM_TESTS) {
         alg_free(alg);
     }
     printf("Average solve length: %f\n", sum / NUM_TESTS);
+    solver_ctx_print_stats(ctx);
     printf("\n");
 
+    solver_ctx_free(ctx);
     F2L_table_free(f2l_table);
     LL_table_free(last_layer_table);
+}
+
+// the bidirectional xcross4 search has to give the same kind of solves as the
+// default one, just from other xcrosses
+static void test_best_of_each_solve(const coord_tables_s *coord_tables, const xcross1_pruning_table_s *xcross1_pt,
+                                    const char** scrambles, int num_scrambles) {
+    F2L_table_s *f2l_table = generate_f2l_table("../../ALGORITHMS/FULL_F2L_ALGORITHMS.txt");
+    LL_table_s *last_layer_table = generate_last_layer_table("../../ALGORITHMS/FULL_1LLL_ALGORITHMS.txt");
+    solver_ctx_s *ctx = solver_ctx_create(f2l_table, last_layer_table, coord_tables, xcross1_pt, 1);
+    if (!solver_ctx_set_xcross_search(ctx, XCROSS_SEARCH_BEST_OF_EACH)) {
+        printf("Couldn't allocate the xcross4 tables\n");
+    }
+    solver_ctx_track_peak_rss(ctx, true);
+
+    for (int test = 0; test < num_scrambles; test++) {
+        cube18B_s cube = SOLVED_CUBE18B;
+        alg_s *alg = alg_from_alg_str(scrambles[test]);
+        cube18B_apply_alg(&cube, alg);
+        alg_s *solve = solve_cube(ctx, cube);
+        cube18B_apply_alg(&cube, solve);
+        if (!compare_cube18Bs(&cube, &SOLVED_CUBE18B) || solver_ctx_peak_rss(ctx) == 0) {
+            printf("Solving %s over the xcross4 tables failed (%zu kB peak RSS)\n", scrambles[test],
+                   solver_ctx_peak_rss(ctx));
+        }
+        alg_free(solve);
+        alg_free(alg);
+    }
+
+    solver_ctx_free(ctx);
+    F2L_table_free(f2l_table);
+    LL_table_free(last_layer_table);
+}
 
-    cleanup_solver1();
+// the transposition table is off by default, with it on the solves still have to
+// solve the cube and are at most a little longer
+static void test_f2l_transpositions(const coord_tables_s *coord_tables, const xcross1_pruning_table_s *xcross1_pt,
+                                    const char** scrambles, int num_scrambles) {
+    F2L_table_s *f2l_table = generate_f2l_table("../../ALGORITHMS/FULL_F2L_ALGORITHMS.txt");
+    LL_table_s *last_layer_table = generate_last_layer_table("../../ALGORITHMS/FULL_1LLL_ALGORITHMS.txt");
+    solver_ctx_s *plain_ctx = solver_ctx_create(f2l_table, last_layer_table, coord_tables, xcross1_pt, 1);
+    solver_ctx_s *tt_ctx = solver_ctx_create(f2l_table, last_layer_table, coord_tables, xcross1_pt, 1);
+    if (!solver_ctx_set_f2l_transpositions(tt_ctx, true)) {
+        printf("Couldn't allocate the F2L transposition table\n");
+    }
+
+    double plain_sum = 0, tt_sum = 0;
+    for (int test = 0; test < num_scrambles; test++) {
+        cube18B_s cube = SOLVED_CUBE18B;
+        alg_s *alg = alg_from_alg_str(scrambles[test]);
+        cube18B_apply_alg(&cube, alg);
+        alg_s *plain = solve_cube(plain_ctx, cube);
+        alg_s *tt = solve_cube(tt_ctx, cube);
+        cube18B_apply_alg(&cube, tt);
+        if (!compare_cube18Bs(&cube, &SOLVED_CUBE18B)) {
+            printf("Solving %s with the F2L transposition table failed\n", scrambles[test]);
+        }
+        plain_sum += plain->length;
+        tt_sum += tt->length;
+        alg_free(plain);
+        alg_free(tt);
+        alg_free(alg);
+    }
+    printf("Average solve length with the F2L transposition table: %f (%f without)\n",
+           tt_sum / num_scrambles, plain_sum / num_scrambles);
+    solver_ctx_print_stats(tt_ctx);
+
+    solver_ctx_free(plain_ctx);
+    solver_ctx_free(tt_ctx);
+    F2L_table_free(f2l_table);
+    LL_table_free(last_layer_table);
+}
+
+// the F2L pruning is off by default, with it on the solves still have to solve the
+// cube, and any scramble it made longer is printed
+static void test_f2l_pruning(const coord_tables_s *coord_tables, const xcross1_pruning_table_s *xcross1_pt,
+                             const char** scrambles, int num_scrambles) {
+    F2L_table_s *f2l_table = generate_f2l_table("../../ALGORITHMS/FULL_F2L_ALGORITHMS.txt");
+    LL_table_s *last_layer_table = generate_last_layer_table("../../ALGORITHMS/FULL_1LLL_ALGORITHMS.txt");
+    solver_ctx_s *plain_ctx = solver_ctx_create(f2l_table, last_layer_table, coord_tables, xcross1_pt, 1);
+    solver_ctx_s *pruned_ctx = solver_ctx_create(f2l_table, last_layer_table, coord_tables, xcross1_pt, 1);
+    solver_ctx_set_f2l_pruning(pruned_ctx, true);
+
+    double plain_sum = 0, pruned_sum = 0;
+    int num_longer = 0;
+    for (int test = 0; test < num_scrambles; test++) {
+        cube18B_s cube = SOLVED_CUBE18B;
+        alg_s *alg = alg_from_alg_str(scrambles[test]);
+        cube18B_apply_alg(&cube, alg);
+        alg_s *plain = solve_cube(plain_ctx, cube);
+        alg_s *pruned = solve_cube(pruned_ctx, cube);
+        cube18B_apply_alg(&cube, pruned);
+        if (!compare_cube18Bs(&cube, &SOLVED_CUBE18B)) {
+            printf("Solving %s with the F2L pruning failed\n", scrambles[test]);
+        }
+        if (pruned->length > plain->length) {
+            printf("The F2L pruning made %s %zu moves instead of %zu\n", scrambles[test],
+                   pruned->length, plain->length);
+            num_longer++;
+        }
+        plain_sum += plain->length;
+        pruned_sum += pruned->length;
+        alg_free(plain);
+        alg_free(pruned);
+        alg_free(alg);
+    }
+    printf("Average solve length with the F2L pruning: %f (%f without), %d of %d solves longer\n",
+           pruned_sum / num_scrambles, plain_sum / num_scrambles, num_longer, num_scrambles);
+
+    solver_ctx_free(plain_ctx);
+    solver_ctx_free(pruned_ctx);
+    F2L_table_free(f2l_table);
+    LL_table_free(last_layer_table);
+}
+
+// with the cross on D as the first of the orientations tried, a color neutral
+// solve can only ever come out shorter than the plain one
+static void test_color_neutral_solve(const coord_tables_s *coord_tables, const xcross1_pruning_table_s *xcross1_pt,
+                                     const char** scrambles, int num_scrambles) {
+    F2L_table_s *f2l_table = generate_f2l_table("../../ALGORITHMS/FULL_F2L_ALGORITHMS.txt");
+    LL_table_s *last_layer_table = generate_last_layer_table("../../ALGORITHMS/FULL_1LLL_ALGORITHMS.txt");
+    solver_ctx_s *ctxs[NUM_FACES];
+    for (size_t i = 0; i < NUM_FACES; i++) {
+        ctxs[i] = solver_ctx_create(f2l_table, last_layer_table, coord_tables, xcross1_pt, 0);
+    }
+
+    double plain_sum = 0, neutral_sum = 0;
+    for (int test = 0; test < num_scrambles; test++) {
+        cube18B_s cube = SOLVED_CUBE18B;
+        alg_s *alg = alg_from_alg_str(scrambles[test]);
+        cube18B_apply_alg(&cube, alg);
+        alg_s *plain = solve_cube(ctxs[0], cube);
+        alg_s *neutral = solve_cube_color_neutral(ctxs, NUM_FACES, cube, false);
+        cube18B_apply_alg(&cube, neutral);
+        if (!compare_cube18Bs(&cube, &SOLVED_CUBE18B) || neutral->length > plain->length) {
+            printf("The color neutral solve of %s went wrong (%zu moves against %zu):\n", scrambles[test],
+                   neutral->length, plain->length);
+            print_alg(neutral);
+        }
+        plain_sum += plain->length;
+        neutral_sum += neutral->length;
+        alg_free(plain);
+        alg_free(neutral);
+        alg_free(alg);
+    }
+    printf("Average color neutral solve length: %f (%f with the cross on D)\n",
+           neutral_sum / num_scrambles, plain_sum / num_scrambles);
+
+    for (size_t i = 0; i < NUM_FACES; i++) {
+        solver_ctx_free(ctxs[i]);
+    }
+    F2L_table_free(f2l_table);
+    LL_table_free(last_layer_table);
 }
 
 static void test_simplifier_1case(char* algstr, char* simplifiedalgstr) {
@@ -219,6 +646,34 @@ static void test_simplifer() {
     test_simplifier_1case("R3 L2 U L2 D U3", "R3 L2 U L2 D U3");
 }
 
+// an arena alg that cancels down below a quarter of its size would be realloced
+// by alg_simplify, alg_arena_simplify has to leave its memory alone
+static void test_arena_simplify() {
+    const char *algstr = "R U F D L L' B B' L L' B B' L L' B B' L L' B B' L L' B B' L L' B B' D' D";
+    alg_s *expected = alg_from_alg_str(algstr);
+    alg_simplify(expected);
+
+    arena_s *arena = arena_create(1 << 10);
+    alg_s *alg = alg_from_alg_str(algstr);
+    alg_s *arena_alg = alg_arena_copy(arena, alg);
+    size_t size = arena_alg->size;
+
+    size_t before = __atomic_load_n(&heap_calls, __ATOMIC_RELAXED);
+    alg_arena_simplify(arena_alg);
+    size_t calls = __atomic_load_n(&heap_calls, __ATOMIC_RELAXED) - before;
+    if (calls != 0 || arena_alg->size != size || arena_alg->length != expected->length ||
+        memcmp(arena_alg->moves, expected->moves, expected->length * sizeof(move_e)) != 0) {
+        printf("Simplifying an arena alg made %zu heap calls and left %zu of %zu moves:\n", calls,
+               arena_alg->length, size);
+        print_alg(arena_alg);
+        print_alg(expected);
+    }
+
+    alg_free(alg);
+    alg_free(expected);
+    arena_free(arena);
+}
+
 int main(int argc, char *argv[]) {
 
     #define NUM_TESTS 9
@@ -238,7 +693,22 @@ int main(int argc, char *argv[]) {
         alg_s* alg = alg_from_alg_str(argv[1]);
         alg_free(alg);
     } else {
-        test_cube_solve(scrambles, NUM_TESTS);
+        test_arena_simplify();
+        test_move_kernels(scrambles, NUM_TESTS);
+        test_coords(scrambles, NUM_TESTS);
+        test_hash_table(scrambles, NUM_TESTS);
+        test_cube18B_keys(scrambles, NUM_TESTS);
+        xcross1_pruning_table_s *xcross1_pt = xcross1_pruning_table_load("../../ALGORITHMS/XCROSS1_PRUNING_TABLE.bin");
+        coord_tables_s *coord_tables = coord_tables_create();
+        test_xcross1_pruning_table(xcross1_pt, scrambles, NUM_TESTS);
+        test_solve_heap_calls(coord_tables, xcross1_pt, scrambles, NUM_TESTS);
+        test_cube_solve(coord_tables, xcross1_pt, scrambles, NUM_TESTS);
+        test_best_of_each_solve(coord_tables, xcross1_pt, scrambles, 2);
+        test_f2l_transpositions(coord_tables, xcross1_pt, scrambles, NUM_TESTS);
+        test_f2l_pruning(coord_tables, xcross1_pt, scrambles, NUM_TESTS);
+        test_color_neutral_solve(coord_tables, xcross1_pt, scrambles, NUM_TESTS);
+        coord_tables_free(coord_tables);
+        xcross1_pruning_table_free(xcross1_pt);
 
         //test_shiftcube_moves();
         //test_cube18B_moves();
@@ -83,6 +83,46 @@ static const move_e move_rotated_on_y[4][NUM_MOVES] = {
     {MOVE_U, MOVE_U2, MOVE_U3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_D, MOVE_D2, MOVE_D3}
 };
 
+// the same moves after the whole cube turns, see rotate_cube in lookup_tables.h
+static const move_e move_rotated[NUM_FACES][4][NUM_MOVES] = {
+    {
+        {MOVE_D, MOVE_D2, MOVE_D3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_U, MOVE_U2, MOVE_U3},
+        {MOVE_D, MOVE_D2, MOVE_D3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_U, MOVE_U2, MOVE_U3},
+        {MOVE_D, MOVE_D2, MOVE_D3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_U, MOVE_U2, MOVE_U3},
+        {MOVE_D, MOVE_D2, MOVE_D3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_U, MOVE_U2, MOVE_U3}
+    },
+    {
+        {MOVE_R, MOVE_R2, MOVE_R3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_L, MOVE_L2, MOVE_L3},
+        {MOVE_B, MOVE_B2, MOVE_B3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_F, MOVE_F2, MOVE_F3},
+        {MOVE_L, MOVE_L2, MOVE_L3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_R, MOVE_R2, MOVE_R3},
+        {MOVE_F, MOVE_F2, MOVE_F3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_B, MOVE_B2, MOVE_B3}
+    },
+    {
+        {MOVE_F, MOVE_F2, MOVE_F3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_B, MOVE_B2, MOVE_B3},
+        {MOVE_R, MOVE_R2, MOVE_R3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_L, MOVE_L2, MOVE_L3},
+        {MOVE_B, MOVE_B2, MOVE_B3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_F, MOVE_F2, MOVE_F3},
+        {MOVE_L, MOVE_L2, MOVE_L3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3}
+    },
+    {
+        {MOVE_L, MOVE_L2, MOVE_L3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_R, MOVE_R2, MOVE_R3},
+        {MOVE_F, MOVE_F2, MOVE_F3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3},
+        {MOVE_R, MOVE_R2, MOVE_R3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_L, MOVE_L2, MOVE_L3},
+        {MOVE_B, MOVE_B2, MOVE_B3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3}
+    },
+    {
+        {MOVE_B, MOVE_B2, MOVE_B3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_F, MOVE_F2, MOVE_F3},
+        {MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_R, MOVE_R2, MOVE_R3},
+        {MOVE_F, MOVE_F2, MOVE_F3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_B, MOVE_B2, MOVE_B3},
+        {MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_U, MOVE_U2, MOVE_U3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_L, MOVE_L2, MOVE_L3}
+    },
+    {
+        {MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_D, MOVE_D2, MOVE_D3},
+        {MOVE_U, MOVE_U2, MOVE_U3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_D, MOVE_D2, MOVE_D3},
+        {MOVE_U, MOVE_U2, MOVE_U3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_D, MOVE_D2, MOVE_D3},
+        {MOVE_U, MOVE_U2, MOVE_U3, MOVE_F, MOVE_F2, MOVE_F3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_D, MOVE_D2, MOVE_D3}
+    }
+};
+
 static const char* movePrints[NUM_MOVES] = {
     "U",
     "U2",
@@ -0,0 +1,184 @@
+#include "move_kernels.h"
+
+#include <pthread.h>
+
+// Every move is a byte permutation of the 48 real cubies, so a state can be
+// moved with table lookup shuffles: three 16 byte lookups on x86 and a single
+// vqtbl3q on aarch64. The shuffles only pay off once the state stays in a
+// register for a whole alg, so only alg application is vectorized. ARMv6
+// has no NEON, the pi build always uses the scalar kernel.
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MOVE_KERNELS_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define MOVE_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+static void apply_alg_scalar(cubie_e *cubies, size_t num_cubies, const alg_s *alg) {
+    for (size_t i = 0; i < alg->length; i++) {
+        const cubie_e *after = cubieAfterMove[alg->moves[i]];
+        for (size_t cubie = 0; cubie < num_cubies; cubie++) {
+            cubies[cubie] = after[cubies[cubie]];
+        }
+    }
+}
+
+const move_kernel_s MOVE_KERNEL_SCALAR = {"scalar", apply_alg_scalar};
+
+#if defined(MOVE_KERNELS_X86) || defined(MOVE_KERNELS_NEON)
+// cubieAfterMove without the CUBIE_NULL column, 16 byte aligned for vector loads
+static _Alignas(16) uint8_t move_shuffles[NUM_MOVES][NUM_CUBIES];
+
+static void init_move_shuffles(void) {
+    for (move_e move = 0; move < NUM_MOVES; move++) {
+        for (cubie_e cubie = 0; cubie < NUM_CUBIES; cubie++) {
+            move_shuffles[move][cubie] = cubieAfterMove[move][cubie];
+        }
+    }
+}
+#endif
+
+#ifdef MOVE_KERNELS_X86
+// pshufb only looks at the low 4 bits of an index and zeroes the byte when the
+// high bit is set. Adding 0x70 with unsigned saturation keeps 0..15 in range
+// and pushes everything else, including indices that wrapped below 0, past 0x7f
+__attribute__((target("ssse3")))
+static inline __m128i shuffle48_ssse3(const uint8_t *table, __m128i indices) {
+    const __m128i bias = _mm_set1_epi8(0x70);
+    const __m128i sixteen = _mm_set1_epi8(16);
+    __m128i t0 = _mm_load_si128((const __m128i*)table);
+    __m128i t1 = _mm_load_si128((const __m128i*)(table + 16));
+    __m128i t2 = _mm_load_si128((const __m128i*)(table + 32));
+
+    __m128i i1 = _mm_sub_epi8(indices, sixteen);
+    __m128i i2 = _mm_sub_epi8(i1, sixteen);
+    __m128i r = _mm_shuffle_epi8(t0, _mm_adds_epu8(indices, bias));
+    r = _mm_or_si128(r, _mm_shuffle_epi8(t1, _mm_adds_epu8(i1, bias)));
+    return _mm_or_si128(r, _mm_shuffle_epi8(t2, _mm_adds_epu8(i2, bias)));
+}
+
+__attribute__((target("ssse3")))
+static void apply_alg_ssse3(cubie_e *cubies, size_t num_cubies, const alg_s *alg) {
+    _Alignas(16) uint8_t state[MOVE_KERNEL_MAX_CUBIES] = {0};
+    memcpy(state, cubies, num_cubies);
+
+    __m128i lo = _mm_load_si128((const __m128i*)state);
+    if (num_cubies <= 16) {
+        for (size_t i = 0; i < alg->length; i++) {
+            lo = shuffle48_ssse3(move_shuffles[alg->moves[i]], lo);
+        }
+        _mm_store_si128((__m128i*)state, lo);
+    } else {
+        __m128i hi = _mm_load_si128((const __m128i*)(state + 16));
+        for (size_t i = 0; i < alg->length; i++) {
+            lo = shuffle48_ssse3(move_shuffles[alg->moves[i]], lo);
+            hi = shuffle48_ssse3(move_shuffles[alg->moves[i]], hi);
+        }
+        _mm_store_si128((__m128i*)state, lo);
+        _mm_store_si128((__m128i*)(state + 16), hi);
+    }
+
+    memcpy(cubies, state, num_cubies);
+}
+
+// vpshufb shuffles each 128 bit lane on its own, so with the table in both
+// lanes a whole cube18B fits in one register
+__attribute__((target("avx2")))
+static void apply_alg_avx2(cubie_e *cubies, size_t num_cubies, const alg_s *alg) {
+    _Alignas(32) uint8_t state[MOVE_KERNEL_MAX_CUBIES] = {0};
+    memcpy(state, cubies, num_cubies);
+
+    const __m256i bias = _mm256_set1_epi8(0x70);
+    const __m256i sixteen = _mm256_set1_epi8(16);
+    __m256i s = _mm256_load_si256((const __m256i*)state);
+    for (size_t i = 0; i < alg->length; i++) {
+        const uint8_t *table = move_shuffles[alg->moves[i]];
+        __m256i t0 = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)table));
+        __m256i t1 = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)(table + 16)));
+        __m256i t2 = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)(table + 32)));
+
+        __m256i i1 = _mm256_sub_epi8(s, sixteen);
+        __m256i i2 = _mm256_sub_epi8(i1, sixteen);
+        __m256i r = _mm256_shuffle_epi8(t0, _mm256_adds_epu8(s, bias));
+        r = _mm256_or_si256(r, _mm256_shuffle_epi8(t1, _mm256_adds_epu8(i1, bias)));
+        s = _mm256_or_si256(r, _mm256_shuffle_epi8(t2, _mm256_adds_epu8(i2, bias)));
+    }
+    _mm256_store_si256((__m256i*)state, s);
+
+    memcpy(cubies, state, num_cubies);
+}
+
+static const move_kernel_s MOVE_KERNEL_SSSE3 = {"ssse3", apply_alg_ssse3};
+static const move_kernel_s MOVE_KERNEL_AVX2  = {"avx2", apply_alg_avx2};
+#endif
+
+#ifdef MOVE_KERNELS_NEON
+static void apply_alg_neon(cubie_e *cubies, size_t num_cubies, const alg_s *alg) {
+    uint8_t state[MOVE_KERNEL_MAX_CUBIES] = {0};
+    memcpy(state, cubies, num_cubies);
+
+#ifdef __aarch64__
+    // vqtbl3q looks up all 48 entries at once and zeroes anything out of range
+    uint8x16_t lo = vld1q_u8(state);
+    uint8x16_t hi = vld1q_u8(state + 16);
+    for (size_t i = 0; i < alg->length; i++) {
+        const uint8_t *table = move_shuffles[alg->moves[i]];
+        uint8x16x3_t t = {{vld1q_u8(table), vld1q_u8(table + 16), vld1q_u8(table + 32)}};
+        lo = vqtbl3q_u8(t, lo);
+        if (num_cubies > 16) {
+            hi = vqtbl3q_u8(t, hi);
+        }
+    }
+    vst1q_u8(state, lo);
+    vst1q_u8(state + 16, hi);
+#else
+    // ARMv7 only has 8 byte lookups of up to 32 entries, vtbx fills in the
+    // last 16 entries for the indices vtbl4 left at zero
+    uint8x8_t s[4] = {vld1_u8(state), vld1_u8(state + 8), vld1_u8(state + 16), vld1_u8(state + 24)};
+    size_t num_vectors = (num_cubies + 7)/8;
+    const uint8x8_t thirty_two = vdup_n_u8(32);
+    for (size_t i = 0; i < alg->length; i++) {
+        const uint8_t *table = move_shuffles[alg->moves[i]];
+        uint8x8x4_t low = {{vld1_u8(table), vld1_u8(table + 8), vld1_u8(table + 16), vld1_u8(table + 24)}};
+        uint8x8x2_t high = {{vld1_u8(table + 32), vld1_u8(table + 40)}};
+        for (size_t v = 0; v < num_vectors; v++) {
+            s[v] = vtbx2_u8(vtbl4_u8(low, s[v]), high, vsub_u8(s[v], thirty_two));
+        }
+    }
+    for (size_t v = 0; v < 4; v++) {
+        vst1_u8(state + 8*v, s[v]);
+    }
+#endif
+
+    memcpy(cubies, state, num_cubies);
+}
+
+static const move_kernel_s MOVE_KERNEL_NEON = {"neon", apply_alg_neon};
+#endif
+
+static const move_kernel_s *best_kernel = &MOVE_KERNEL_SCALAR;
+static pthread_once_t best_kernel_once = PTHREAD_ONCE_INIT;
+
+static void pick_best_kernel(void) {
+#if defined(MOVE_KERNELS_X86) || defined(MOVE_KERNELS_NEON)
+    init_move_shuffles();
+#endif
+
+#ifdef MOVE_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        best_kernel = &MOVE_KERNEL_AVX2;
+    } else if (__builtin_cpu_supports("ssse3")) {
+        best_kernel = &MOVE_KERNEL_SSSE3;
+    }
+#elif defined(MOVE_KERNELS_NEON)
+    best_kernel = &MOVE_KERNEL_NEON;
+#endif
+}
+
+const move_kernel_s* move_kernel_best(void) {
+    pthread_once(&best_kernel_once, pick_best_kernel);
+    return best_kernel;
+}
@@ -0,0 +1,25 @@
+#ifndef MOVE_KERNELS_H
+#define MOVE_KERNELS_H
+
+#include "main.h"
+#include "alg.h"
+#include "cube18B.h"
+
+// applies every move of alg to num_cubies real cubies (not CUBIE_NULL) in place,
+// num_cubies can be at most MOVE_KERNEL_MAX_CUBIES
+typedef void (*apply_alg_kernel_f)(cubie_e *cubies, size_t num_cubies, const alg_s *alg);
+
+#define MOVE_KERNEL_MAX_CUBIES 32
+
+typedef struct {
+    const char *name;
+    apply_alg_kernel_f apply_alg;
+} move_kernel_s;
+
+// the plain cubieAfterMove lookups, available everywhere
+extern const move_kernel_s MOVE_KERNEL_SCALAR;
+
+// the fastest kernel this cpu supports, picked the first time it's called
+const move_kernel_s* move_kernel_best(void);
+
+#endif // MOVE_KERNELS_H
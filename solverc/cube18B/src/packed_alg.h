@@ -0,0 +1,80 @@
+#ifndef PACKED_ALG_H
+#define PACKED_ALG_H
+
+#include "main.h"
+#include "alg.h"
+#include "move.h"
+
+// An alg of up to 12 moves packed into a single word, move i in bits 5i to
+// 5i+4 and the length in the top nibble. Tables keep these inline instead of
+// an alg_s, so reading an alg out of a table doesn't chase a pointer to its
+// moves, and inverting or joining two of them is a few shifts
+typedef uint64_t packed_alg_t;
+
+#define PACKED_ALG_MAX_MOVES    12
+#define PACKED_ALG_MOVE_BITS     5
+#define PACKED_ALG_MOVE_MASK  0x1fULL
+#define PACKED_ALG_LENGTH_SHIFT 60
+#define PACKED_ALG_MOVES_MASK ((1ULL << PACKED_ALG_LENGTH_SHIFT) - 1)
+
+static inline size_t packed_alg_length(packed_alg_t alg) {
+    return alg >> PACKED_ALG_LENGTH_SHIFT;
+}
+
+static inline move_e packed_alg_move(packed_alg_t alg, size_t index) {
+    return (alg >> (PACKED_ALG_MOVE_BITS*index)) & PACKED_ALG_MOVE_MASK;
+}
+
+// the caller makes sure there's room, the length has to stay under PACKED_ALG_MAX_MOVES
+static inline packed_alg_t packed_alg_append(packed_alg_t alg, move_e move) {
+    size_t length = packed_alg_length(alg);
+    return ((alg & PACKED_ALG_MOVES_MASK) | ((packed_alg_t)move << (PACKED_ALG_MOVE_BITS*length))) |
+           ((packed_alg_t)(length + 1) << PACKED_ALG_LENGTH_SHIFT);
+}
+
+// the caller makes sure both fit together
+static inline packed_alg_t packed_alg_concat(packed_alg_t first, packed_alg_t second) {
+    size_t first_length = packed_alg_length(first);
+    return (first & PACKED_ALG_MOVES_MASK) |
+           ((second & PACKED_ALG_MOVES_MASK) << (PACKED_ALG_MOVE_BITS*first_length)) |
+           ((packed_alg_t)(first_length + packed_alg_length(second)) << PACKED_ALG_LENGTH_SHIFT);
+}
+
+static inline packed_alg_t packed_alg_invert(packed_alg_t alg) {
+    size_t length = packed_alg_length(alg);
+    packed_alg_t inverted = (packed_alg_t)length << PACKED_ALG_LENGTH_SHIFT;
+    for (size_t i = 0; i < length; i++) {
+        move_e move = move_inverted[packed_alg_move(alg, length - 1 - i)];
+        inverted |= (packed_alg_t)move << (PACKED_ALG_MOVE_BITS*i);
+    }
+    return inverted;
+}
+
+// false if alg is too long to pack
+static inline bool packed_alg_from_alg(const alg_s *alg, packed_alg_t *packed) {
+    if (alg->length > PACKED_ALG_MAX_MOVES) {
+        return false;
+    }
+
+    *packed = (packed_alg_t)alg->length << PACKED_ALG_LENGTH_SHIFT;
+    for (size_t i = 0; i < alg->length; i++) {
+        *packed |= (packed_alg_t)alg->moves[i] << (PACKED_ALG_MOVE_BITS*i);
+    }
+    return true;
+}
+
+// unpacks into moves, which needs room for PACKED_ALG_MAX_MOVES, and returns
+// an alg_s looking at them
+static inline alg_s packed_alg_unpack(packed_alg_t packed, move_e *moves) {
+    size_t length = packed_alg_length(packed);
+    for (size_t i = 0; i < length; i++) {
+        moves[i] = packed_alg_move(packed, i);
+    }
+    return (alg_s) {
+        .moves = moves,
+        .length = length,
+        .size = PACKED_ALG_MAX_MOVES,
+    };
+}
+
+#endif // PACKED_ALG_H
@@ -2,52 +2,240 @@
 
 #include "solver.h"
 
+#include "coord.h"
 #include "cube18B.h"
 #include "lookup_tables.h"
 #include "move.h"
 #include "translators.h"
 
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <sys/resource.h>
 #include <sys/types.h>
+#include <unistd.h>
+
+// the four pairs are searched at the same time, the workers only share
+// read only tables
+#define MAX_XCROSS1_WORKERS 4
+
+// everything a single solve writes to, so solves on different contexts can run
+// at the same time. The F2L and last layer tables are only ever read
+typedef struct solver_ctx {
+    const F2L_table_s *f2l_table;
+    const LL_table_s *ll_table;
+
+    // only needed by the xcross4 search strategies, see solver_ctx_init_xcross4
+    xcross_search_e xcross_search;
+    xcross4_table_s *xcross4_start_ct;
+    xcross4_table_s *xcross4_end_ct;
+
+    // F2L stage states already expanded during the current solve, NULL unless
+    // solver_ctx_set_f2l_transpositions turned it on
+    transposition_table_s *f2l_tt;
+    // see f2l_prune, off unless solver_ctx_set_f2l_pruning turned it on
+    bool f2l_pruning;
+
+    // move tables and ranks for the xcross1 searches, both are only read
+    const coord_tables_s *coord_tables;
+    const xcross1_pruning_table_s *xcross1_pt;
+
+    size_t num_xcross1_workers;
+
+    // everything a solve allocates comes out of these and is dropped when the
+    // next solve starts, each xcross1 worker has its own so they never share
+    arena_s *arena;
+    arena_s *worker_arenas[MAX_XCROSS1_WORKERS];
+
+    // the best solve so far and the one the last layer stage builds next, they
+    // trade places whenever the best is beaten
+    alg_s *solve_buffers[2];
+    alg_s *candidate;
+
+    // the peak resident set of the last solve and over all of them, in kB. Only
+    // kept when track_peak_rss is set, see solver_ctx_track_peak_rss
+    bool track_peak_rss;
+    size_t peak_rss;
+    size_t max_peak_rss;
+    size_t total_peak_rss;
+    size_t num_solves;
+} solver_ctx_s;
+
+solver_ctx_s* solver_ctx_create(const F2L_table_s *f2l_table, const LL_table_s *ll_table,
+                                const coord_tables_s *coord_tables, const xcross1_pruning_table_s *xcross1_pt,
+                                size_t num_workers) {
+    solver_ctx_s *ctx = (solver_ctx_s*)calloc(1, sizeof(solver_ctx_s));
+    if (!ctx) {
+        return NULL;
+    }
+    ctx->f2l_table = f2l_table;
+    ctx->ll_table  = ll_table;
+    ctx->coord_tables = coord_tables;
+    ctx->xcross1_pt = xcross1_pt;
+
+    if (num_workers == 0) {
+        // a worker per core, there's no point in having more than one per pair
+        long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = (num_cores < 1) ? 1 : num_cores;
+    }
+    ctx->num_xcross1_workers = (num_workers > MAX_XCROSS1_WORKERS) ? MAX_XCROSS1_WORKERS : num_workers;
 
-static xcross4_table_s *xcross4_start_ct = NULL;
-static xcross4_table_s *xcross4_end_ct   = NULL;
+    // the first few solves grow these until they fit, after that a solve
+    // doesn't touch the heap until it returns its solution
+    ctx->arena = arena_create(1 << 16);
+    for (size_t worker = 0; worker < ctx->num_xcross1_workers; worker++) {
+        ctx->worker_arenas[worker] = arena_create(1 << 10);
+    }
+    ctx->solve_buffers[0] = alg_create(64);
+    ctx->solve_buffers[1] = alg_create(64);
+    if (!ctx->arena || !ctx->solve_buffers[0] || !ctx->solve_buffers[1]) {
+        solver_ctx_free(ctx);
+        return NULL;
+    }
+    for (size_t worker = 0; worker < ctx->num_xcross1_workers; worker++) {
+        if (!ctx->worker_arenas[worker]) {
+            solver_ctx_free(ctx);
+            return NULL;
+        }
+    }
 
-bool init_solver4() {
-    xcross4_start_ct = xcross4_table_create(6008461);
-    xcross4_end_ct   = xcross4_table_create(6008461);
-    if (!xcross4_start_ct || !xcross4_end_ct) {
+    return ctx;
+}
+
+// The deepest each side of the xcross4 searches goes, an xcross is at most
+// twice this
+#define XCROSS4_MAX_DEPTH 5
+
+// The most states either xcross4 table held once a search had been through
+// each depth, over 60 random scrambles, rounded up. The tables are sized for
+// a depth right before it's searched, so a search that stops early never pays
+// for the depths it didn't reach
+static const size_t xcross4_depth_entries[XCROSS4_MAX_DEPTH + 1] = {
+    16, 128, 2048, 16384, 196608, 1572864
+};
+
+bool solver_ctx_init_xcross4(solver_ctx_s *ctx) {
+    if (ctx->xcross4_start_ct && ctx->xcross4_end_ct) {
+        return true;
+    }
+
+    ctx->xcross4_start_ct = xcross4_table_create(xcross4_depth_entries[0]);
+    ctx->xcross4_end_ct   = xcross4_table_create(xcross4_depth_entries[0]);
+    if (!ctx->xcross4_start_ct || !ctx->xcross4_end_ct) {
         return false;
     }
 
     return true;
 }
 
-void cleanup_solver4() {
-    xcross4_table_free(xcross4_start_ct);
-    xcross4_table_free(xcross4_end_ct);
+bool solver_ctx_set_xcross_search(solver_ctx_s *ctx, xcross_search_e search) {
+    if (search != XCROSS_SEARCH_OPTIMAL_OF_EACH && !solver_ctx_init_xcross4(ctx)) {
+        return false;
+    }
+
+    ctx->xcross_search = search;
+    return true;
 }
 
-static xcross1_table_s *xcross1_start_ct = NULL;
-static xcross1_table_s *xcross1_end_ct   = NULL;
+bool solver_ctx_set_f2l_transpositions(solver_ctx_s *ctx, bool enabled) {
+    if (!enabled) {
+        transposition_table_free(ctx->f2l_tt);
+        ctx->f2l_tt = NULL;
+        return true;
+    }
 
-bool init_solver1() {
-    xcross1_start_ct = xcross1_table_create(cube_table_depth_sizes[5]);
-    xcross1_end_ct   = xcross1_table_create(cube_table_depth_sizes[5]);
-    if (!xcross1_start_ct || !xcross1_end_ct) {
-        return false;
+    // a solve expands a few thousand F2L states at most
+    if (!ctx->f2l_tt) {
+        ctx->f2l_tt = transposition_table_create(8192);
     }
+    return ctx->f2l_tt != NULL;
+}
 
-    return true;
+void solver_ctx_set_f2l_pruning(solver_ctx_s *ctx, bool enabled) {
+    ctx->f2l_pruning = enabled;
+}
+
+void solver_ctx_print_stats(const solver_ctx_s *ctx) {
+    if (ctx->f2l_tt) {
+        size_t lookups = transposition_table_lookups(ctx->f2l_tt);
+        size_t hits = transposition_table_hits(ctx->f2l_tt);
+        printf("F2L transposition table: %zu of %zu states were repeats (%.1f%%)\n",
+               hits, lookups, lookups ? 100.0*hits/lookups : 0.0);
+    }
+    if (ctx->num_solves) {
+        printf("Peak RSS per solve: %zu kB on average, %zu kB at most\n",
+               ctx->total_peak_rss / ctx->num_solves, ctx->max_peak_rss);
+    }
+}
+
+void solver_ctx_track_peak_rss(solver_ctx_s *ctx, bool track) {
+    ctx->track_peak_rss = track;
+}
+
+// the peak resident set of the last solve in kB, 0 unless it's being tracked
+size_t solver_ctx_peak_rss(const solver_ctx_s *ctx) {
+    return ctx->peak_rss;
+}
+
+// solves in progress on any context, the peak is only started again when a
+// solve has the process to itself so it never wipes out another solve's peak
+static size_t solves_running;
+
+// Linux keeps the peak resident set in /proc/self/status and lets us start it
+// again from the current one. This is the whole process, so solves running at
+// the same time on other contexts count towards each other's peaks. Only raw
+// reads and writes are used, a solve mustn't make any heap calls of its own
+static void peak_rss_reset(void) {
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd != -1) {
+        (void)!write(fd, "5", 1);
+        close(fd);
+    }
+}
+
+static size_t peak_rss_read(void) {
+    char status[4096];
+    ssize_t length = -1;
+    int fd = open("/proc/self/status", O_RDONLY);
+    if (fd != -1) {
+        length = read(fd, status, sizeof(status) - 1);
+        close(fd);
+    }
+
+    if (length > 0) {
+        status[length] = '\0';
+        const char *hwm = strstr(status, "VmHWM:");
+        if (hwm) {
+            return strtoul(hwm + strlen("VmHWM:"), NULL, 10);
+        }
+    }
+
+    // without /proc the best there is is the peak over the whole run
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return usage.ru_maxrss;
+    }
+    return 0;
 }
 
-void cleanup_solver1() {
-    xcross1_table_free(xcross1_start_ct);
-    xcross1_table_free(xcross1_end_ct);
+void solver_ctx_free(solver_ctx_s *ctx) {
+    if (ctx == NULL) return;
+    xcross4_table_free(ctx->xcross4_start_ct);
+    xcross4_table_free(ctx->xcross4_end_ct);
+    transposition_table_free(ctx->f2l_tt);
+    arena_free(ctx->arena);
+    for (size_t worker = 0; worker < ctx->num_xcross1_workers; worker++) {
+        arena_free(ctx->worker_arenas[worker]);
+    }
+    alg_free(ctx->solve_buffers[0]);
+    alg_free(ctx->solve_buffers[1]);
+    free(ctx);
 }
 
 int bidirectional_recursion_best_of_each(
-        cube18B_xcross4_s *cube, 
+        arena_s *arena,
+        cube18B_xcross4_hashed_s *cube, 
         xcross4_table_s *our_ct, 
         const xcross4_table_s *other_ct, 
         alg_s *alg, 
@@ -58,13 +246,12 @@ int bidirectional_recursion_best_of_each(
     if (depth == 0) {
         for (uint8_t pair = 0; pair < 4; pair++) {
             if (!pairs_done[pair]) {
-                cube18B_xcross4_s x = *cube;
-                cube18B_xcross4_maskOnPair(&x, pair);
-                if (xcross4_table_lookup(other_ct, &x) != NULL && 
-                    xcross4_table_lookup(our_ct, &x) == NULL) {
-                    cube_list_append(cube_lists[pair], &x);
+                cube18B_xcross4_hashed_s x = cube18B_xcross4_hashed_maskOnPair(cube, pair);
+                if (xcross4_table_lookup_hashed(other_ct, &x, NULL) != NULL && 
+                    xcross4_table_lookup_hashed(our_ct, &x, NULL) == NULL) {
+                    cube_list_arena_append(arena, cube_lists[pair], &x.cube);
                 }
-                xcross4_table_insert(our_ct, &x, alg);
+                xcross4_table_insert_hashed(our_ct, &x, alg);
             }
         }
         return 0;
@@ -72,6 +259,8 @@ int bidirectional_recursion_best_of_each(
 
     move_e prev_move = (alg->length >= 1) ? alg->moves[alg->length-1] : MOVE_NULL;
     move_e prev_prev_move = (alg->length >= 2) ? alg->moves[alg->length - 2] : MOVE_NULL;
+    // undoing a move is putting this back, rather than working out the key and hash again
+    const cube18B_xcross4_hashed_s parent = *cube;
 
     for (move_e move = 0; move < NUM_MOVES; move++) {
         if (move_faces[move] == move_faces[prev_move]) {
@@ -84,27 +273,27 @@ int bidirectional_recursion_best_of_each(
         }
 
         alg_insert(alg, move, alg->length);
-        cube18B_xcross4_apply_move(cube, move);
+        cube18B_xcross4_hashed_apply_move(cube, move);
 
-        bidirectional_recursion_best_of_each(cube, our_ct, other_ct, alg, pairs_done, cube_lists, depth - 1);
+        bidirectional_recursion_best_of_each(arena, cube, our_ct, other_ct, alg, pairs_done, cube_lists, depth - 1);
         
         alg_delete(alg, alg->length-1);
-        cube18B_xcross4_apply_move(cube, move_inverted[move]); // undo move
+        *cube = parent; // undo move
     }
     return 0;
 }
 
-static void xcross_search_best_of_each(const cube18B_xcross4_s *start, alg_list_s* xsolves) {
-    if (!xcross4_start_ct || !xcross4_end_ct) {
-        printf("Didn't have the tables initialized :(\n");
-        return;
-    }
+static void xcross_search_best_of_each(solver_ctx_s *ctx, const cube18B_xcross4_s *start, alg_list_s* xsolves) {
+    xcross4_table_s *xcross4_start_ct = ctx->xcross4_start_ct;
+    xcross4_table_s *xcross4_end_ct   = ctx->xcross4_end_ct;
+    // solver_ctx_set_xcross_search only picks this search once the tables are made
+    assert(xcross4_start_ct && xcross4_end_ct);
 
-    alg_s *start_alg = alg_create(5);
-    alg_s *end_alg   = alg_create(5);
+    alg_s *start_alg = alg_arena_create(ctx->arena, XCROSS4_MAX_DEPTH);
+    alg_s *end_alg   = alg_arena_create(ctx->arena, XCROSS4_MAX_DEPTH);
 
-    cube18B_xcross4_s start_cube = *start;
-    cube18B_xcross4_s end_cube   = SOLVED_CUBE18B_XCROSS4;
+    cube18B_xcross4_hashed_s start_cube = cube18B_xcross4_hashed_from(start);
+    cube18B_xcross4_hashed_s end_cube   = cube18B_xcross4_hashed_from(&SOLVED_CUBE18B_XCROSS4);
     //printf("=============STARTING XCROSS===========\n");
     //printf("START_CUBE: \n");
     //print_cube_map_colors(start_cube);
@@ -112,43 +301,51 @@ static void xcross_search_best_of_each(const cube18B_xcross4_s *start, alg_list_
     //print_cube_map_colors(end_cube);
     bool pairs_done[4] = { false };
     cube_list_s* cube_lists[4] = {
-        cube_list_create(4),
-        cube_list_create(4),
-        cube_list_create(4),
-        cube_list_create(4),
+        cube_list_arena_create(ctx->arena, 4),
+        cube_list_arena_create(ctx->arena, 4),
+        cube_list_arena_create(ctx->arena, 4),
+        cube_list_arena_create(ctx->arena, 4),
     };
     bool done;
-    for (uint8_t depth = 0; depth <= 5; depth++) {
-        bidirectional_recursion_best_of_each(&start_cube, xcross4_start_ct, xcross4_end_ct, start_alg, pairs_done, cube_lists, depth);
+    for (uint8_t depth = 0; depth <= XCROSS4_MAX_DEPTH; depth++) {
+        xcross4_table_reserve(xcross4_start_ct, xcross4_depth_entries[depth]);
+        bidirectional_recursion_best_of_each(ctx->arena, &start_cube, xcross4_start_ct, xcross4_end_ct, start_alg, pairs_done,
+                                             cube_lists, depth);
         done = true;
         for (uint8_t pair = 0; pair < 4; pair++) {
             if (cube_lists[pair]->length > 0) {
                 pairs_done[pair] = true;
             } else done = false;
         } if (done) break;
-        if (!compare_cube18B_xcross4(start, &start_cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
+        // the recursion puts every move it makes back
+        assert(compare_cube18B_xcross4(start, &start_cube.cube) &&
+               compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube.cube));
 
-        bidirectional_recursion_best_of_each(&end_cube, xcross4_end_ct, xcross4_start_ct, end_alg, pairs_done, cube_lists, depth);
+        xcross4_table_reserve(xcross4_end_ct, xcross4_depth_entries[depth]);
+        bidirectional_recursion_best_of_each(ctx->arena, &end_cube, xcross4_end_ct, xcross4_start_ct, end_alg, pairs_done,
+                                             cube_lists, depth);
         done = true;
         for (uint8_t pair = 0; pair < 4; pair++) {
             if (cube_lists[pair]->length > 0) {
                 pairs_done[pair] = true;
             } else done = false;
         } if (done) break;
-        if (!compare_cube18B_xcross4(start, &start_cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
+        // the recursion puts every move it makes back
+        assert(compare_cube18B_xcross4(start, &start_cube.cube) &&
+               compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube.cube));
     }
     for (uint8_t pair = 0; pair < 4; pair++) {
         for (size_t i = 0; i < cube_lists[pair]->length; i++) {
             cube18B_xcross4_s cube = cube_lists[pair]->cubes[i];
-            const alg_list_s* alg_list1 = xcross4_table_lookup(xcross4_start_ct, &cube);
-            const alg_list_s* alg_list2 = xcross4_table_lookup(xcross4_end_ct, &cube);
-            for (size_t alg1 = 0; alg1 < alg_list1->num_algs; alg1++) {
-                for (size_t alg2 = 0; alg2 < alg_list2->num_algs; alg2++) {
-                    alg_s start_algo = alg_static_copy(&(alg_list1->list[alg1]));
-                    alg_s end_algo = alg_static_copy(&(alg_list2->list[alg2]));
-                    alg_invert(&end_algo);
-                    alg_concat(&start_algo, &end_algo);
-                    alg_list_append(xsolves, &start_algo);
+            size_t num_algs1, num_algs2;
+            const packed_alg_t* algs1 = xcross4_table_lookup(xcross4_start_ct, &cube, &num_algs1);
+            const packed_alg_t* algs2 = xcross4_table_lookup(xcross4_end_ct, &cube, &num_algs2);
+            for (size_t alg1 = 0; alg1 < num_algs1; alg1++) {
+                for (size_t alg2 = 0; alg2 < num_algs2; alg2++) {
+                    // both halves are at most 5 moves, so they always fit together
+                    move_e moves[PACKED_ALG_MAX_MOVES];
+                    alg_s xsolve = packed_alg_unpack(packed_alg_concat(algs1[alg1], packed_alg_invert(algs2[alg2])), moves);
+                    alg_list_arena_append(ctx->arena, xsolves, &xsolve);
                 }
             }
         }
@@ -156,7 +353,7 @@ static void xcross_search_best_of_each(const cube18B_xcross4_s *start, alg_list_
 }
 
 int bidirectional_recursion_best_of_any(
-        cube18B_xcross4_s *cube, 
+        cube18B_xcross4_hashed_s *cube, 
         xcross4_table_s *our_ct, 
         const xcross4_table_s *other_ct, 
         alg_s *alg, 
@@ -165,19 +362,20 @@ int bidirectional_recursion_best_of_any(
     ) {
     if (depth == 0) {
         for (uint8_t pair = 0; pair < 4; pair++) {
-            cube18B_xcross4_s x = *cube;
-            cube18B_xcross4_maskOnPair(&x, pair);
-            if (xcross4_table_lookup(other_ct, &x) != NULL && 
-                xcross4_table_lookup(our_ct, &x) == NULL) {
-                cube_list_append(cube_list, &x);
+            cube18B_xcross4_hashed_s x = cube18B_xcross4_hashed_maskOnPair(cube, pair);
+            if (xcross4_table_lookup_hashed(other_ct, &x, NULL) != NULL && 
+                xcross4_table_lookup_hashed(our_ct, &x, NULL) == NULL) {
+                cube_list_append(cube_list, &x.cube);
             }
-            xcross4_table_insert(our_ct, &x, alg);
+            xcross4_table_insert_hashed(our_ct, &x, alg);
         }
         return 0;
     }
 
     move_e prev_move = (alg->length >= 1) ? alg->moves[alg->length-1] : MOVE_NULL;
     move_e prev_prev_move = (alg->length >= 2) ? alg->moves[alg->length - 2] : MOVE_NULL;
+    // undoing a move is putting this back, rather than working out the key and hash again
+    const cube18B_xcross4_hashed_s parent = *cube;
 
     for (move_e move = 0; move < NUM_MOVES; move++) {
         if (move_faces[move] == move_faces[prev_move]) {
@@ -190,17 +388,19 @@ int bidirectional_recursion_best_of_any(
         }
 
         alg_insert(alg, move, alg->length);
-        cube18B_xcross4_apply_move(cube, move);
+        cube18B_xcross4_hashed_apply_move(cube, move);
 
         bidirectional_recursion_best_of_any(cube, our_ct, other_ct, alg, cube_list, depth - 1);
         
         alg_delete(alg, alg->length-1);
-        cube18B_xcross4_apply_move(cube, move_inverted[move]); // undo move
+        *cube = parent; // undo move
     }
     return 0;
 }
 
-static void xcross_search_best_of_any(const cube18B_xcross4_s *start, alg_list_s* xsolves) {
+static void xcross_search_best_of_any(solver_ctx_s *ctx, const cube18B_xcross4_s *start, alg_list_s* xsolves) {
+    xcross4_table_s *xcross4_start_ct = ctx->xcross4_start_ct;
+    xcross4_table_s *xcross4_end_ct   = ctx->xcross4_end_ct;
     if (!xcross4_start_ct || !xcross4_end_ct) {
         printf("Didn't have the tables initialized :(\n");
         return;
@@ -209,8 +409,8 @@ static void xcross_search_best_of_any(const cube18B_xcross4_s *start, alg_list_s
     alg_s *start_alg = alg_create(5);
     alg_s *end_alg   = alg_create(5);
 
-    cube18B_xcross4_s start_cube = *start;
-    cube18B_xcross4_s end_cube   = SOLVED_CUBE18B_XCROSS4;
+    cube18B_xcross4_hashed_s start_cube = cube18B_xcross4_hashed_from(start);
+    cube18B_xcross4_hashed_s end_cube   = cube18B_xcross4_hashed_from(&SOLVED_CUBE18B_XCROSS4);
     //printf("=============STARTING XCROSS===========\n");
     //printf("START_CUBE: \n");
     //print_cube_map_colors(start_cube);
@@ -221,30 +421,30 @@ static void xcross_search_best_of_any(const cube18B_xcross4_s *start, alg_list_s
     for (uint8_t depth = 0; depth <= 5; depth++) {
         bidirectional_recursion_best_of_any(&start_cube, xcross4_start_ct, xcross4_end_ct, start_alg, cube_list, depth);
         if (cube_list->length > 0) break;
-        if (!compare_cube18B_xcross4(start, &start_cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
+        if (!compare_cube18B_xcross4(start, &start_cube.cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube.cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
 
         bidirectional_recursion_best_of_any(&end_cube, xcross4_end_ct, xcross4_start_ct, end_alg, cube_list, depth);
         if (cube_list->length > 0) break;
-        if (!compare_cube18B_xcross4(start, &start_cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
+        if (!compare_cube18B_xcross4(start, &start_cube.cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube.cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
     }
 
     for (size_t i = 0; i < cube_list->length; i++) {
         cube18B_xcross4_s cube = cube_list->cubes[i];
-        const alg_list_s* alg_list1 = xcross4_table_lookup(xcross4_start_ct, &cube);
-        const alg_list_s* alg_list2 = xcross4_table_lookup(xcross4_end_ct, &cube);
-        for (size_t alg1 = 0; alg1 < alg_list1->num_algs; alg1++) {
-            for (size_t alg2 = 0; alg2 < alg_list2->num_algs; alg2++) {
-                alg_s start_algo = alg_static_copy(&(alg_list1->list[alg1]));
-                alg_s end_algo = alg_static_copy(&(alg_list2->list[alg2]));
-                alg_invert(&end_algo);
-                alg_concat(&start_algo, &end_algo);
-                alg_list_append(xsolves, &start_algo);
+        size_t num_algs1, num_algs2;
+        const packed_alg_t* algs1 = xcross4_table_lookup(xcross4_start_ct, &cube, &num_algs1);
+        const packed_alg_t* algs2 = xcross4_table_lookup(xcross4_end_ct, &cube, &num_algs2);
+        for (size_t alg1 = 0; alg1 < num_algs1; alg1++) {
+            for (size_t alg2 = 0; alg2 < num_algs2; alg2++) {
+                // both halves are at most 5 moves, so they always fit together
+                move_e moves[PACKED_ALG_MAX_MOVES];
+                alg_s xsolve = packed_alg_unpack(packed_alg_concat(algs1[alg1], packed_alg_invert(algs2[alg2])), moves);
+                alg_list_append(xsolves, &xsolve);
             }
         }
     }
 }
 int bidirectional_recursion_first_of_each_together(
-        cube18B_xcross4_s *cube, 
+        cube18B_xcross4_hashed_s *cube, 
         xcross4_table_s *our_ct, 
         const xcross4_table_s *other_ct, 
         alg_s *alg, 
@@ -256,27 +456,29 @@ int bidirectional_recursion_first_of_each_together(
         bool done = true;
         for (uint8_t pair = 0; pair < 4; pair++) {
             if (!pairs_done[pair]) {
-                cube18B_xcross4_s x = *cube;
-                cube18B_xcross4_maskOnPair(&x, pair);
-                if (xcross4_table_lookup(other_ct, &x) != NULL && 
-                    xcross4_table_lookup(our_ct, &x) == NULL) {
-                    cube_list_append(cube_list, &x);
+                cube18B_xcross4_hashed_s x = cube18B_xcross4_hashed_maskOnPair(cube, pair);
+                if (xcross4_table_lookup_hashed(other_ct, &x, NULL) != NULL && 
+                    xcross4_table_lookup_hashed(our_ct, &x, NULL) == NULL) {
+                    cube_list_append(cube_list, &x.cube);
                     pairs_done[pair] = true;
                 }
-                xcross4_table_insert(our_ct, &x, alg);
+                xcross4_table_insert_hashed(our_ct, &x, alg);
                 done = false;
             }
         }
-        xcross4_table_insert(our_ct, cube, alg);
+        xcross4_table_insert_hashed(our_ct, cube, alg);
         return done;
     }
 
-    if (xcross4_table_lookup(our_ct, cube) != NULL && xcross4_table_lookup(our_ct, cube)->list[0].length < alg->length) {
+    const packed_alg_t *found = xcross4_table_lookup_hashed(our_ct, cube, NULL);
+    if (found != NULL && packed_alg_length(found[0]) < alg->length) {
         return 0;
     }
 
     move_e prev_move = (alg->length >= 1) ? alg->moves[alg->length-1] : MOVE_NULL;
     move_e prev_prev_move = (alg->length >= 2) ? alg->moves[alg->length - 2] : MOVE_NULL;
+    // undoing a move is putting this back, rather than working out the key and hash again
+    const cube18B_xcross4_hashed_s parent = *cube;
 
     for (move_e move = 0; move < NUM_MOVES; move++) {
         if (move_faces[move] == move_faces[prev_move]) {
@@ -289,19 +491,21 @@ int bidirectional_recursion_first_of_each_together(
         }
 
         alg_insert(alg, move, alg->length);
-        cube18B_xcross4_apply_move(cube, move);
+        cube18B_xcross4_hashed_apply_move(cube, move);
 
         if (bidirectional_recursion_first_of_each_together(cube, our_ct, other_ct, alg, pairs_done, cube_list, depth - 1)) {
             return 1;
         }
         
         alg_delete(alg, alg->length-1);
-        cube18B_xcross4_apply_move(cube, move_inverted[move]); // undo move
+        *cube = parent; // undo move
     }
     return 0;
 }
 
-static void xcross_search_first_of_each_together(const cube18B_xcross4_s *start, alg_list_s* xsolves) {
+static void xcross_search_first_of_each_together(solver_ctx_s *ctx, const cube18B_xcross4_s *start, alg_list_s* xsolves) {
+    xcross4_table_s *xcross4_start_ct = ctx->xcross4_start_ct;
+    xcross4_table_s *xcross4_end_ct   = ctx->xcross4_end_ct;
     if (!xcross4_start_ct || !xcross4_end_ct) {
         printf("Didn't have the tables initialized :(\n");
         return;
@@ -310,8 +514,8 @@ static void xcross_search_first_of_each_together(const cube18B_xcross4_s *start,
     alg_s *start_alg = alg_create(5);
     alg_s *end_alg   = alg_create(5);
 
-    cube18B_xcross4_s start_cube = *start;
-    cube18B_xcross4_s end_cube   = SOLVED_CUBE18B_XCROSS4;
+    cube18B_xcross4_hashed_s start_cube = cube18B_xcross4_hashed_from(start);
+    cube18B_xcross4_hashed_s end_cube   = cube18B_xcross4_hashed_from(&SOLVED_CUBE18B_XCROSS4);
     //printf("=============STARTING XCROSS===========\n");
     //printf("START_CUBE: \n");
     //print_cube_map_colors(start_cube);
@@ -323,30 +527,30 @@ static void xcross_search_first_of_each_together(const cube18B_xcross4_s *start,
     for (uint8_t depth = 0; depth <= 5; depth++) {
         bidirectional_recursion_first_of_each_together(&start_cube, xcross4_start_ct, xcross4_end_ct, start_alg, pairs_done, cube_list, depth);
         if (cube_list->length == 4) break;
-        if (!compare_cube18B_xcross4(start, &start_cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
+        if (!compare_cube18B_xcross4(start, &start_cube.cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube.cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
 
         bidirectional_recursion_first_of_each_together(&end_cube, xcross4_end_ct, xcross4_start_ct, end_alg, pairs_done, cube_list, depth);
         if (cube_list->length == 4) break;
-        if (!compare_cube18B_xcross4(start, &start_cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
+        if (!compare_cube18B_xcross4(start, &start_cube.cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube.cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
     }
 
     for (size_t i = 0; i < cube_list->length; i++) {
         cube18B_xcross4_s cube = cube_list->cubes[i];
-        const alg_list_s* alg_list1 = xcross4_table_lookup(xcross4_start_ct, &cube);
-        const alg_list_s* alg_list2 = xcross4_table_lookup(xcross4_end_ct, &cube);
-        for (size_t alg1 = 0; alg1 < alg_list1->num_algs; alg1++) {
-            for (size_t alg2 = 0; alg2 < alg_list2->num_algs; alg2++) {
-                alg_s start_algo = alg_static_copy(&(alg_list1->list[alg1]));
-                alg_s end_algo = alg_static_copy(&(alg_list2->list[alg2]));
-                alg_invert(&end_algo);
-                alg_concat(&start_algo, &end_algo);
-                alg_list_append(xsolves, &start_algo);
+        size_t num_algs1, num_algs2;
+        const packed_alg_t* algs1 = xcross4_table_lookup(xcross4_start_ct, &cube, &num_algs1);
+        const packed_alg_t* algs2 = xcross4_table_lookup(xcross4_end_ct, &cube, &num_algs2);
+        for (size_t alg1 = 0; alg1 < num_algs1; alg1++) {
+            for (size_t alg2 = 0; alg2 < num_algs2; alg2++) {
+                // both halves are at most 5 moves, so they always fit together
+                move_e moves[PACKED_ALG_MAX_MOVES];
+                alg_s xsolve = packed_alg_unpack(packed_alg_concat(algs1[alg1], packed_alg_invert(algs2[alg2])), moves);
+                alg_list_append(xsolves, &xsolve);
             }
         }
     }
 }
 int bidirectional_recursion_first_of_any(
-        cube18B_xcross4_s *cube, 
+        cube18B_xcross4_hashed_s *cube, 
         xcross4_table_s *our_ct, 
         const xcross4_table_s *other_ct, 
         alg_s *alg, 
@@ -356,25 +560,27 @@ int bidirectional_recursion_first_of_any(
     if (depth == 0) {
         bool done = false;
         for (uint8_t pair = 0; pair < 4; pair++) {
-            cube18B_xcross4_s x = *cube;
-            cube18B_xcross4_maskOnPair(&x, pair);
-            if (xcross4_table_lookup(other_ct, &x) != NULL && 
-                xcross4_table_lookup(our_ct, &x) == NULL) {
-                cube_list_append(cube_list, &x);
+            cube18B_xcross4_hashed_s x = cube18B_xcross4_hashed_maskOnPair(cube, pair);
+            if (xcross4_table_lookup_hashed(other_ct, &x, NULL) != NULL && 
+                xcross4_table_lookup_hashed(our_ct, &x, NULL) == NULL) {
+                cube_list_append(cube_list, &x.cube);
                 done = true;
             }
-            xcross4_table_insert(our_ct, &x, alg);
+            xcross4_table_insert_hashed(our_ct, &x, alg);
         }
-        xcross4_table_insert(our_ct, cube, alg);
+        xcross4_table_insert_hashed(our_ct, cube, alg);
         return done;
     }
 
-    if (xcross4_table_lookup(our_ct, cube) != NULL && xcross4_table_lookup(our_ct, cube)->list[0].length < alg->length) {
+    const packed_alg_t *found = xcross4_table_lookup_hashed(our_ct, cube, NULL);
+    if (found != NULL && packed_alg_length(found[0]) < alg->length) {
         return 0;
     }
 
     move_e prev_move = (alg->length >= 1) ? alg->moves[alg->length-1] : MOVE_NULL;
     move_e prev_prev_move = (alg->length >= 2) ? alg->moves[alg->length - 2] : MOVE_NULL;
+    // undoing a move is putting this back, rather than working out the key and hash again
+    const cube18B_xcross4_hashed_s parent = *cube;
 
     for (move_e move = 0; move < NUM_MOVES; move++) {
         if (move_faces[move] == move_faces[prev_move]) {
@@ -387,19 +593,21 @@ int bidirectional_recursion_first_of_any(
         }
 
         alg_insert(alg, move, alg->length);
-        cube18B_xcross4_apply_move(cube, move);
+        cube18B_xcross4_hashed_apply_move(cube, move);
 
         if (bidirectional_recursion_first_of_any(cube, our_ct, other_ct, alg, cube_list, depth - 1)) {
             return 1;
         }
         
         alg_delete(alg, alg->length-1);
-        cube18B_xcross4_apply_move(cube, move_inverted[move]); // undo move
+        *cube = parent; // undo move
     }
     return 0;
 }
 
-static void xcross_search_first_of_any(const cube18B_xcross4_s *start, alg_list_s* xsolves) {
+static void xcross_search_first_of_any(solver_ctx_s *ctx, const cube18B_xcross4_s *start, alg_list_s* xsolves) {
+    xcross4_table_s *xcross4_start_ct = ctx->xcross4_start_ct;
+    xcross4_table_s *xcross4_end_ct   = ctx->xcross4_end_ct;
     if (!xcross4_start_ct || !xcross4_end_ct) {
         printf("Didn't have the tables initialized :(\n");
         return;
@@ -408,8 +616,8 @@ static void xcross_search_first_of_any(const cube18B_xcross4_s *start, alg_list_
     alg_s *start_alg = alg_create(5);
     alg_s *end_alg   = alg_create(5);
 
-    cube18B_xcross4_s start_cube = *start;
-    cube18B_xcross4_s end_cube   = SOLVED_CUBE18B_XCROSS4;
+    cube18B_xcross4_hashed_s start_cube = cube18B_xcross4_hashed_from(start);
+    cube18B_xcross4_hashed_s end_cube   = cube18B_xcross4_hashed_from(&SOLVED_CUBE18B_XCROSS4);
     //printf("=============STARTING XCROSS===========\n");
     //printf("START_CUBE: \n");
     //print_cube_map_colors(start_cube);
@@ -420,52 +628,96 @@ static void xcross_search_first_of_any(const cube18B_xcross4_s *start, alg_list_
     for (uint8_t depth = 0; depth <= 5; depth++) {
         bidirectional_recursion_first_of_any(&start_cube, xcross4_start_ct, xcross4_end_ct, start_alg, cube_list, depth);
         if (cube_list->length > 0) break;
-        if (!compare_cube18B_xcross4(start, &start_cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
+        if (!compare_cube18B_xcross4(start, &start_cube.cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube.cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
 
         bidirectional_recursion_first_of_any(&end_cube, xcross4_end_ct, xcross4_start_ct, end_alg, cube_list, depth);
         if (cube_list->length > 0) break;
-        if (!compare_cube18B_xcross4(start, &start_cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
+        if (!compare_cube18B_xcross4(start, &start_cube.cube) || !compare_cube18B_xcross4(&SOLVED_CUBE18B_XCROSS4, &end_cube.cube)) printf("BIDIRECTIONAL RECURSION FAILED TO UNDO ITS MOVES\n");
     }
 
     for (size_t i = 0; i < cube_list->length; i++) {
         cube18B_xcross4_s cube = cube_list->cubes[i];
-        const alg_list_s* alg_list1 = xcross4_table_lookup(xcross4_start_ct, &cube);
-        const alg_list_s* alg_list2 = xcross4_table_lookup(xcross4_end_ct, &cube);
-        for (size_t alg1 = 0; alg1 < alg_list1->num_algs; alg1++) {
-            for (size_t alg2 = 0; alg2 < alg_list2->num_algs; alg2++) {
-                alg_s start_algo = alg_static_copy(&(alg_list1->list[alg1]));
-                alg_s end_algo = alg_static_copy(&(alg_list2->list[alg2]));
-                alg_invert(&end_algo);
-                alg_concat(&start_algo, &end_algo);
-                alg_list_append(xsolves, &start_algo);
+        size_t num_algs1, num_algs2;
+        const packed_alg_t* algs1 = xcross4_table_lookup(xcross4_start_ct, &cube, &num_algs1);
+        const packed_alg_t* algs2 = xcross4_table_lookup(xcross4_end_ct, &cube, &num_algs2);
+        for (size_t alg1 = 0; alg1 < num_algs1; alg1++) {
+            for (size_t alg2 = 0; alg2 < num_algs2; alg2++) {
+                // both halves are at most 5 moves, so they always fit together
+                move_e moves[PACKED_ALG_MAX_MOVES];
+                alg_s xsolve = packed_alg_unpack(packed_alg_concat(algs1[alg1], packed_alg_invert(algs2[alg2])), moves);
+                alg_list_append(xsolves, &xsolve);
             }
         }
     }
 }
 
-int bidirectional_recursion_first_of_each_separate(cube18B_xcross1_s *cube, xcross1_table_s *our_ct, xcross1_table_s *other_ct, alg_s *alg, uint8_t depth) {
-    //if (alg->length > 5) {
-    //    printf("ALG GOT BIGGER THAN 5 MOVES!!!! OH THE HORRORS!!!\n");
-    //}
-    if (depth == 0) {
-        if (!xcross1_table_lookup(our_ct, cube)) {
-            xcross1_table_insert(our_ct, cube, alg);
-        }
+// Solutions up to this many moves longer than the shortest xcross of a pair are
+// searched as well, a slightly longer xcross often leaves a much easier F2L
+#define XCROSS_EXTRA_MOVES 1
+// Every shortest xcross of a pair is kept, but there are about 25 times as many
+// a move longer and each one gets a whole F2L search, so only this many of those are
+#define MAX_NEAR_OPTIMAL_XCROSSES_PER_PAIR 8
+
+// the cubie a piece in cubie ends up at when the whole cube is turned, see rotate_cube
+static cubie_e cubie_rotated(cubie_e cubie, face_e cross_face, uint8_t y_turns) {
+    const face_e *rotation = rotate_cube[cross_face][y_turns];
+    const face_e *faces = cubieDefinitions[cubie];
+    face_e third = (faces[2] == FACE_NULL) ? FACE_NULL : rotation[faces[2]];
+    return cubieDefinition_to_cubie[rotation[faces[0]]][rotation[faces[1]]][third];
+}
 
-        return (xcross1_table_lookup(other_ct, cube) != NULL);
+// the cubie a piece in cubie ends up at when the whole cube is turned y_turns
+static cubie_e cubie_rotated_on_y(cubie_e cubie, uint8_t y_turns) {
+    return cubie_rotated(cubie, FACE_D, y_turns);
+}
+
+// turns the whole cube and renames every piece after its new home, so the cross
+// edges swap places in the state to stay in FD, RD, BD, LD order
+static cube18B_xcross1_s cube18B_xcross1_rotated_on_y(const cube18B_xcross1_s *cube, uint8_t y_turns) {
+    cube18B_xcross1_s rotated;
+    for (uint8_t i = 0; i < 4; i++) {
+        cubie_e home = cubie_rotated_on_y(SOLVED_CUBIES[i], y_turns);
+        for (uint8_t j = 0; j < 4; j++) {
+            if (SOLVED_CUBIES[j] == home) {
+                rotated.cubies[j] = cubie_rotated_on_y(cube->cubies[i], y_turns);
+            }
+        }
     }
+    rotated.cubies[4] = cubie_rotated_on_y(cube->cubies[4], y_turns);
+    rotated.cubies[5] = cubie_rotated_on_y(cube->cubies[5], y_turns);
+    return rotated;
+}
 
-    // depth > 0
-    if (xcross1_table_lookup(our_ct, cube) != NULL &&
-        xcross1_table_lookup(our_ct, cube)->list[0].length < alg->length) {
-        return 0;
+// the y turns that bring pair's slot to the front right, where the pruning table is
+static uint8_t pair_y_turns(uint8_t pair) {
+    cube18B_xcross1_s solved_pair0 = cube18B_xcross4_to_xcross1(&SOLVED_CUBE18B_XCROSS4, 0);
+    cube18B_xcross1_s solved_pair  = cube18B_xcross4_to_xcross1(&SOLVED_CUBE18B_XCROSS4, pair);
+    for (uint8_t y_turns = 0; y_turns < 4; y_turns++) {
+        cube18B_xcross1_s rotated = cube18B_xcross1_rotated_on_y(&solved_pair, y_turns);
+        if (compare_cube18B_xcross1(&rotated, &solved_pair0)) {
+            return y_turns;
+        }
+    }
+    return 0;
+}
 
+// IDA*: the pruning table gives the exact distance to solved, so the only moves
+// followed are the ones that can still finish in exactly depth moves
+static void xcross1_pruned_recursion(const coord_tables_s *tables, const xcross1_pruning_table_s *pt, arena_s *arena,
+                                     coord_xcross1_s cube, alg_s *alg, uint8_t depth, alg_list_s *solves,
+                                     size_t max_solves) {
+    if (xcross1_pruning_table_distance(pt, coord_xcross1_rank(tables, &cube)) > depth) {
+        return;
+    }
+    if (depth == 0) {
+        alg_list_arena_append(arena, solves, alg);
+        return;
     }
 
     move_e prev_move = (alg->length >= 1) ? alg->moves[alg->length-1] : MOVE_NULL;
     move_e prev_prev_move = (alg->length >= 2) ? alg->moves[alg->length - 2] : MOVE_NULL;
 
-    for (move_e move = 0; move < NUM_MOVES; move++) {
+    for (move_e move = 0; move < NUM_MOVES && solves->num_algs < max_solves; move++) {
         if (move_faces[move] == move_faces[prev_move]) {
             continue;
         }
@@ -474,84 +726,109 @@ int bidirectional_recursion_first_of_each_separate(cube18B_xcross1_s *cube, xcro
             (move_faces[move] == move_faces[prev_prev_move] || move_faces[move] > move_faces[prev_move])) {
             continue;
         }
-        //uint8_t len0 = alg->length;
 
+        coord_xcross1_s new_cube = cube;
+        coord_xcross1_apply_move(tables, &new_cube, move);
         alg_insert(alg, move, alg->length);
-        //uint8_t len1 = alg->length;
-        cube18B_xcross1_apply_move(cube, move);
-        if (bidirectional_recursion_first_of_each_separate(cube, our_ct, other_ct, alg, depth - 1)) {
-            // we did it!
-            return 1;
-        }
-
-        // keep going, move didn't pan out
+        xcross1_pruned_recursion(tables, pt, arena, new_cube, alg, depth - 1, solves, max_solves);
         alg_delete(alg, alg->length-1);
-        //uint8_t len2 = alg->length;
-        cube18B_xcross1_apply_move(cube, move_inverted[move]); // undo move
-        //if (len1 != len0+1) {
-        //    printf("THE PROBLEM IS THE INSERTION\n");
-        //}
-        //if (len2 != len1-1) {
-        //    printf("THE PROBLEM IS THE DELETION\n");
-        //}
     }
-    return 0;
 }
 
-static void xcross_search_first_of_each_separate(const cube18B_xcross4_s *start, alg_list_s* xsolves) {
-    if (!xcross1_start_ct || !xcross1_end_ct) {
-        printf("Didn't have the tables initialized :(\n");
-        return;
+// every shortest xcross of pair, then up to MAX_NEAR_OPTIMAL_XCROSSES_PER_PAIR within
+// XCROSS_EXTRA_MOVES of it
+static alg_list_s* xcross_search_pair(const coord_tables_s *tables, const xcross1_pruning_table_s *pt, arena_s *arena,
+                                      const cube18B_xcross4_s *start, uint8_t pair) {
+    uint8_t y_turns = pair_y_turns(pair);
+    cube18B_xcross1_s start_xcross1 = cube18B_xcross4_to_xcross1(start, pair);
+    cube18B_xcross1_s rotated = cube18B_xcross1_rotated_on_y(&start_xcross1, y_turns);
+    coord_xcross1_s start_cube = coord_xcross1_from_cube18B_xcross1(&rotated);
+
+    uint8_t distance = xcross1_pruning_table_distance(pt, coord_xcross1_rank(tables, &start_cube));
+    uint8_t max_length = distance + XCROSS_EXTRA_MOVES;
+    alg_list_s *solves = alg_list_arena_create(arena, MIN_LIST_RESIZE);
+    // the recursion never goes deeper than max_length, so alg is never grown out of the arena
+    alg_s *alg = alg_arena_create(arena, max_length);
+    xcross1_pruned_recursion(tables, pt, arena, start_cube, alg, distance, solves, SIZE_MAX);
+    size_t max_solves = solves->num_algs + MAX_NEAR_OPTIMAL_XCROSSES_PER_PAIR;
+    for (uint8_t depth = distance + 1; depth <= max_length; depth++) {
+        xcross1_pruned_recursion(tables, pt, arena, start_cube, alg, depth, solves, max_solves);
     }
 
-    for (uint8_t pair = 0; pair < 4; pair++) {
-        alg_s *start_alg = alg_create(5);
-        alg_s *end_alg   = alg_create(5);
-
-        cube18B_xcross1_s start_cube = cube18B_xcross4_to_xcross1(start, pair);
-        cube18B_xcross1_s end_cube   = cube18B_xcross4_to_xcross1(&SOLVED_CUBE18B_XCROSS4, pair);
-        //printf("=============STARTING XCROSS===========\n");
-        //printf("START_CUBE: \n");
-        //print_cube_map_colors(start_cube);
-        //printf("END_CUBE: \n");
-        //print_cube_map_colors(end_cube);
-        for (uint8_t depth = 0; depth <= 5; depth++) {
-            //printf("LENGTH OF START_ALG IS %zu\n", start_alg->length);
-            if (bidirectional_recursion_first_of_each_separate(&start_cube, xcross1_start_ct, xcross1_end_ct, start_alg, depth)) {
-                alg_free(end_alg);
-                end_alg = alg_copy(&xcross1_table_lookup(xcross1_end_ct, &start_cube)->list[0]);
-                break;
-            }
+    // the solutions were found on the turned cube, turn them back
+    for (size_t i = 0; i < solves->num_algs; i++) {
+        alg_rotate_on_y(&solves->list[i], -y_turns);
+    }
+    return solves;
+}
 
-            //printf("LENGTH OF END_ALG IS %zu\n", end_alg->length);
-            if (bidirectional_recursion_first_of_each_separate(&end_cube, xcross1_end_ct, xcross1_start_ct, end_alg, depth)) {
-                alg_free(start_alg);
-                start_alg = alg_copy(&xcross1_table_lookup(xcross1_start_ct, &end_cube)->list[0]);
-                break;
-            }
-        }
-        alg_invert(end_alg);
-        alg_concat(start_alg, end_alg);
+typedef struct {
+    const solver_ctx_s *ctx;
+    const cube18B_xcross4_s *start;
+    size_t worker;
+    alg_list_s *pair_solves[4];
+} xcross1_worker_s;
+
+// worker n searches pairs n, n + num_xcross1_workers, ...
+static void* xcross1_worker(void *arg) {
+    xcross1_worker_s *job = (xcross1_worker_s*)arg;
+    const solver_ctx_s *ctx = job->ctx;
+    for (uint8_t pair = job->worker; pair < 4; pair += ctx->num_xcross1_workers) {
+        job->pair_solves[pair] = xcross_search_pair(ctx->coord_tables, ctx->xcross1_pt, ctx->worker_arenas[job->worker],
+                                                    job->start, pair);
+    }
+    return NULL;
+}
 
-        //print_alg(start_alg);
+static void xcross_search_optimal_of_each(solver_ctx_s *ctx, const cube18B_xcross4_s *start, alg_list_s* xsolves) {
+    size_t num_xcross1_workers = ctx->num_xcross1_workers;
+
+    xcross1_worker_s jobs[MAX_XCROSS1_WORKERS];
+    pthread_t threads[MAX_XCROSS1_WORKERS];
+    for (size_t worker = 0; worker < num_xcross1_workers; worker++) {
+        jobs[worker] = (xcross1_worker_s) {
+            .ctx = ctx,
+            .start = start,
+            .worker = worker,
+            .pair_solves = { NULL },
+        };
+    }
 
-        alg_list_append(xsolves, start_alg);
+    // the calling thread takes worker 0 itself, so a single core never spawns a thread
+    size_t num_threads = 1;
+    for (; num_threads < num_xcross1_workers; num_threads++) {
+        if (pthread_create(&threads[num_threads], NULL, xcross1_worker, &jobs[num_threads])) {
+            break;
+        }
+    }
+    xcross1_worker(&jobs[0]);
+    for (size_t worker = 1; worker < num_threads; worker++) {
+        pthread_join(threads[worker], NULL);
+    }
+    // any worker that couldn't get a thread is run here instead
+    for (size_t worker = num_threads; worker < num_xcross1_workers; worker++) {
+        xcross1_worker(&jobs[worker]);
+    }
 
-        alg_free(end_alg);
-        alg_free(start_alg);
-        xcross1_table_clear(xcross1_start_ct);
-        xcross1_table_clear(xcross1_end_ct);
+    // merge in pair order so the result doesn't depend on thread timing
+    for (uint8_t pair = 0; pair < 4; pair++) {
+        alg_list_s *pair_solves = jobs[pair % num_xcross1_workers].pair_solves[pair];
+        for (size_t i = 0; i < pair_solves->num_algs; i++) {
+            alg_list_arena_append(ctx->arena, xsolves, &pair_solves->list[i]);
+        }
     }
 }
 
 
-static void last_layer_stage(const cube18B_1LLL_s *LL_portion, alg_s **best, const alg_s *xsolve,
-                             const alg_s *f2l_solve, const LL_table_s *ll_table) {
+static void last_layer_stage(solver_ctx_s *ctx, const cube18B_1LLL_s *LL_portion, alg_s **best, const alg_s *xsolve,
+                             const alg_s *f2l_solve) {
     //printf("Entered LL_stage()\n");
-    alg_s *solve = alg_copy(xsolve);
+    alg_s *solve = ctx->candidate;
+    solve->length = 0;
+    alg_concat(solve, xsolve);
     alg_concat(solve, f2l_solve);
 
-    const alg_s *last_layer_alg = LL_table_lookup(ll_table, LL_portion);
+    const alg_s *last_layer_alg = LL_table_lookup(ctx->ll_table, LL_portion);
     if (last_layer_alg != NULL) {
         alg_concat(solve, last_layer_alg);
     }
@@ -561,30 +838,54 @@ static void last_layer_stage(const cube18B_1LLL_s *LL_portion, alg_s **best, con
     if (*best && (*best)->length <= solve->length) {
         //printf("best_solve was: \n");
         //print_alg(*best);
-        alg_free(solve);
         return;
     }
     //printf("\t\t\t\tFOUND NEW BEST SOLVE: ");
     //print_alg(solve);
 
-    alg_free(*best);
+    // the old best gets overwritten by the next candidate
+    ctx->candidate = (*best) ? *best : ctx->solve_buffers[1];
     *best = solve;
 }
 
-static void f2l_stage(cube18B_F2L_s F2L_portion, cube18B_1LLL_s LL_portion, alg_s **best, const alg_s *xsolve,
-                      alg_s *f2l_solve, const F2L_table_s *f2l_table,
-                      const LL_table_s *ll_table, uint8_t depth) {
+// This pruning is a heuristic, not a bound, so it's only done when the context has it
+// turned on. A branch is dropped once its simplified
+// prefix, the xcross and pair algs so far, is as long as the best solve. The pair
+// and last layer algs still to come can cancel moves off the end of the prefix, and
+// nothing limits how far back that goes, so no length taken from the prefix alone is
+// a true lower bound and the best solve can get pruned. On 100 random scrambles it
+// gave the same solves as searching every branch
+static bool f2l_prune(const solver_ctx_s *ctx, const alg_s *prefix, const alg_s *best) {
+    return ctx->f2l_pruning && best && prefix->length >= best->length;
+}
+
+// prefix is xsolve followed by f2l_solve, simplified. It is only used to prune
+// the search, the solves themselves are still built from the unsimplified parts
+static void f2l_stage(solver_ctx_s *ctx, cube18B_F2L_s F2L_portion, cube18B_1LLL_s LL_portion, alg_s **best,
+                      const alg_s *xsolve, alg_s *f2l_solve, const alg_s *prefix, uint8_t depth) {
     //if (depth == 2) {
     //    printf("made it to depth 2\n");
     //} 
 
+    // other pair orders often reach the same state, with the transposition table
+    // on it's only expanded again if this time it was reached in fewer moves. That's
+    // a heuristic: a longer prefix can still end up shorter once the algs after it
+    // cancel into it, so the best solve can get skipped. On 100 random scrambles it
+    // made 2 solves a move longer
+    if (ctx->f2l_tt && transposition_table_visit(ctx->f2l_tt, &F2L_portion, &LL_portion, prefix->length, depth)) {
+        return;
+    }
+
     // we solved F2L! Proceed to the last layer
     if (compare_cube18B_F2L(&F2L_portion, &SOLVED_CUBE18B_F2L)) {
-        last_layer_stage(&LL_portion, best, xsolve, f2l_solve, ll_table);
+        last_layer_stage(ctx, &LL_portion, best, xsolve, f2l_solve);
         return;
     }
     //if (depth == 0) printf("5TH PAIR?!\n");
 
+    // rebuilt for every pair alg below, the deeper stages never hold on to it
+    alg_s *new_prefix = alg_arena_create(ctx->arena, prefix->length + 16);
+
     for (uint8_t pair = 0; pair < 4; pair++) {
         cube18B_F2L_s solved_mask = SOLVED_CUBE18B_F2L;
         cube18B_F2L_s pair_mask = F2L_portion;
@@ -593,7 +894,9 @@ static void f2l_stage(cube18B_F2L_s F2L_portion, cube18B_1LLL_s LL_portion, alg_
 
         if (compare_cube18B_F2L(&solved_mask, &pair_mask)) continue;
 
-        const alg_list_s *pair_algs = F2L_table_lookup(f2l_table, &pair_mask);
+        size_t num_pair_algs;
+        const cubieTable_s *pair_cubieTables;
+        const packed_alg_t *pair_algs = F2L_table_lookup(ctx->f2l_table, &pair_mask, &num_pair_algs, &pair_cubieTables);
         if (!pair_algs) {
             cube18B_s cube = {
                 .cubies = {
@@ -629,36 +932,46 @@ static void f2l_stage(cube18B_F2L_s F2L_portion, cube18B_1LLL_s LL_portion, alg_
             return;
         }
 
-        for (size_t alg = 0; alg < pair_algs->num_algs; alg++) {
+        for (size_t alg = 0; alg < num_pair_algs; alg++) {
             //if (compare_algs(xsolve, "B2 R B' L' F L F") && compare_algs(f2l_solve, "L2 B L U' B' L B2 D B' U B D' B2")) {
             //    print_cube_map_colors(cube);
-            //    print_alg(&(pair_algs->list[alg]));
+            //    print_alg(&algo);
             //
-            alg_s algo = pair_algs->list[alg];
+            move_e algo_moves[PACKED_ALG_MAX_MOVES];
+            alg_s algo = packed_alg_unpack(pair_algs[alg], algo_moves);
+            const cubieTable_s *algo_table = &pair_cubieTables[alg];
             cube18B_F2L_s new_F2L_portion = F2L_portion;
             //printf("Applying F2L alg on depth %hhu:\n", depth);
             //print_alg(&algo);
             if (F2L_portion.cubies[0] != SOLVED_CUBE18B_F2L.cubies[0] || F2L_portion.cubies[1] != SOLVED_CUBE18B_F2L.cubies[1]) {
-                new_F2L_portion.cubies[0] = apply_alg_to_cubie(new_F2L_portion.cubies[0], &algo);
-                new_F2L_portion.cubies[1] = apply_alg_to_cubie(new_F2L_portion.cubies[1], &algo);
+                new_F2L_portion.cubies[0] = algo_table->cubieShift[new_F2L_portion.cubies[0]];
+                new_F2L_portion.cubies[1] = algo_table->cubieShift[new_F2L_portion.cubies[1]];
             } if (F2L_portion.cubies[2] != SOLVED_CUBE18B_F2L.cubies[2] || F2L_portion.cubies[3] != SOLVED_CUBE18B_F2L.cubies[3]) {
-                new_F2L_portion.cubies[2] = apply_alg_to_cubie(new_F2L_portion.cubies[2], &algo);
-                new_F2L_portion.cubies[3] = apply_alg_to_cubie(new_F2L_portion.cubies[3], &algo);
+                new_F2L_portion.cubies[2] = algo_table->cubieShift[new_F2L_portion.cubies[2]];
+                new_F2L_portion.cubies[3] = algo_table->cubieShift[new_F2L_portion.cubies[3]];
             } if (F2L_portion.cubies[4] != SOLVED_CUBE18B_F2L.cubies[4] || F2L_portion.cubies[5] != SOLVED_CUBE18B_F2L.cubies[5]) {
-                new_F2L_portion.cubies[4] = apply_alg_to_cubie(new_F2L_portion.cubies[4], &algo);
-                new_F2L_portion.cubies[5] = apply_alg_to_cubie(new_F2L_portion.cubies[5], &algo);
+                new_F2L_portion.cubies[4] = algo_table->cubieShift[new_F2L_portion.cubies[4]];
+                new_F2L_portion.cubies[5] = algo_table->cubieShift[new_F2L_portion.cubies[5]];
             } if (F2L_portion.cubies[6] != SOLVED_CUBE18B_F2L.cubies[6] || F2L_portion.cubies[7] != SOLVED_CUBE18B_F2L.cubies[7]) {
-                new_F2L_portion.cubies[6] = apply_alg_to_cubie(new_F2L_portion.cubies[6], &algo);
-                new_F2L_portion.cubies[7] = apply_alg_to_cubie(new_F2L_portion.cubies[7], &algo);
+                new_F2L_portion.cubies[6] = algo_table->cubieShift[new_F2L_portion.cubies[6]];
+                new_F2L_portion.cubies[7] = algo_table->cubieShift[new_F2L_portion.cubies[7]];
             }
             //for (uint8_t i = 4; i > depth; i--) {
             //    printf("\t");
             //} print_cube18B_F2L(&new_F2L_portion);
+            new_prefix->length = 0;
+            alg_arena_concat(ctx->arena, new_prefix, prefix);
+            alg_arena_concat(ctx->arena, new_prefix, &algo);
+            alg_arena_simplify(new_prefix);
+            if (f2l_prune(ctx, new_prefix, *best)) {
+                continue;
+            }
+
             cube18B_1LLL_s new_LL_portion = LL_portion;
-            cube18B_1LLL_apply_alg(&new_LL_portion, &algo);
+            cube18B_1LLL_apply_cubieTable(&new_LL_portion, algo_table);
             size_t old_len = f2l_solve->length;
-            alg_concat(f2l_solve, &algo);
-            f2l_stage(new_F2L_portion, new_LL_portion, best, xsolve, f2l_solve, f2l_table, ll_table, depth-1);
+            alg_arena_concat(ctx->arena, f2l_solve, &algo);
+            f2l_stage(ctx, new_F2L_portion, new_LL_portion, best, xsolve, f2l_solve, new_prefix, depth-1);
             f2l_solve->length -= f2l_solve->length - old_len;
         }
     }
@@ -680,14 +993,17 @@ static bool test_xcross_alg(const cube18B_xcross4_s* xpuzzle, const alg_s* xsolv
         )
     );
 }
-static void xcross_stage(cube18B_s cube, alg_s **best,
-                         const F2L_table_s *f2l_table, const LL_table_s *ll_table) {
-    
-    alg_list_s* xsolves = alg_list_create(20);
+static void xcross_stage(solver_ctx_s *ctx, cube18B_s cube, alg_s **best) {
+
+    alg_list_s* xsolves = alg_list_arena_create(ctx->arena, 20);
     cube18B_xcross4_s xcross_puzzle = cube18B_xcross4_from_cube18B(&cube);
 
     //printf("Starting xcross search...\n");
-    xcross_search_first_of_each_separate(&xcross_puzzle, xsolves);
+    if (ctx->xcross_search == XCROSS_SEARCH_BEST_OF_EACH) {
+        xcross_search_best_of_each(ctx, &xcross_puzzle, xsolves);
+    } else {
+        xcross_search_optimal_of_each(ctx, &xcross_puzzle, xsolves);
+    }
     //printf("Finished xcross search: %zu solutions found\n", xsolves->num_algs);
     bool allXsolvesWorked = true;
     for (size_t alg = 0; alg < xsolves->num_algs; alg++) {
@@ -706,27 +1022,39 @@ static void xcross_stage(cube18B_s cube, alg_s **best,
         cube18B_s new_cube = cube;
         cube18B_apply_alg(&new_cube, xcross_alg);
         
-        alg_s *f2l_solve = alg_create(10);
+        alg_s *f2l_solve = alg_arena_create(ctx->arena, 10);
         cube18B_F2L_s F2L_portion = cube18B_F2L_from_cube18B(&new_cube);
         //print_cube18B_F2L(&F2L_portion);
         cube18B_1LLL_s LL_portion = cube18B_1LLL_from_cube18B(&new_cube);
-        f2l_stage(F2L_portion, LL_portion, best, xcross_alg, f2l_solve, f2l_table, ll_table, 3);
+        alg_s *prefix = alg_arena_copy(ctx->arena, xcross_alg);
+        alg_arena_simplify(prefix);
+        if (!f2l_prune(ctx, prefix, *best)) {
+            f2l_stage(ctx, F2L_portion, LL_portion, best, xcross_alg, f2l_solve, prefix, 3);
+        }
         //printf("------------------------------------------------\n");
-        alg_free(f2l_solve);
     }
-    alg_list_free(xsolves);
 }
 
-alg_s* solve_cube(cube18B_s cube, const F2L_table_s *f2l_table, const LL_table_s *ll_table) {
-    if (!f2l_table || !ll_table) {
+alg_s* solve_cube(solver_ctx_s *ctx, cube18B_s cube) {
+    if (!ctx->f2l_table || !ctx->ll_table) {
         printf("No F2L or last layer table was provided!");
     }
     //printf("F2L entries: %zu\n", F2L_table_entries(f2l_table));
     //printf("LL entries: %zu\n", LL_table_entries(ll_table));
 
     alg_s* best_solve = NULL;
+    bool solving_alone = __atomic_fetch_add(&solves_running, 1, __ATOMIC_RELAXED) == 0;
+    if (ctx->track_peak_rss && solving_alone) {
+        peak_rss_reset();
+    }
+    transposition_table_clear(ctx->f2l_tt);
+    arena_reset(ctx->arena);
+    for (size_t worker = 0; worker < ctx->num_xcross1_workers; worker++) {
+        arena_reset(ctx->worker_arenas[worker]);
+    }
+    ctx->candidate = ctx->solve_buffers[0];
     //printf("Entering xcross_stage...\n");
-    xcross_stage(cube, &best_solve, f2l_table, ll_table);
+    xcross_stage(ctx, cube, &best_solve);
     //printf("Exited xcross_stage...\n");
     //if (best_solve == NULL) {
     //    printf("best_solve was NULL!!!\n");
@@ -734,12 +1062,200 @@ alg_s* solve_cube(cube18B_s cube, const F2L_table_s *f2l_table, const LL_table_s
     //    printf("best_solve was: \n");
     //    print_alg(best_solve);
     //}
-    //printf("clearing xcross_start_ct...\n");
-    //xcross4_table_clear(xcross4_start_ct);
-    //printf("clearing xcross_end_ct...\n");
-    //xcross4_table_clear(xcross4_end_ct);
+    // clearing only starts a new generation, so it's free whether or not the
+    // xcross4 strategies were used
+    xcross4_table_clear(ctx->xcross4_start_ct);
+    xcross4_table_clear(ctx->xcross4_end_ct);
+
+    if (ctx->track_peak_rss) {
+        ctx->peak_rss = peak_rss_read();
+        ctx->total_peak_rss += ctx->peak_rss;
+        if (ctx->peak_rss > ctx->max_peak_rss) ctx->max_peak_rss = ctx->peak_rss;
+        ctx->num_solves++;
+    }
+    __atomic_fetch_sub(&solves_running, 1, __ATOMIC_RELAXED);
+
+    // the best solve lives in the context, the caller gets its own copy
+    return alg_copy(best_solve);
+}
+
+// how close each face is to U/D for edge flips and corner twists: U/D first, then F/B
+static const uint8_t face_orientation_rank[NUM_FACES] = { 0, 2, 1, 2, 1, 0 };
+
+// cubies come in runs of the same piece in the same place, one for each way round
+// it can sit, so two per edge and three per corner
+static uint8_t cubie_run_length(cubie_e cubie) {
+    return (cubie < CUBIE_FUR) ? 2 : 3;
+}
+static cubie_e cubie_run_start(cubie_e cubie) {
+    return (cubie < CUBIE_FUR) ? (cubie & ~1) : CUBIE_FUR + (cubie - CUBIE_FUR) / 3 * 3;
+}
+
+// how far the piece whose home is home has been flipped or twisted to get to cubie,
+// counted from where its U/D (or else F/B) color sits to the U/D (or else F/B) face
+static uint8_t cubie_orientation(cubie_e home, cubie_e cubie) {
+    const face_e *colors = cubieDefinitions[home];
+    const face_e *faces  = cubieDefinitions[cubie];
+    uint8_t length = cubie_run_length(home);
+    uint8_t color = 0, face = 0;
+    for (uint8_t i = 1; i < length; i++) {
+        if (face_orientation_rank[colors[i]] < face_orientation_rank[colors[color]]) color = i;
+        if (face_orientation_rank[faces[i]]  < face_orientation_rank[faces[face]])   face = i;
+    }
+    return (face + length - color) % length;
+}
+
+// cube18B leaves out the LU edge and the UFL corner. They're in whichever places
+// are left over, and since the flips of all the edges add up to an even number and
+// the twists of all the corners to a multiple of three, which way round they are too
+static void cube18B_fill_untracked(const cube18B_s *cube, cubie_e cubies[20]) {
+    bool taken[NUM_CUBIES] = { false };
+    uint8_t flips = 0, twists = 0;
+    for (uint8_t i = 0; i < 18; i++) {
+        cubies[i] = cube->cubies[i];
+        taken[cubie_run_start(cubies[i])] = true;
+        if (cubie_run_length(cubies[i]) == 2) {
+            flips += cubie_orientation(SOLVED_CUBIES[i], cubies[i]);
+        } else {
+            twists += cubie_orientation(SOLVED_CUBIES[i], cubies[i]);
+        }
+    }
+
+    for (cubie_e start = 0; start < NUM_CUBIES; start += cubie_run_length(start)) {
+        if (taken[start]) {
+            continue;
+        }
+        uint8_t slot = (start < CUBIE_FUR) ? 18 : 19;
+        uint8_t total = (start < CUBIE_FUR) ? flips : twists;
+        for (uint8_t turn = 0; turn < cubie_run_length(start); turn++) {
+            cubies[slot] = start + turn;
+            if ((total + cubie_orientation(SOLVED_CUBIES[slot], start + turn)) % cubie_run_length(start) == 0) {
+                break;
+            }
+        }
+    }
+}
+
+// turns the whole cube and renames every piece after the center its colors now
+// match, so the cross face's pieces end up in the D cross and F2L places
+static cube18B_s cube18B_rotated(const cube18B_s *cube, face_e cross_face, uint8_t y_turns) {
+    cubie_e cubies[20];
+    cube18B_fill_untracked(cube, cubies);
+
+    cube18B_s rotated;
+    for (uint8_t i = 0; i < 20; i++) {
+        cubie_e home = cubie_rotated(SOLVED_CUBIES[i], cross_face, y_turns);
+        cubie_e cubie = cubie_rotated(cubies[i], cross_face, y_turns);
+        for (uint8_t j = 0; j < 18; j++) {
+            if (cubie_run_start(SOLVED_CUBIES[j]) != cubie_run_start(home)) {
+                continue;
+            }
+            // the new home may list the piece's colors in another order, the
+            // faces they sit on have to be listed in the same one
+            const face_e *colors = cubieDefinitions[SOLVED_CUBIES[j]];
+            face_e faces[3] = { FACE_NULL, FACE_NULL, FACE_NULL };
+            for (uint8_t a = 0; a < cubie_run_length(home); a++) {
+                for (uint8_t b = 0; b < cubie_run_length(home); b++) {
+                    if (cubieDefinitions[home][b] == colors[a]) faces[a] = cubieDefinitions[cubie][b];
+                }
+            }
+            rotated.cubies[j] = cubieDefinition_to_cubie[faces[0]][faces[1]][faces[2]];
+        }
+    }
+    return rotated;
+}
 
-    return best_solve;
+typedef struct {
+    solver_ctx_s *ctx;
+    const cube18B_s *cube;
+    size_t worker;
+    size_t num_workers;
+    size_t num_orientations;
+    alg_s **solves;
+} color_neutral_worker_s;
+
+// the cross faces a color neutral solve tries, D first so a tie keeps the solve
+// solve_cube would have given
+static const face_e color_neutral_cross_faces[NUM_FACES] = {
+    FACE_D, FACE_U, FACE_F, FACE_B, FACE_R, FACE_L
+};
+
+// worker n solves orientations n, n + num_workers, ... on its own context
+static void* color_neutral_worker(void *arg) {
+    color_neutral_worker_s *job = (color_neutral_worker_s*)arg;
+    size_t orientations_per_face = job->num_orientations / NUM_FACES;
+    for (size_t orientation = job->worker; orientation < job->num_orientations; orientation += job->num_workers) {
+        face_e cross_face = color_neutral_cross_faces[orientation / orientations_per_face];
+        uint8_t y_turns = orientation % orientations_per_face;
+        alg_s *solve = solve_cube(job->ctx, cube18B_rotated(job->cube, cross_face, y_turns));
+        // the solve was found on the turned cube, turn it back
+        alg_rotate_back(solve, cross_face, y_turns);
+        job->solves[orientation] = solve;
+    }
+    return NULL;
+}
+
+alg_s* solve_cube_color_neutral(solver_ctx_s **ctxs, size_t num_ctxs, cube18B_s cube, bool every_orientation) {
+    size_t num_orientations = every_orientation ? 4 * NUM_FACES : NUM_FACES;
+    size_t num_workers = (num_ctxs > num_orientations) ? num_orientations : num_ctxs;
+    if (num_workers == 0) {
+        printf("A color neutral solve needs at least one context!\n");
+        return NULL;
+    }
+
+    // every context's xcross1 search starts threads of its own, so between them
+    // they're cut down to about one per core until the solve is done
+    long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t nested_workers = (num_cores > (long)num_workers) ? num_cores / num_workers : 1;
+    size_t ctx_workers[4 * NUM_FACES];
+
+    alg_s *solves[4 * NUM_FACES] = { NULL };
+    color_neutral_worker_s jobs[4 * NUM_FACES];
+    pthread_t threads[4 * NUM_FACES];
+    for (size_t worker = 0; worker < num_workers; worker++) {
+        ctx_workers[worker] = ctxs[worker]->num_xcross1_workers;
+        if (ctx_workers[worker] > nested_workers) {
+            ctxs[worker]->num_xcross1_workers = nested_workers;
+        }
+        jobs[worker] = (color_neutral_worker_s) {
+            .ctx = ctxs[worker],
+            .cube = &cube,
+            .worker = worker,
+            .num_workers = num_workers,
+            .num_orientations = num_orientations,
+            .solves = solves,
+        };
+    }
+
+    // the same as the xcross1 workers, the calling thread takes worker 0
+    size_t num_threads = 1;
+    for (; num_threads < num_workers; num_threads++) {
+        if (pthread_create(&threads[num_threads], NULL, color_neutral_worker, &jobs[num_threads])) {
+            break;
+        }
+    }
+    color_neutral_worker(&jobs[0]);
+    for (size_t worker = 1; worker < num_threads; worker++) {
+        pthread_join(threads[worker], NULL);
+    }
+    for (size_t worker = num_threads; worker < num_workers; worker++) {
+        color_neutral_worker(&jobs[worker]);
+    }
+    for (size_t worker = 0; worker < num_workers; worker++) {
+        ctxs[worker]->num_xcross1_workers = ctx_workers[worker];
+    }
+
+    // the first of the shortest in orientation order, whatever order they finished in
+    alg_s *best = NULL;
+    for (size_t orientation = 0; orientation < num_orientations; orientation++) {
+        if (solves[orientation] && (!best || solves[orientation]->length < best->length)) {
+            alg_free(best);
+            best = solves[orientation];
+        } else {
+            alg_free(solves[orientation]);
+        }
+    }
+    return best;
 }
 
 uint8_t f2l_pair_orders[24][4] = {
@@ -779,9 +1295,8 @@ LL_table_s* generate_last_layer_table(char *filename) {
     size_t len;
     ssize_t read;
 
-    // generate a cube table twice the size of the number of 1lll states,
-    // the number below was chosen arbitrarily 
-    LL_table_s *last_layer_table = LL_table_create(131009);
+    // sized for the 62208 1lll states, it grows if the file has more
+    LL_table_s *last_layer_table = LL_table_create(62208);
 
     cube18B_1LLL_s cube;
     alg_s *algorithm = NULL;
@@ -821,9 +1336,8 @@ F2L_table_s* generate_f2l_table(char *filename) {
     size_t len;
     ssize_t read;
 
-    // generate a cube table twice the size of the number of 1lll states,
-    // the number below was chosen arbitrarily 
-    F2L_table_s *f2l_table = F2L_table_create(2909);
+    // sized for the 1532 F2L cases in the file, it grows if there are more
+    F2L_table_s *f2l_table = F2L_table_create(1532);
 
     cube18B_F2L_s cube;
     alg_s *algorithm = NULL;
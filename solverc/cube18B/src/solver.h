@@ -5,17 +5,52 @@
 #include "alg.h"
 #include "cube_table.h"
 #include "xcross4_table.h"
-#include "xcross1_table.h"
+#include "xcross1_pruning_table.h"
 #include "F2L_table.h"
 #include "LL_table.h"
+#include "transposition_table.h"
 #include "move.h"
 
-bool init_solver4();
-void cleanup_solver4();
-bool init_solver1();
-void cleanup_solver1();
+// scratch tables for one solve at a time, see solver.c
+typedef struct solver_ctx solver_ctx_s;
 
-alg_s* solve_cube(cube18B_s cube, const F2L_table_s *f2l_table, const LL_table_s *ll_table);
+// how the xcross stage finds the xcrosses it tries F2L on
+typedef enum : uint8_t {
+    // IDA* over the xcross1 pruning table, a pair at a time
+    XCROSS_SEARCH_OPTIMAL_OF_EACH = 0,
+    // bidirectional search over the xcross4 tables, see solver_ctx_init_xcross4
+    XCROSS_SEARCH_BEST_OF_EACH    = 1,
+} xcross_search_e;
+
+// num_workers is the number of threads the xcross search may use, 0 for one per core.
+// The tables are only read, so any number of contexts can share them
+solver_ctx_s* solver_ctx_create(const F2L_table_s *f2l_table, const LL_table_s *ll_table,
+                                const coord_tables_s *coord_tables, const xcross1_pruning_table_s *xcross1_pt,
+                                size_t num_workers);
+bool solver_ctx_init_xcross4(solver_ctx_s *ctx);
+bool solver_ctx_set_xcross_search(solver_ctx_s *ctx, xcross_search_e search);
+// Skips F2L stage states a solve already reached in as few moves. It's a
+// heuristic that can skip the best solve, so it's off by default
+bool solver_ctx_set_f2l_transpositions(solver_ctx_s *ctx, bool enabled);
+// Drops F2L branches whose moves so far are already as long as the best solve.
+// The algs after them can cancel into those moves, so it can drop the best solve
+// too and is off by default
+void solver_ctx_set_f2l_pruning(solver_ctx_s *ctx, bool enabled);
+void solver_ctx_print_stats(const solver_ctx_s *ctx);
+// Off by default, since it costs a few syscalls per solve. The peak is the
+// whole process's, and is only started again for a solve that has the process
+// to itself, so with solves running on other contexts it's the peak since the
+// last solve that ran alone
+void solver_ctx_track_peak_rss(solver_ctx_s *ctx, bool track);
+size_t solver_ctx_peak_rss(const solver_ctx_s *ctx);
+void solver_ctx_free(solver_ctx_s *ctx);
+
+alg_s* solve_cube(solver_ctx_s *ctx, cube18B_s cube);
+// solves with the cross on each of the six faces, or in all 24 orientations, and
+// keeps the shortest. The orientations are shared out over the num_ctxs contexts,
+// a thread each, which can all share the same tables. Each context's xcross
+// search gets fewer threads meanwhile, so there's still about one per core
+alg_s* solve_cube_color_neutral(solver_ctx_s **ctxs, size_t num_ctxs, cube18B_s cube, bool every_orientation);
 
 LL_table_s* generate_last_layer_table(char *filename);
 F2L_table_s* generate_f2l_table(char *filename);
@@ -0,0 +1,159 @@
+#include "cube18B.h"
+#include "transposition_table.h"
+#include "shift_cube.h"
+
+// The F2L stage never breaks the cross, so the seven edges it follows are
+// always somewhere in the eight edge places off the cross, which is 4 bits
+// with the flip, and the seven corners are 5 bits like in the other keys.
+// That's 63 bits for the F2L and last layer states together
+#define TRANSPOSITION_EDGE_BITS   4
+#define TRANSPOSITION_CORNER_BITS 5
+#define TRANSPOSITION_NO_CODE     0xff
+
+static const uint8_t off_cross_edge_codes[24] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,               // UR to BR
+    TRANSPOSITION_NO_CODE, TRANSPOSITION_NO_CODE,       // RD
+    12, 13,                                             // FL
+    TRANSPOSITION_NO_CODE, TRANSPOSITION_NO_CODE,       // FD
+    14, 15,                                             // LB
+    TRANSPOSITION_NO_CODE, TRANSPOSITION_NO_CODE,       // LD
+    TRANSPOSITION_NO_CODE, TRANSPOSITION_NO_CODE,       // BD
+};
+
+typedef uint64_t transposition_key_t;
+
+static bool transposition_key_add(transposition_key_t *key, size_t *shift, cubie_e cubie, bool corner) {
+    uint8_t code;
+    if (corner) {
+        code = (cubie >= 24 && cubie < NUM_CUBIES) ? cubie - 24 : TRANSPOSITION_NO_CODE;
+    } else {
+        code = (cubie < 24) ? off_cross_edge_codes[cubie] : TRANSPOSITION_NO_CODE;
+    }
+    if (code == TRANSPOSITION_NO_CODE) {
+        return false;
+    }
+
+    *key |= (transposition_key_t)code << *shift;
+    *shift += corner ? TRANSPOSITION_CORNER_BITS : TRANSPOSITION_EDGE_BITS;
+    return true;
+}
+
+// false for a state with a piece on the cross, which has no key
+static bool transposition_key_pack(const cube18B_F2L_s *F2L_portion, const cube18B_1LLL_s *LL_portion,
+                                   transposition_key_t *key) {
+    *key = 0;
+    size_t shift = 0;
+    for (int i = 0; i < 8; i++) {
+        if (!transposition_key_add(key, &shift, F2L_portion->cubies[i], i & 1)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 6; i++) {
+        if (!transposition_key_add(key, &shift, LL_portion->cubies[i], i >= 3)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef struct {
+    uint8_t moves;  // length of the shortest prefix the state was expanded with
+    uint8_t depth;  // pair algs that expansion had left
+} transposition_entry_s;
+
+HASH_TABLE_DEFINE(transposition_map, transposition_key_t, transposition_entry_s, compare_cube18B_keys)
+
+typedef struct transposition_table {
+    transposition_map_s map;
+
+    // kept across clears so hit rates can be reported over many solves
+    size_t lookups;
+    size_t hits;
+} transposition_table_s;
+
+transposition_table_s* transposition_table_create(size_t num_entries) {
+    transposition_table_s *tt = (transposition_table_s*)malloc(sizeof(transposition_table_s));
+    if (!tt) {
+        return NULL;
+    }
+
+    if (!transposition_map_init(&tt->map, num_entries)) {
+        free(tt);
+        return NULL;
+    }
+
+    tt->lookups = 0;
+    tt->hits    = 0;
+    return tt;
+}
+
+// returns true if the state was already expanded with a prefix no longer than
+// moves and at least as many pair algs left, in which case it's skipped.
+// moves is a simplified length, which the final solve's length isn't monotone
+// in, so a skipped state can still hold a shorter solve. Otherwise the state is
+// recorded as expanded with moves
+bool transposition_table_visit(transposition_table_s *tt, const cube18B_F2L_s *F2L_portion,
+                               const cube18B_1LLL_s *LL_portion, uint8_t moves, uint8_t depth) {
+    if (tt == NULL) {
+        return false;
+    }
+    tt->lookups++;
+
+    transposition_key_t key;
+    if (!transposition_key_pack(F2L_portion, LL_portion, &key)) {
+        return false;
+    }
+
+    bool inserted;
+    transposition_map_slot_s *slot = transposition_map_insert(&tt->map, &key, &inserted);
+    if (slot == NULL) {
+        // a table that couldn't grow only means less gets skipped
+        return false;
+    }
+
+    transposition_entry_s *entry = &slot->value;
+    if (!inserted && entry->moves <= moves && entry->depth >= depth) {
+        tt->hits++;
+        return true;
+    }
+    entry->moves = moves;
+    entry->depth = depth;
+    return false;
+}
+
+void transposition_table_clear(transposition_table_s *tt) {
+    if (tt == NULL || tt->map.slots == NULL) {
+        return;
+    }
+
+    transposition_map_clear(&tt->map);
+}
+
+void transposition_table_free(transposition_table_s *tt) {
+    if (tt == NULL) {
+        return;
+    }
+
+    transposition_map_destroy(&tt->map);
+    free(tt);
+}
+
+size_t transposition_table_entries(const transposition_table_s *tt) {
+    return tt->map.entries;
+}
+
+size_t transposition_table_size(const transposition_table_s *tt) {
+    return tt->map.capacity;
+}
+
+size_t transposition_table_lookups(const transposition_table_s *tt) {
+    return tt->lookups;
+}
+
+size_t transposition_table_hits(const transposition_table_s *tt) {
+    return tt->hits;
+}
+
+hash_table_stats_s transposition_table_stats(const transposition_table_s *tt) {
+    return transposition_map_stats(&tt->map);
+}
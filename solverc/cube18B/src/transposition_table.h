@@ -0,0 +1,28 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "main.h"
+#include "cube18B.h"
+#include "hash_table.h"
+
+// remembers which F2L stage states a solve has already expanded, so the same
+// state reached through a different pair order can be skipped. The skipping is a
+// heuristic, see transposition_table_visit
+typedef struct transposition_table transposition_table_s;
+
+transposition_table_s* transposition_table_create(size_t num_entries);
+bool transposition_table_visit(transposition_table_s *tt, const cube18B_F2L_s *F2L_portion,
+                               const cube18B_1LLL_s *LL_portion, uint8_t moves, uint8_t depth);
+void transposition_table_free(transposition_table_s *tt);
+void transposition_table_clear(transposition_table_s *tt);
+
+size_t transposition_table_entries(const transposition_table_s *tt);
+size_t transposition_table_size(const transposition_table_s *tt);
+size_t transposition_table_lookups(const transposition_table_s *tt);
+size_t transposition_table_hits(const transposition_table_s *tt);
+hash_table_stats_s transposition_table_stats(const transposition_table_s *tt);
+
+#endif // TRANSPOSITION_TABLE_H
@@ -0,0 +1,204 @@
+#include "xcross1_pruning_table.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PRUNING_TABLE_VERSION 1
+#define PRUNING_TABLE_SIZE    ((NUM_XCROSS1_RANKS + 1)/2)
+
+static const char PRUNING_TABLE_MAGIC[8] = {'X', 'C', '1', 'P', 'R', 'U', 'N', 'E'};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_ranks;
+} pruning_table_header_s;
+
+// all 384 pair edge and corner states of one cross coordinate are next to each
+// other, so the search works a cross coordinate at a time
+#define STATES_PER_CROSS (16*NUM_CORNER_COORDS)
+
+static inline uint8_t get_distance(const uint8_t *distances, uint32_t rank) {
+    return (distances[rank >> 1] >> ((rank & 1) << 2)) & 0xf;
+}
+
+static inline void set_distance(uint8_t *distances, uint32_t rank, uint8_t distance) {
+    uint8_t shift = (rank & 1) << 2;
+    distances[rank >> 1] = (distances[rank >> 1] & ~(0xf << shift)) | (distance << shift);
+}
+
+// the absolute edge coordinate of every relative one for a cross coordinate, and back
+static void pair_edges_for_cross(const coord_tables_s *tables, uint32_t cross,
+                                 uint8_t absolute[16], uint8_t relative[NUM_EDGE_COORDS]) {
+    uint8_t rel = 0;
+    for (uint8_t edge = 0; edge < NUM_EDGE_COORDS; edge++) {
+        if (tables->cross_slots[cross] & (1 << (edge >> 1))) {
+            relative[edge] = 0xff;
+        } else {
+            absolute[rel] = edge;
+            relative[edge] = rel++;
+        }
+    }
+}
+
+static uint8_t* build_distances(void) {
+    coord_tables_s *tables = coord_tables_create();
+    uint8_t *distances = (uint8_t*)malloc(PRUNING_TABLE_SIZE);
+    // a bit per cross coordinate with states at the current and next depth
+    uint8_t *frontier = (uint8_t*)calloc(NUM_CROSS_COORDS/8 + 1, 1);
+    uint8_t *next_frontier = (uint8_t*)calloc(NUM_CROSS_COORDS/8 + 1, 1);
+    if (!tables || !distances || !frontier || !next_frontier) {
+        coord_tables_free(tables);
+        free(distances);
+        free(frontier);
+        free(next_frontier);
+        return NULL;
+    }
+    memset(distances, 0xff, PRUNING_TABLE_SIZE);
+
+    cube18B_xcross1_s solved = cube18B_xcross4_to_xcross1(&SOLVED_CUBE18B_XCROSS4, 0);
+    coord_xcross1_s solved_coord = coord_xcross1_from_cube18B_xcross1(&solved);
+    set_distance(distances, coord_xcross1_rank(tables, &solved_coord), 0);
+    frontier[solved_coord.cross >> 3] |= 1 << (solved_coord.cross & 7);
+
+    for (uint8_t depth = 0; depth + 1 < XCROSS1_UNVISITED; depth++) {
+        bool found_any = false;
+        for (uint32_t cross = 0; cross < NUM_CROSS_COORDS; cross++) {
+            if (!(frontier[cross >> 3] & (1 << (cross & 7)))) continue;
+
+            uint8_t absolute[16], relative[NUM_EDGE_COORDS];
+            pair_edges_for_cross(tables, cross, absolute, relative);
+
+            // the states of this cross coordinate at the current depth
+            uint16_t states[STATES_PER_CROSS];
+            size_t num_states = 0;
+            for (uint16_t state = 0; state < STATES_PER_CROSS; state++) {
+                if (get_distance(distances, cross*STATES_PER_CROSS + state) == depth) {
+                    states[num_states++] = state;
+                }
+            }
+
+            for (move_e move = 0; move < NUM_MOVES; move++) {
+                uint32_t new_cross = tables->cross[cross][move];
+                uint8_t new_absolute[16], new_relative[NUM_EDGE_COORDS];
+                pair_edges_for_cross(tables, new_cross, new_absolute, new_relative);
+
+                for (size_t i = 0; i < num_states; i++) {
+                    uint8_t edge = absolute[states[i] / NUM_CORNER_COORDS];
+                    uint8_t corner = states[i] % NUM_CORNER_COORDS;
+                    uint32_t new_rank = new_cross*STATES_PER_CROSS +
+                                        new_relative[tables->edge[edge][move]]*NUM_CORNER_COORDS +
+                                        tables->corner[corner][move];
+                    if (get_distance(distances, new_rank) == XCROSS1_UNVISITED) {
+                        set_distance(distances, new_rank, depth + 1);
+                        next_frontier[new_cross >> 3] |= 1 << (new_cross & 7);
+                        found_any = true;
+                    }
+                }
+            }
+        }
+
+        if (!found_any) break;
+        uint8_t *tmp = frontier;
+        frontier = next_frontier;
+        next_frontier = tmp;
+        memset(next_frontier, 0, NUM_CROSS_COORDS/8 + 1);
+    }
+
+    coord_tables_free(tables);
+    free(frontier);
+    free(next_frontier);
+    return distances;
+}
+
+static bool write_distances(const char *path, const uint8_t *distances) {
+    pruning_table_header_s header = {
+        .version = PRUNING_TABLE_VERSION,
+        .num_ranks = NUM_XCROSS1_RANKS,
+    };
+    memcpy(header.magic, PRUNING_TABLE_MAGIC, sizeof(header.magic));
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        return false;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                   fwrite(distances, 1, PRUNING_TABLE_SIZE, fp) == PRUNING_TABLE_SIZE;
+    if (fclose(fp) != 0 || !written) {
+        remove(path);
+        return false;
+    }
+    return true;
+}
+
+static xcross1_pruning_table_s* map_distances(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1 || file_stat.st_size != sizeof(pruning_table_header_s) + PRUNING_TABLE_SIZE) {
+        close(fd);
+        return NULL;
+    }
+
+    void *mapping = mmap(NULL, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+
+    const pruning_table_header_s *header = mapping;
+    if (memcmp(header->magic, PRUNING_TABLE_MAGIC, sizeof(header->magic)) ||
+        header->version != PRUNING_TABLE_VERSION || header->num_ranks != NUM_XCROSS1_RANKS) {
+        munmap(mapping, file_stat.st_size);
+        return NULL;
+    }
+
+    xcross1_pruning_table_s *pt = (xcross1_pruning_table_s*)malloc(sizeof(xcross1_pruning_table_s));
+    pt->distances = (const uint8_t*)mapping + sizeof(pruning_table_header_s);
+    pt->mapping = mapping;
+    pt->mapping_size = file_stat.st_size;
+    return pt;
+}
+
+xcross1_pruning_table_s* xcross1_pruning_table_load(const char *path) {
+    xcross1_pruning_table_s *pt = map_distances(path);
+    if (pt) {
+        return pt;
+    }
+
+    fprintf(stderr, "Building the xcross pruning table, this only happens once...\n");
+    uint8_t *distances = build_distances();
+    if (!distances) {
+        return NULL;
+    }
+
+    // map what was written so it's shared like any other load, and if it
+    // can't be written just use it from memory
+    if (write_distances(path, distances) && (pt = map_distances(path))) {
+        free(distances);
+        return pt;
+    }
+
+    printf("Couldn't save the xcross pruning table to %s\n", path);
+    pt = (xcross1_pruning_table_s*)malloc(sizeof(xcross1_pruning_table_s));
+    pt->distances = distances;
+    pt->mapping = NULL;
+    pt->mapping_size = 0;
+    return pt;
+}
+
+void xcross1_pruning_table_free(xcross1_pruning_table_s *pt) {
+    if (pt == NULL) return;
+    if (pt->mapping) {
+        munmap(pt->mapping, pt->mapping_size);
+    } else {
+        free((uint8_t*)pt->distances);
+    }
+    free(pt);
+}
@@ -0,0 +1,30 @@
+#ifndef XCROSS1_PRUNING_TABLE_H
+#define XCROSS1_PRUNING_TABLE_H
+
+#include "main.h"
+#include "coord.h"
+
+// The exact number of moves from every xcross1 state of pair 0 to the solved
+// cross and pair, 4 bits per state indexed by coord_xcross1_rank. Other pairs
+// are looked up through a y rotation, see solver.c. It is built once with a
+// breadth first search and saved, after that it's mapped read only so every
+// thread and process shares the same pages
+typedef struct xcross1_pruning_table {
+    const uint8_t *distances;
+
+    // set when the table is a mapped file rather than built in memory
+    void *mapping;
+    size_t mapping_size;
+} xcross1_pruning_table_s;
+
+// states further than this from solved don't exist, 15 marks an unvisited state
+#define XCROSS1_UNVISITED 15
+
+xcross1_pruning_table_s* xcross1_pruning_table_load(const char *path);
+void xcross1_pruning_table_free(xcross1_pruning_table_s *pt);
+
+static inline uint8_t xcross1_pruning_table_distance(const xcross1_pruning_table_s *pt, uint32_t rank) {
+    return (pt->distances[rank >> 1] >> ((rank & 1) << 2)) & 0xf;
+}
+
+#endif // XCROSS1_PRUNING_TABLE_H
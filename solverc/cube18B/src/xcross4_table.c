@@ -1,165 +1,149 @@
+#include "arena.h"
 #include "cube18B.h"
 #include "solver_print.h"
 #include "xcross4_table.h"
 #include "shift_cube.h"
 
+// A state reached by a single alg keeps it inline, which is most of them. Only
+// once a second alg comes along do they move out into a list in the arena
 typedef struct {
-    cube18B_xcross4_s key;
-    alg_list_s algs;
-} xcross4_entry_s;
+    union {
+        packed_alg_t alg;
+        packed_alg_t *algs;
+    };
+    uint32_t num_algs;
+    uint32_t size;
+} xcross4_algs_s;
+
+// the searches carry each state's hash along with it, see cube18B_xcross4_hashed_s
+HASH_TABLE_DEFINE_HASHED(xcross4_map, cube18B_xcross4_key_t, xcross4_algs_s, compare_cube18B_keys, cube18B_xcross4_key_hash)
 
 typedef struct xcross4_table {
-    size_t entries;
-    size_t size;
+    xcross4_map_s map;
 
-    xcross4_entry_s *table;
+    // the alg lists are in the arena, so clearing drops them all at once
+    arena_s *arena;
 } xcross4_table_s;
 
-xcross4_table_s* xcross4_table_create(size_t size) {
-    xcross4_table_s *ct = (xcross4_table_s*)malloc(sizeof(xcross4_table_s));
-
-    ct->table = (xcross4_entry_s*)calloc(size, sizeof(xcross4_entry_s));
-
-    ct->entries = 0;
-    ct->size    = size;
-    return ct;
+static const packed_alg_t* xcross4_algs_list(const xcross4_algs_s *entry) {
+    return (entry->num_algs == 1) ? &entry->alg : entry->algs;
 }
 
-size_t xcross4_table_hash(const xcross4_table_s *ct, const cube18B_xcross4_s *key) {
-    size_t hash = 0;
-    for (uint8_t ind = 0; ind < 12; ind++) {
-        hash ^= key->cubies[ind];
-        hash  = rolq(hash, 3);
+xcross4_table_s* xcross4_table_create(size_t num_entries) {
+    xcross4_table_s *ct = (xcross4_table_s*)malloc(sizeof(xcross4_table_s));
+    if (!ct) {
+        return NULL;
     }
 
-    return hash % ct->size;
+    ct->arena = arena_create(1 << 20);
+    if (!xcross4_map_init(&ct->map, num_entries) || !ct->arena) {
+        xcross4_table_free(ct);
+        return NULL;
+    }
+    return ct;
 }
 
-bool xcross4_table_insert(xcross4_table_s *ct, const cube18B_xcross4_s *key, const alg_s *moves) {
-    if (ct == NULL || key == NULL || moves == NULL) {
+bool xcross4_table_insert_hashed(xcross4_table_s *ct, const cube18B_xcross4_hashed_s *key, const alg_s *moves) {
+    packed_alg_t packed;
+    if (ct == NULL || key == NULL || moves == NULL || !packed_alg_from_alg(moves, &packed)) {
         return false;
     }
 
-    size_t hash = xcross4_table_hash(ct, key);
-    size_t index = hash;
-
-    // linear probing
-    while (ct->table[index].algs.list != NULL) {
-        if (compare_cube18B_xcross4(&(ct->table[index].key), key)) {
-            if (ct->table[index].algs.num_algs == ct->table[index].algs.size) {
-                size_t new_size = 2*sizeof(alg_s)*ct->table[index].algs.size;
-                alg_s *tmp = realloc(ct->table[index].algs.list, new_size);
-
-                if (!tmp) {
-                    return false;
-                }
-
-                ct->table[index].algs.list = tmp;
-                ct->table[index].algs.size *=2;
-            }
-
-            ct->table[index].algs.list[ct->table[index].algs.num_algs] = alg_static_copy(moves);
-            ct->table[index].algs.num_algs++;
+    bool inserted;
+    xcross4_map_slot_s *slot = xcross4_map_insert_hashed(&ct->map, &key->key, key->hash, &inserted);
+    if (!slot) {
+        return false;
+    }
+    xcross4_algs_s *entry = &slot->value;
 
-            return true;
-        }
+    if (inserted) {
+        entry->alg = packed;
+        entry->num_algs = 1;
+        entry->size = 1;
+        return true;
+    }
 
-        index++;
-        if (index == hash) {
+    if (entry->num_algs == entry->size) {
+        // the old list stays in the arena until the next clear
+        packed_alg_t *tmp = arena_alloc(ct->arena, 2*sizeof(packed_alg_t)*entry->size);
+        if (!tmp) {
             return false;
         }
-
-        if (index >= ct->size) {
-            index = 0;
-        }
+        memcpy(tmp, xcross4_algs_list(entry), sizeof(packed_alg_t)*entry->num_algs);
+        entry->algs = tmp;
+        entry->size *= 2;
     }
 
-
-    ct->table[index].key  = *key;
-
-    ct->entries++;
-
-    ct->table[index].algs.list = (alg_s*)malloc(sizeof(alg_s));
-    ct->table[index].algs.list[0] = alg_static_copy(moves);
-
-    ct->table[index].algs.num_algs = 1;
-    ct->table[index].algs.size = 1;
-
+    entry->algs[entry->num_algs++] = packed;
     return true;
 }
 
-static inline size_t xcross4_table_get_cube_index(const xcross4_table_s *ct, const cube18B_xcross4_s *cube) {
-    if (ct == NULL || cube == NULL) {
-        return ct->size;
+bool xcross4_table_insert(xcross4_table_s *ct, const cube18B_xcross4_s *key, const alg_s *moves) {
+    if (key == NULL) {
+        return false;
     }
 
-    size_t hash = xcross4_table_hash(ct, cube);
-    size_t index = hash;
-
-    while (ct->table[index].algs.list != NULL) {
-        if (compare_cube18B_xcross4(&(ct->table[index].key), cube)) {
-            return index;
-        }
-
-        if (index + 1 == hash) {
-            break;
-        }
+    cube18B_xcross4_hashed_s hashed = cube18B_xcross4_hashed_from(key);
+    return xcross4_table_insert_hashed(ct, &hashed, moves);
+}
 
-        index = (index + 1 >= ct->size) ? 0 : index + 1;
+// returns the num_algs algs for cube, num_algs can be NULL if only the first is needed
+const packed_alg_t* xcross4_table_lookup_hashed(const xcross4_table_s *ct, const cube18B_xcross4_hashed_s *cube,
+                                                size_t *num_algs) {
+    const xcross4_map_slot_s *slot = xcross4_map_find_hashed(&ct->map, &cube->key, cube->hash);
+    if (slot == NULL) {
+        return NULL;
     }
 
-    return ct->size;
+    if (num_algs) {
+        *num_algs = slot->value.num_algs;
+    }
+    return xcross4_algs_list(&slot->value);
 }
 
-const alg_list_s* xcross4_table_lookup(const xcross4_table_s *ct, const cube18B_xcross4_s *cube) {
-    size_t index = xcross4_table_get_cube_index(ct, cube);
+const packed_alg_t* xcross4_table_lookup(const xcross4_table_s *ct, const cube18B_xcross4_s *cube, size_t *num_algs) {
+    cube18B_xcross4_hashed_s hashed = cube18B_xcross4_hashed_from(cube);
+    return xcross4_table_lookup_hashed(ct, &hashed, num_algs);
+}
 
-    return (index == ct->size) ? NULL : &ct->table[index].algs;
+bool xcross4_table_reserve(xcross4_table_s *ct, size_t num_entries) {
+    return xcross4_map_reserve(&ct->map, num_entries);
 }
 
 void xcross4_table_clear(xcross4_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
+    if (ct == NULL || ct->map.slots == NULL) {
         return;
     }
 
-    for (size_t index = 0; index < ct->size; index++) {
-        if (ct->table[index].algs.list != NULL) {
-            for (size_t i = 0; i < ct->table[index].algs.num_algs; i++) {
-                free(ct->table[index].algs.list[i].moves);
-            }
-
-            free(ct->table[index].algs.list);
-            ct->table[index].algs.list = NULL;
-        }
-    }
-
-    ct->entries = 0;
+    xcross4_map_clear(&ct->map);
+    arena_reset(ct->arena);
 }
 
 void xcross4_table_free(xcross4_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
-        free(ct);
+    if (ct == NULL) {
         return;
     }
 
-    xcross4_table_clear(ct);
-
-    free(ct->table);
+    arena_free(ct->arena);
+    xcross4_map_destroy(&ct->map);
     free(ct);
 }
 
 void xcross4_table_print(xcross4_table_s *ct) {
     printf("   index  |               cube string representation            | algorithm\n");
     printf("------------------------------------------------------------------------------\n");
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].algs.list != NULL) {
+    for (size_t idx = 0; idx < ct->map.capacity; idx++) {
+        if (xcross4_map_slot_used(&ct->map, idx)) {
+            move_e moves[PACKED_ALG_MAX_MOVES];
+            alg_s alg = packed_alg_unpack(xcross4_algs_list(&ct->map.slots[idx].value)[0], moves);
+            cube18B_xcross4_s cube = cube18B_xcross4_unpack(ct->map.slots[idx].key);
             printf("%10zu ", idx);
-            print_cube18B_xcross4(&(ct->table[idx].key));
-            print_alg(&ct->table[idx].algs.list[0]);
+            print_cube18B_xcross4(&cube);
+            print_alg(&alg);
         }
 
         if (idx != 0) {
-            if (ct->table[idx].algs.list == NULL && ct->table[idx-1].algs.list != NULL) {
+            if (!xcross4_map_slot_used(&ct->map, idx) && xcross4_map_slot_used(&ct->map, idx-1)) {
                 printf("                                    ...                                    \n");
             }
         }
@@ -167,9 +151,13 @@ void xcross4_table_print(xcross4_table_s *ct) {
 }
 
 size_t xcross4_table_entries(const xcross4_table_s *ct) {
-    return ct->entries;
+    return ct->map.entries;
 }
 
 size_t xcross4_table_size(const xcross4_table_s *ct) {
-    return ct->size;
+    return ct->map.capacity;
+}
+
+hash_table_stats_s xcross4_table_stats(const xcross4_table_s *ct) {
+    return xcross4_map_stats(&ct->map);
 }
@@ -7,17 +7,24 @@
 #include "main.h"
 #include "alg.h"
 #include "cube18B.h"
+#include "hash_table.h"
+#include "packed_alg.h"
 
 typedef struct xcross4_table xcross4_table_s;
 
-xcross4_table_s* xcross4_table_create(size_t size);
+xcross4_table_s* xcross4_table_create(size_t num_entries);
 bool xcross4_table_insert(xcross4_table_s *ct, const cube18B_xcross4_s *key, const alg_s *moves);
-const alg_list_s* xcross4_table_lookup(const xcross4_table_s *ct, const cube18B_xcross4_s *cube);
+bool xcross4_table_insert_hashed(xcross4_table_s *ct, const cube18B_xcross4_hashed_s *key, const alg_s *moves);
+bool xcross4_table_reserve(xcross4_table_s *ct, size_t num_entries);
+const packed_alg_t* xcross4_table_lookup(const xcross4_table_s *ct, const cube18B_xcross4_s *cube, size_t *num_algs);
+const packed_alg_t* xcross4_table_lookup_hashed(const xcross4_table_s *ct, const cube18B_xcross4_hashed_s *cube,
+                                                size_t *num_algs);
 void xcross4_table_free(xcross4_table_s *ct);
 void xcross4_table_clear(xcross4_table_s *ct);
 void xcross4_table_print(xcross4_table_s *ct);
 
 size_t xcross4_table_entries(const xcross4_table_s *ct);
 size_t xcross4_table_size(const xcross4_table_s *ct);
+hash_table_stats_s xcross4_table_stats(const xcross4_table_s *ct);
 
 #endif // XCROSS4_TABLE_H
@@ -6,26 +6,26 @@
 void LL_print_algs_bigger_than_n(const cube_alg_table_s* ct, size_t n) {
     printf("   index  |               cube string representation            | algorithm\n");
     printf("------------------------------------------------------------------------------\n");
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.length <= n) continue;
-        if (ct->table[idx].alg.moves != NULL) {
+    for (size_t idx = 0; idx < ct->map.capacity; idx++) {
+        if (cube_alg_map_slot_used(&ct->map, idx)) {
+            if (ct->map.slots[idx].value.length <= n) continue;
             printf("%10zu ", idx);
-            print_cube_line_colors(ct->table[idx].key);
-            print_alg(&ct->table[idx].alg);
+            print_cube_line_colors(ct->map.slots[idx].key);
+            print_alg(&ct->map.slots[idx].value);
         }
     }
 }
 
 bool LL_check_if_1LLL_is_valid(const cube_alg_table_s* ct) {
     bool is_valid = true;
-    if (ct->entries != 62208) is_valid = false;
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.moves != NULL) {
-            shift_cube_s cube_mask = masked_cube(&ct->table[idx].key, &f2l_4mask);
+    if (ct->map.entries != 62208) is_valid = false;
+    for (size_t idx = 0; idx < ct->map.capacity; idx++) {
+        if (cube_alg_map_slot_used(&ct->map, idx)) {
+            shift_cube_s cube_mask = masked_cube(&ct->map.slots[idx].key, &f2l_4mask);
             shift_cube_s solved_mask = masked_cube(&SOLVED_SHIFTCUBE, &f2l_4mask);
             if (!compare_cubes(&cube_mask, &solved_mask)) is_valid = false;
-            shift_cube_s test_cube = ct->table[idx].key;
-            apply_alg(&test_cube, &ct->table[idx].alg);
+            shift_cube_s test_cube = ct->map.slots[idx].key;
+            apply_alg(&test_cube, &ct->map.slots[idx].value);
             if (!compare_cubes(&test_cube, &SOLVED_SHIFTCUBE)) is_valid = false;
         }
     } if (!is_valid) printf("1LLL NOT VALID!\n");
@@ -34,23 +34,23 @@ bool LL_check_if_1LLL_is_valid(const cube_alg_table_s* ct) {
 
 uint8_t LL_get_maximimum_alg_length(const cube_alg_table_s* ct) {
     uint8_t max = 0;
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.moves != NULL) {
-            uint8_t candidate = ct->table[idx].alg.length;
+    for (size_t idx = 0; idx < ct->map.capacity; idx++) {
+        if (cube_alg_map_slot_used(&ct->map, idx)) {
+            uint8_t candidate = ct->map.slots[idx].value.length;
             if (candidate > max) max = candidate;
         }
     } return max;
 }
 
 void print_alg_length_frequencies(const cube_alg_table_s* ct) {
-    printf("num entries: %zu\n", ct->entries);
+    printf("num entries: %zu\n", ct->map.entries);
     uint8_t maxlength = LL_get_maximimum_alg_length(ct);
     size_t counts[maxlength+1];
     for (int i = 0; i < maxlength+1; i++) counts[i] = 0;
 
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.moves != NULL) {
-            counts[ct->table[idx].alg.length]++;
+    for (size_t idx = 0; idx < ct->map.capacity; idx++) {
+        if (cube_alg_map_slot_used(&ct->map, idx)) {
+            counts[ct->map.slots[idx].value.length]++;
         }
     }
     printf("maximum length is %hhu", maxlength);
@@ -73,9 +73,9 @@ void LL_table_diagnostics(const cube_alg_table_s* ct) {
 
 cube_alg_table_s* get_very_unique_1LLL_cases(const cube_alg_table_s* ct) {
     cube_alg_table_s* very_uniq_cases = cube_alg_table_create(9257);
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.moves != NULL) { //printf("\tline 367\n");
-            alg_list_s* alg_family = get_alg_family(&ct->table[idx].alg); //printf("\tline 368\n");
+    for (size_t idx = 0; idx < ct->map.capacity; idx++) {
+        if (cube_alg_map_slot_used(&ct->map, idx)) { //printf("\tline 367\n");
+            alg_list_s* alg_family = get_alg_family(&ct->map.slots[idx].value); //printf("\tline 368\n");
             shift_cube_s least_cube = NULL_CUBE;
             alg_s least_alg;
             least_alg.moves = NULL;
@@ -103,10 +103,10 @@ cube_alg_table_s* get_very_unique_1LLL_cases(const cube_alg_table_s* ct) {
 } 
 
 cube_alg_table_s* get_1LLL_from_very_uniq_cases(const cube_alg_table_s* ct) {
-    cube_alg_table_s* LL_table = cube_alg_table_create(131009);
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.moves != NULL) {
-            alg_list_s* alg_family = get_alg_family(&ct->table[idx].alg);
+    cube_alg_table_s* LL_table = cube_alg_table_create(62208);
+    for (size_t idx = 0; idx < ct->map.capacity; idx++) {
+        if (cube_alg_map_slot_used(&ct->map, idx)) {
+            alg_list_s* alg_family = get_alg_family(&ct->map.slots[idx].value);
             for (int i = 0; i < alg_family->num_algs; i++) {
                 shift_cube_s cube = SOLVED_SHIFTCUBE;
                 apply_alg(&cube, &alg_family->list[i]);
@@ -301,18 +301,18 @@ void LL_find_improvements_to_depth_n(cube_alg_table_s* ct, uint8_t n, size_t sta
 
     size_t tried = 0;
     size_t total_algs_to_try = 0;
-    for (size_t idx = start_ind; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.moves == NULL) continue;
-        if (ct->table[idx].alg.length <= n) continue;
+    for (size_t idx = start_ind; idx < ct->map.capacity; idx++) {
+        if (!cube_alg_map_slot_used(&ct->map, idx)) continue;
+        if (ct->map.slots[idx].value.length <= n) continue;
         total_algs_to_try++;
     }
-    for (size_t idx = start_ind; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.moves == NULL) continue;
-        if (ct->table[idx].alg.length <= n) continue;
+    for (size_t idx = start_ind; idx < ct->map.capacity; idx++) {
+        if (!cube_alg_map_slot_used(&ct->map, idx)) continue;
+        if (ct->map.slots[idx].value.length <= n) continue;
 
-        uint8_t current_length = ct->table[idx].alg.length;
+        uint8_t current_length = ct->map.slots[idx].value.length;
 
-        alg_s* alg = bidirectional_1LLL_search(&ct->table[idx].key, end_ct, end_depth, start_depth);
+        alg_s* alg = bidirectional_1LLL_search(&ct->map.slots[idx].key, end_ct, end_depth, start_depth);
         tried++;
         if (alg == NULL) {
             continue;
@@ -323,8 +323,7 @@ void LL_find_improvements_to_depth_n(cube_alg_table_s* ct, uint8_t n, size_t sta
         total_found++;
         if (alg->length < current_length) {
             total_improved++;
-            free(ct->table[idx].alg.moves);
-            ct->table[idx].alg = alg_static_copy(alg);
+            cube_alg_table_overwrite(ct, &ct->map.slots[idx].key, alg);
             printf("On try %4zu/%4zu: alg improved to length %2hhu with gain %2hhu: ", tried, total_algs_to_try, alg->length, current_length - alg->length);
             print_alg(alg);
         }
@@ -69,7 +69,11 @@ MinHeapMap_insertMessage MinHeapMap_insert(MinHeapMap *map, const MinHeapNode* k
             .NodeIsNew = true
         };
     } else {
-        if (map->nodes[hash].distance > key->distance || (map->nodes[hash].distance == key->distance && map->nodes[hash].action > key->action)) {
+        // exact ties go to the parent earliest in the map so the pick doesn't depend on the
+        // order nodes come off the heap
+        const MinHeapNode* node = &map->nodes[hash];
+        if (node->distance > key->distance || (node->distance == key->distance && (node->action > key->action ||
+            (node->action == key->action && node->parent > key->parent)))) {
             map->nodes[hash].distance = key->distance;
             map->nodes[hash].action = key->action;
             map->nodes[hash].parent = key->parent;
@@ -0,0 +1,109 @@
+#include "arena.h"
+
+// every allocation is rounded up to this, enough for pointers and size_ts
+#define ARENA_ALIGNMENT 8
+
+typedef struct arena_block {
+    struct arena_block *prev;
+    size_t size;
+    size_t used;
+    uint8_t data[];
+} arena_block_s;
+
+static arena_block_s* arena_block_create(size_t size, arena_block_s *prev) {
+    arena_block_s *block = (arena_block_s*)malloc(sizeof(arena_block_s) + size);
+    if (!block) {
+        return NULL;
+    }
+
+    block->prev = prev;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+arena_s* arena_create(size_t size) {
+    arena_s *arena = (arena_s*)malloc(sizeof(arena_s));
+    if (!arena) {
+        return NULL;
+    }
+
+    if (size < ARENA_ALIGNMENT) {
+        size = ARENA_ALIGNMENT;
+    }
+    arena->block = arena_block_create(size, NULL);
+    if (!arena->block) {
+        free(arena);
+        return NULL;
+    }
+    arena->capacity = size;
+    return arena;
+}
+
+void* arena_alloc(arena_s *arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    arena_block_s *block = arena->block;
+    if (block->size - block->used < size) {
+        // at least double, so a growing arena only chains a few blocks
+        size_t new_size = (size > arena->capacity) ? size : arena->capacity;
+        block = arena_block_create(new_size, arena->block);
+        if (!block) {
+            return NULL;
+        }
+        arena->block = block;
+        arena->capacity += new_size;
+    }
+
+    void *ptr = &block->data[block->used];
+    block->used += size;
+    return ptr;
+}
+
+void arena_reset(arena_s *arena) {
+    if (arena == NULL) return;
+
+    if (arena->block->prev == NULL) {
+        arena->block->used = 0;
+        return;
+    }
+
+    // it outgrew its first block, replace the chain with a block that fits all of
+    // it. If that can't be had keep the newest block, it's the biggest
+    arena_block_s *merged = arena_block_create(arena->capacity, NULL);
+    arena_block_s *keep = merged ? NULL : arena->block;
+    arena_block_s *block = merged ? arena->block : arena->block->prev;
+    while (block) {
+        arena_block_s *prev = block->prev;
+        free(block);
+        block = prev;
+    }
+
+    if (merged) {
+        arena->block = merged;
+    } else {
+        keep->prev = NULL;
+        keep->used = 0;
+        arena->block = keep;
+        arena->capacity = keep->size;
+    }
+}
+
+void arena_free(arena_s *arena) {
+    if (arena == NULL) return;
+
+    while (arena->block) {
+        arena_block_s *prev = arena->block->prev;
+        free(arena->block);
+        arena->block = prev;
+    }
+    free(arena);
+}
+
+size_t arena_used(const arena_s *arena) {
+    size_t used = 0;
+    for (const arena_block_s *block = arena->block; block; block = block->prev) {
+        used += block->used;
+    }
+    return used;
+}
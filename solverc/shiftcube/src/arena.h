@@ -0,0 +1,27 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "main.h"
+
+// A bump allocator for memory that all dies at the same time, like everything
+// a search table stores during one solve. Allocating is a pointer bump and
+// arena_reset gives it all back at once, there's no freeing single allocations.
+//
+// When the current block runs out a bigger one is chained on, and the next
+// reset swaps the chain for one block big enough for all of it, so after the
+// first few solves a reset never touches the heap.
+typedef struct arena_block arena_block_s;
+
+typedef struct arena {
+    arena_block_s *block;
+    size_t capacity; // of every block in the chain together
+} arena_s;
+
+arena_s* arena_create(size_t size);
+void* arena_alloc(arena_s *arena, size_t size);
+void arena_reset(arena_s *arena);
+void arena_free(arena_s *arena);
+
+size_t arena_used(const arena_s *arena);
+
+#endif // ARENA_H
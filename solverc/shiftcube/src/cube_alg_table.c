@@ -2,60 +2,38 @@
 #include "solver_print.h"
 #include "cube_alg_table.h"
 
-cube_alg_table_s* cube_alg_table_create(size_t size) {
+cube_alg_table_s* cube_alg_table_create(size_t num_entries) {
     cube_alg_table_s *ct = (cube_alg_table_s*)malloc(sizeof(cube_alg_table_s));
 
-    ct->table = (cube_alg_entry_s*)calloc(size, sizeof(cube_alg_entry_s));
-
-    ct->entries = 0;
-    ct->size    = size;
-    return ct;
-}
-
-size_t cube_alg_table_hash(const cube_alg_table_s *ct, const shift_cube_s *key) {
-    size_t hash = 0;
-    for (face_e face = FACE_U; face < NUM_FACES; face++) {
-        hash ^= key->state[face];
-        hash  = rolq(hash, 17);
+    if (!cube_alg_map_init(&ct->map, num_entries)) {
+        free(ct);
+        return NULL;
     }
-
-    return hash % ct->size;
+    ct->arena = arena_create(4096);
+    ct->image = NULL;
+    ct->image_map = (cube_alg_image_map_s) {0};
+    ct->image_moves = NULL;
+    return ct;
 }
-cube_alg_entry_s* cube_alg_table_get_insertion_index(const cube_alg_table_s *ct, const shift_cube_s *key) {
-    size_t hash = cube_alg_table_hash(ct, key);
-    size_t index = hash;
-
-    // linear probing
-    while (ct->table[index].alg.moves != NULL) {
-        if (compare_cubes(&(ct->table[index].key), key)) {
-            return &ct->table[index];
-        }
-
-        index++;
-        if (index == hash) {
-            return NULL;
-        }
 
-        if (index >= ct->size) {
-            index = 0;
-        }
-    } return &ct->table[index];
+static alg_s cube_alg_table_copy_alg(cube_alg_table_s *ct, const alg_s *src) {
+    alg_s copy;
+    copy.moves = (move_t*)arena_alloc(ct->arena, src->length);
+    (void)memcpy(copy.moves, src->moves, src->length * sizeof(move_t));
+    copy.length = src->length;
+    copy.size   = src->length;
+    return copy;
 }
 
 bool cube_alg_table_shallow_insert(cube_alg_table_s *ct, const shift_cube_s *key, alg_s *moves) {
-    cube_alg_entry_s *entry = cube_alg_table_get_insertion_index(ct, key);
-
-    if (!entry) return false;
+    bool inserted;
+    cube_alg_map_slot_s *slot = cube_alg_map_insert(&ct->map, key, &inserted);
 
-    if (entry->alg.moves) {
-        free(entry->alg.moves);
-        entry->alg = *moves;
-        return true;
-    }
+    if (!slot) return false;
 
-    entry->key = *key;
-    entry->alg = *moves;
-    ct->entries++;
+    // the table's algs all live in its arena, so the moves are moved in there
+    slot->value = cube_alg_table_copy_alg(ct, moves);
+    free(moves->moves);
     return true;
 }
 
@@ -64,19 +42,12 @@ bool cube_alg_table_overwrite(cube_alg_table_s *ct, const shift_cube_s *key, con
         return false;
     }
 
-    cube_alg_entry_s* entry = cube_alg_table_get_insertion_index(ct, key);
-    if (entry == NULL) return false;
+    bool inserted;
+    cube_alg_map_slot_s *slot = cube_alg_map_insert(&ct->map, key, &inserted);
+    if (slot == NULL) return false;
 
-    if (entry->alg.moves != NULL) {
-        free(entry->alg.moves);
-        entry->alg = alg_static_copy(moves);
-        return true;
-    } else {
-        entry->key = *key;
-        entry->alg = alg_static_copy(moves);
-        ct->entries++;
-        return true;
-    }
+    slot->value = cube_alg_table_copy_alg(ct, moves);
+    return true;
 }
 
 bool cube_alg_table_overwrite_if_better(cube_alg_table_s *ct, const shift_cube_s *key, const alg_s *moves) {
@@ -84,20 +55,13 @@ bool cube_alg_table_overwrite_if_better(cube_alg_table_s *ct, const shift_cube_s
         return false;
     }
 
-    cube_alg_entry_s* entry = cube_alg_table_get_insertion_index(ct, key);
-    if (entry == NULL) return false;
+    bool inserted;
+    cube_alg_map_slot_s *slot = cube_alg_map_insert(&ct->map, key, &inserted);
+    if (slot == NULL) return false;
 
-    if (entry->alg.moves != NULL) {
-        if (entry->alg.length <= moves->length) return false;
-        free(entry->alg.moves);
-        entry->alg = alg_static_copy(moves);
-        return true;
-    } else {
-        entry->key = *key;
-        entry->alg = alg_static_copy(moves);
-        ct->entries++;
-        return true;
-    }
+    if (!inserted && slot->value.length <= moves->length) return false;
+    slot->value = cube_alg_table_copy_alg(ct, moves);
+    return true;
 }
 
 bool cube_alg_table_insert_if_new(cube_alg_table_s *ct, const shift_cube_s *key, const alg_s *moves) {
@@ -105,100 +69,220 @@ bool cube_alg_table_insert_if_new(cube_alg_table_s *ct, const shift_cube_s *key,
         return false;
     }
 
-    cube_alg_entry_s* entry = cube_alg_table_get_insertion_index(ct, key);
-    if (entry == NULL) return false;
+    bool inserted;
+    cube_alg_map_slot_s *slot = cube_alg_map_insert(&ct->map, key, &inserted);
+    if (slot == NULL || !inserted) return false;
 
-    if (entry->alg.moves != NULL) {
-        return false;
-    } else {
-        entry->key = *key;
-        entry->alg = alg_static_copy(moves);
-        ct->entries++;
-        return true;
-    }
+    slot->value = cube_alg_table_copy_alg(ct, moves);
+    return true;
 }
 
-static inline cube_alg_entry_s* cube_alg_table_find_cube(const cube_alg_table_s *ct, const shift_cube_s *cube) {
-    if (ct == NULL || cube == NULL) {
+const alg_s* cube_alg_table_lookup(const cube_alg_table_s *ct, const shift_cube_s *cube) {
+    if (ct == NULL || cube == NULL || ct->image != NULL) {
         return NULL;
     }
 
-    cube_alg_entry_s* entry = cube_alg_table_get_insertion_index(ct, cube);
-    if (entry == NULL) return NULL;
-    if (entry->alg.moves == NULL) return NULL;
-    return entry; 
+    const cube_alg_map_slot_s *slot = cube_alg_map_find(&ct->map, cube);
+    return (slot == NULL) ? NULL : &slot->value;
 }
 
-const alg_s* cube_alg_table_lookup(const cube_alg_table_s *ct, const shift_cube_s *cube) {
-    const cube_alg_entry_s* entry = cube_alg_table_find_cube(ct, cube);
-
-    return (entry == NULL) ? NULL : &entry->alg;
+static alg_s cube_alg_table_image_alg(const cube_alg_table_s *ct, const cube_alg_image_alg_s *image_alg) {
+    return (alg_s) {
+        .size = image_alg->length,
+        .length = image_alg->length,
+        .moves = (move_t*)&ct->image_moves[image_alg->moves_offset],
+    };
 }
 
-void cube_alg_table_clear_entry(cube_alg_entry_s* entry) {
-    if (entry == NULL) return;
-    free(entry->alg.moves);
-    entry->alg.moves = NULL;
-    entry->alg.size = 0;
-    entry->alg.length = 0;
-    entry->key = NULL_CUBE;
+// the alg is a copy of the table's, its moves still belong to the table
+bool cube_alg_table_get(const cube_alg_table_s *ct, const shift_cube_s *cube, alg_s *alg) {
+    if (ct == NULL || cube == NULL) {
+        return false;
+    }
+
+    if (ct->image == NULL) {
+        const alg_s *found = cube_alg_table_lookup(ct, cube);
+        if (found != NULL) *alg = *found;
+        return found != NULL;
+    }
+
+    const cube_alg_image_map_slot_s *slot = cube_alg_image_map_find(&ct->image_map, cube);
+    if (slot == NULL) return false;
+    *alg = cube_alg_table_image_alg(ct, &slot->value);
+    return true;
 }
-void cube_alg_table_clear(cube_alg_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
-        return;
+
+// the key and alg in slot idx of either kind of table, false if it's unused
+static bool cube_alg_table_slot(const cube_alg_table_s *ct, size_t idx, shift_cube_s *key, alg_s *alg) {
+    if (ct->image == NULL) {
+        if (!cube_alg_map_slot_used(&ct->map, idx)) return false;
+        *key = ct->map.slots[idx].key;
+        *alg = ct->map.slots[idx].value;
+        return true;
     }
 
+    if (!cube_alg_image_map_slot_used(&ct->image_map, idx)) return false;
+    *key = ct->image_map.slots[idx].key;
+    *alg = cube_alg_table_image_alg(ct, &ct->image_map.slots[idx].value);
+    return true;
+}
 
-    for (size_t index = 0; index < ct->size; index++) {
-        if (ct->table[index].alg.moves != NULL) {
-            cube_alg_table_clear_entry(&ct->table[index]);
-        }
+void cube_alg_table_clear(cube_alg_table_s *ct) {
+    if (ct == NULL || ct->map.slots == NULL || ct->image != NULL) {
+        return;
     }
 
-    ct->entries = 0;
+    cube_alg_map_clear(&ct->map);
+    arena_reset(ct->arena);
 }
 
 void cube_alg_table_free(cube_alg_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
-        free(ct);
+    if (ct == NULL) {
         return;
     }
 
-    cube_alg_table_clear(ct);
-
-    free(ct->table);
+    // the algs live in the arena or in the mapping, so there is nothing to free
+    // per entry, and an image's slots are only borrowed from the mapping
+    table_image_unmap(ct->image);
+    arena_free(ct->arena);
+    cube_alg_map_destroy(&ct->map);
     free(ct);
 }
 
 void cube_alg_table_print(const cube_alg_table_s *ct) {
     printf("   index  |               cube string representation            | algorithm\n");
     printf("------------------------------------------------------------------------------\n");
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.moves != NULL) {
+    bool prev_used = false;
+    for (size_t idx = 0; idx < cube_alg_table_size(ct); idx++) {
+        shift_cube_s key;
+        alg_s alg;
+        bool used = cube_alg_table_slot(ct, idx, &key, &alg);
+        if (used) {
             printf("%10zu ", idx);
-            print_cube_line_colors(ct->table[idx].key);
-            print_alg(&ct->table[idx].alg);
-        }
-
-        if (idx != 0) {
-            if (ct->table[idx].alg.moves == NULL && ct->table[idx-1].alg.moves != NULL) {
-                printf("                                    ...                                    \n");
-            }
+            print_cube_line_colors(key);
+            print_alg(&alg);
+        } else if (prev_used) {
+            printf("                                    ...                                    \n");
         }
+        prev_used = used;
     }
 }
 
 size_t cube_alg_table_entries(const cube_alg_table_s *ct) {
-    return ct->entries;
+    return ct->image ? ct->image_map.entries : ct->map.entries;
 }
 
 size_t cube_alg_table_size(const cube_alg_table_s *ct) {
-    return ct->size;
+    return ct->image ? ct->image_map.capacity : ct->map.capacity;
+}
+
+hash_table_stats_s cube_alg_table_stats(const cube_alg_table_s *ct) {
+    return ct->image ? cube_alg_image_map_stats(&ct->image_map) : cube_alg_map_stats(&ct->map);
 }
 
 void cube_alg_table_print_algs(const cube_alg_table_s *ct) {
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].alg.moves == NULL) continue;
-        print_alg(&ct->table[idx].alg);
+    for (size_t idx = 0; idx < cube_alg_table_size(ct); idx++) {
+        shift_cube_s key;
+        alg_s alg;
+        if (cube_alg_table_slot(ct, idx, &key, &alg)) print_alg(&alg);
+    }
+}
+
+// the image is the table's groups and slots exactly as they are hashed, then
+// every alg's moves one byte each, so loading it only has to point the table
+// at the mapping
+bool cube_alg_table_write_image(const cube_alg_table_s *ct, const char *path) {
+    size_t capacity = cube_alg_table_size(ct);
+    shift_cube_s key;
+    alg_s alg;
+
+    size_t num_moves = 0;
+    for (size_t idx = 0; idx < capacity; idx++) {
+        if (cube_alg_table_slot(ct, idx, &key, &alg)) num_moves += alg.length;
+    }
+
+    size_t groups_size = hash_table_groups_size(capacity);
+    size_t slots_size = capacity * sizeof(cube_alg_image_map_slot_s);
+    size_t payload_size = groups_size + slots_size + num_moves;
+    uint8_t *payload = (uint8_t*)calloc(payload_size, 1);
+    cube_alg_image_map_slot_s *slots = (cube_alg_image_map_slot_s*)(payload + groups_size);
+    move_t *moves = payload + groups_size + slots_size;
+
+    if (ct->image) {
+        cube_alg_image_map_export_groups(&ct->image_map, (hash_table_group_s*)payload);
+    } else {
+        cube_alg_map_export_groups(&ct->map, (hash_table_group_s*)payload);
+    }
+
+    size_t moves_offset = 0;
+    for (size_t idx = 0; idx < capacity; idx++) {
+        if (!cube_alg_table_slot(ct, idx, &key, &alg)) continue;
+
+        slots[idx] = (cube_alg_image_map_slot_s) {
+            .key = key,
+            .value = {.moves_offset = moves_offset, .length = alg.length},
+        };
+        memcpy(&moves[moves_offset], alg.moves, alg.length);
+        moves_offset += alg.length;
+    }
+
+    bool written = table_image_write(path, TABLE_IMAGE_LL, cube_alg_table_entries(ct), capacity,
+                                     payload, payload_size);
+    free(payload);
+    return written;
+}
+
+// only the header was checked when the image was mapped, so every alg has to be
+// checked to be inside the payload and the table has to have room left for every
+// probe to end, which keeps a corrupt image from being read out of bounds
+static bool cube_alg_image_valid(const table_image_s *image, const cube_alg_image_map_s *map, size_t moves_start) {
+    size_t entries = 0;
+    for (size_t idx = 0; idx < map->capacity; idx++) {
+        if (!cube_alg_image_map_slot_used(map, idx)) continue;
+        const cube_alg_image_alg_s *alg = &map->slots[idx].value;
+        if (alg->length > UINT8_MAX || !table_image_moves_valid(image, moves_start + alg->moves_offset, alg->length)) {
+            return false;
+        }
+        entries++;
+    }
+    return entries == map->entries && entries <= map->capacity - map->capacity/8;
+}
+
+cube_alg_table_s* cube_alg_table_from_image(const char *path, const char *source_path) {
+    table_image_s *image = table_image_map(path, TABLE_IMAGE_LL, &source_path, 1);
+    if (!image) {
+        return NULL;
+    }
+
+    size_t capacity = image->header->table_size;
+    size_t groups_size = hash_table_groups_size(capacity);
+    size_t slots_size = capacity * sizeof(cube_alg_image_map_slot_s);
+    if (capacity < HASH_TABLE_GROUP_SIZE || (capacity & (capacity - 1)) ||
+        image->header->payload_size < groups_size + slots_size) {
+        table_image_unmap(image);
+        return NULL;
+    }
+
+    cube_alg_image_map_s image_map;
+    cube_alg_image_map_borrow(&image_map, (const hash_table_group_s*)image->payload,
+                              (const cube_alg_image_map_slot_s*)(image->payload + groups_size),
+                              capacity, image->header->num_records);
+    if (!cube_alg_image_valid(image, &image_map, groups_size + slots_size)) {
+        fprintf(stderr, "Ignoring corrupt table image %s\n", path);
+        table_image_unmap(image);
+        return NULL;
     }
+
+    cube_alg_table_s *ct = (cube_alg_table_s*)malloc(sizeof(cube_alg_table_s));
+    if (!ct) {
+        table_image_unmap(image);
+        return NULL;
+    }
+    ct->map = (cube_alg_map_s) {0};
+    ct->arena = NULL;
+    ct->image = image;
+    ct->image_map = image_map;
+    ct->image_moves = image->payload + groups_size + slots_size;
+
+    return ct;
 }
@@ -6,29 +6,53 @@
 
 #include "main.h"
 #include "alg.h"
+#include "arena.h"
+#include "hash_table.h"
 #include "shift_cube.h"
+#include "table_image.h"
 
+HASH_TABLE_DEFINE(cube_alg_map, shift_cube_s, alg_s, compare_cubes)
+
+// a table image stores its slots as they are, so their algs are offsets into
+// the moves that follow the slots rather than pointers
 typedef struct {
-    shift_cube_s key;
-    alg_s alg;
-} cube_alg_entry_s;
+    uint32_t moves_offset;
+    uint32_t length;
+} cube_alg_image_alg_s;
+
+HASH_TABLE_DEFINE(cube_alg_image_map, shift_cube_s, cube_alg_image_alg_s, compare_cubes)
 
 typedef struct cube_alg_table {
-    size_t entries;
-    size_t size;
+    cube_alg_map_s map;
+
+    // the moves of every alg are in the arena, so clearing drops them all at once
+    arena_s *arena;
 
-    cube_alg_entry_s *table;
+    // non-NULL when the table is a mapped table image, which makes it read
+    // only. image_map borrows the image's slots and map is left empty
+    table_image_s *image;
+    cube_alg_image_map_s image_map;
+    const move_t *image_moves;
 } cube_alg_table_s;
 
-cube_alg_table_s* cube_alg_table_create(size_t size);
+cube_alg_table_s* cube_alg_table_create(size_t num_entries);
 bool cube_alg_table_shallow_insert(cube_alg_table_s *ct, const shift_cube_s *key, alg_s *moves);
 bool cube_alg_table_overwrite(cube_alg_table_s *ct, const shift_cube_s *key, const alg_s *moves);
 bool cube_alg_table_overwrite_if_better(cube_alg_table_s *ct, const shift_cube_s *key, const alg_s *moves);
 bool cube_alg_table_insert_if_new(cube_alg_table_s *ct, const shift_cube_s *key, const alg_s *moves);
+// only finds algs in tables built in memory, tables loaded from an image need cube_alg_table_get
 const alg_s* cube_alg_table_lookup(const cube_alg_table_s *ct, const shift_cube_s *cube);
+bool cube_alg_table_get(const cube_alg_table_s *ct, const shift_cube_s *cube, alg_s *alg);
 void cube_alg_table_clear(cube_alg_table_s *ct);
 void cube_alg_table_free(cube_alg_table_s *ct);
 void cube_alg_table_print(const cube_alg_table_s *ct);
 void cube_alg_table_print_algs(const cube_alg_table_s *ct);
 
+size_t cube_alg_table_entries(const cube_alg_table_s *ct);
+size_t cube_alg_table_size(const cube_alg_table_s *ct);
+hash_table_stats_s cube_alg_table_stats(const cube_alg_table_s *ct);
+
+bool cube_alg_table_write_image(const cube_alg_table_s *ct, const char *path);
+cube_alg_table_s* cube_alg_table_from_image(const char *path, const char *source_path);
+
 #endif // CUBE_ALG_TABLE_H
@@ -4,24 +4,18 @@
 #include "lookup_tables.h"
 #include "solver.h"
 
-cube_table_s* cube_table_create(size_t size) {
+cube_table_s* cube_table_create(size_t num_entries) {
     cube_table_s *ct = (cube_table_s*)malloc(sizeof(cube_table_s));
 
-    ct->table = (entry_s*)calloc(size, sizeof(entry_s));
-
-    ct->entries = 0;
-    ct->size    = size;
-    return ct;
-}
-
-size_t cube_table_hash(const cube_table_s *ct, const shift_cube_s *key) {
-    size_t hash = 0;
-    for (face_e face = FACE_U; face < NUM_FACES; face++) {
-        hash ^= key->state[face];
-        hash  = rolq(hash, 17);
+    if (!cube_map_init(&ct->map, num_entries)) {
+        free(ct);
+        return NULL;
     }
-
-    return hash % ct->size;
+    ct->image = NULL;
+    ct->image_map = (cube_image_map_s) {0};
+    ct->image_algs = NULL;
+    ct->image_moves = NULL;
+    return ct;
 }
 
 bool cube_table_insert(cube_table_s *ct, const shift_cube_s *key, const alg_s *moves) {
@@ -29,50 +23,30 @@ bool cube_table_insert(cube_table_s *ct, const shift_cube_s *key, const alg_s *m
         return false;
     }
 
-    size_t hash = cube_table_hash(ct, key);
-    size_t index = hash;
-
-    // linear probing
-    while (ct->table[index].algs.list != NULL) {
-        if (compare_cubes(&(ct->table[index].key), key)) {
-            if (ct->table[index].algs.num_algs == ct->table[index].algs.size) {
-                size_t new_size = 2*sizeof(alg_s)*ct->table[index].algs.size;
-                alg_s *tmp = realloc(ct->table[index].algs.list, new_size);
-
-                if (!tmp) {
-                    return false;
-                }
-
-                ct->table[index].algs.list = tmp;
-                ct->table[index].algs.size *=2;
-            }
+    bool inserted;
+    cube_map_slot_s *slot = cube_map_insert(&ct->map, key, &inserted);
+    if (!slot) {
+        return false;
+    }
+    alg_list_s *algs = &slot->value;
 
-            ct->table[index].algs.list[ct->table[index].algs.num_algs] = alg_static_copy(moves);
-            ct->table[index].algs.num_algs++;
+    if (inserted) {
+        algs->list = (alg_s*)malloc(sizeof(alg_s));
+        algs->num_algs = 0;
+        algs->size = 1;
+    } else if (algs->num_algs == algs->size) {
+        alg_s *tmp = realloc(algs->list, 2*sizeof(alg_s)*algs->size);
 
-            return true;
-        }
-
-        index++;
-        if (index == hash) {
+        if (!tmp) {
             return false;
         }
 
-        if (index >= ct->size) {
-            index = 0;
-        }
+        algs->list = tmp;
+        algs->size *=2;
     }
 
-
-    ct->table[index].key  = *key;
-
-    ct->entries++;
-
-    ct->table[index].algs.list = (alg_s*)malloc(sizeof(alg_s));
-    ct->table[index].algs.list[0] = alg_static_copy(moves);
-
-    ct->table[index].algs.num_algs = 1;
-    ct->table[index].algs.size = 1;
+    algs->list[algs->num_algs] = alg_static_copy(moves);
+    algs->num_algs++;
 
     return true;
 }
@@ -82,127 +56,285 @@ bool cube_table_insert_if_new(cube_table_s *ct, const shift_cube_s *key, const a
         return false;
     }
 
-    size_t hash = cube_table_hash(ct, key);
-    size_t index = hash;
-
-    // linear probing
-    while (ct->table[index].algs.list != NULL) {
-        if (compare_cubes(&(ct->table[index].key), key)) {
-            return false;
-        }
-
-        index++;
-        if (index == hash) {
-            return false;
-        }
-
-        if (index >= ct->size) {
-            index = 0;
-        }
+    bool inserted;
+    cube_map_slot_s *slot = cube_map_insert(&ct->map, key, &inserted);
+    if (!slot || !inserted) {
+        return false;
     }
 
+    slot->value.list = (alg_s*)malloc(sizeof(alg_s));
+    slot->value.list[0] = alg_static_copy(moves);
 
-    ct->table[index].key  = *key;
+    slot->value.num_algs = 1;
+    slot->value.size = 1;
 
-    ct->entries++;
+    return true;
+}
 
-    ct->table[index].algs.list = (alg_s*)malloc(sizeof(alg_s));
-    ct->table[index].algs.list[0] = alg_static_copy(moves);
+const alg_list_s* cube_table_lookup(const cube_table_s *ct, const shift_cube_s *cube) {
+    if (ct == NULL || cube == NULL || ct->image != NULL) {
+        return NULL;
+    }
 
-    ct->table[index].algs.num_algs = 1;
-    ct->table[index].algs.size = 1;
+    const cube_map_slot_s *slot = cube_map_find(&ct->map, cube);
+    return (slot == NULL) ? NULL : &slot->value;
+}
 
-    return true;
+static cube_table_algs_s cube_table_image_algs(const cube_table_s *ct, const cube_table_image_entry_s *entry) {
+    return (cube_table_algs_s) {
+        .num_algs = entry->num_algs,
+        .image_algs = &ct->image_algs[entry->first_alg],
+        .image_moves = ct->image_moves,
+    };
 }
 
-static inline size_t cube_table_get_cube_index(const cube_table_s *ct, const shift_cube_s *cube) {
+bool cube_table_get(const cube_table_s *ct, const shift_cube_s *cube, cube_table_algs_s *algs) {
     if (ct == NULL || cube == NULL) {
-        return ct->size;
+        return false;
     }
 
-    size_t hash = cube_table_hash(ct, cube);
-    size_t index = hash;
-
-    while (ct->table[index].algs.list != NULL) {
-        if (compare_cubes(&(ct->table[index].key), cube)) {
-            return index;
-        }
+    if (ct->image == NULL) {
+        const alg_list_s *list = cube_table_lookup(ct, cube);
+        if (list != NULL) *algs = (cube_table_algs_s) {.num_algs = list->num_algs, .list = list->list};
+        return list != NULL;
+    }
 
-        if (index + 1 == hash) {
-            break;
-        }
+    const cube_image_map_slot_s *slot = cube_image_map_find(&ct->image_map, cube);
+    if (slot == NULL) return false;
+    *algs = cube_table_image_algs(ct, &slot->value);
+    return true;
+}
 
-        index = (index + 1 >= ct->size) ? 0 : index + 1;
+// a copy of the alg, its moves still belong to the table
+alg_s cube_table_alg(const cube_table_algs_s *algs, size_t index) {
+    if (algs->list != NULL) {
+        return algs->list[index];
     }
 
-    return ct->size;
+    const cube_table_image_alg_s *image_alg = &algs->image_algs[index];
+    return (alg_s) {
+        .size = image_alg->length,
+        .length = image_alg->length,
+        .moves = (move_t*)&algs->image_moves[image_alg->moves_offset],
+    };
 }
 
-const alg_list_s* cube_table_lookup(const cube_table_s *ct, const shift_cube_s *cube) {
-    size_t index = cube_table_get_cube_index(ct, cube);
+// the key and algs in slot idx of either kind of table, false if it's unused
+static bool cube_table_slot(const cube_table_s *ct, size_t idx, shift_cube_s *key, cube_table_algs_s *algs) {
+    if (ct->image == NULL) {
+        if (!cube_map_slot_used(&ct->map, idx)) return false;
+        *key = ct->map.slots[idx].key;
+        *algs = (cube_table_algs_s) {
+            .num_algs = ct->map.slots[idx].value.num_algs,
+            .list = ct->map.slots[idx].value.list,
+        };
+        return true;
+    }
 
-    return (index == ct->size) ? NULL : &ct->table[index].algs;
+    if (!cube_image_map_slot_used(&ct->image_map, idx)) return false;
+    *key = ct->image_map.slots[idx].key;
+    *algs = cube_table_image_algs(ct, &ct->image_map.slots[idx].value);
+    return true;
 }
 
 void cube_table_clear(cube_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
+    if (ct == NULL || ct->map.slots == NULL || ct->image != NULL) {
         return;
     }
 
-    for (size_t index = 0; index < ct->size; index++) {
-        if (ct->table[index].algs.list != NULL) {
-            for (size_t i = 0; i < ct->table[index].algs.num_algs; i++) {
-                free(ct->table[index].algs.list[i].moves);
+    for (size_t index = 0; index < ct->map.capacity; index++) {
+        if (cube_map_slot_used(&ct->map, index)) {
+            alg_list_s *algs = &ct->map.slots[index].value;
+            for (size_t i = 0; i < algs->num_algs; i++) {
+                free(algs->list[i].moves);
             }
 
-            free(ct->table[index].algs.list);
-            ct->table[index].algs.list = NULL;
+            free(algs->list);
         }
     }
 
-    ct->entries = 0;
+    cube_map_clear(&ct->map);
 }
 
 void cube_table_free(cube_table_s *ct) {
-    if (ct == NULL || ct->table == NULL) {
-        free(ct);
+    if (ct == NULL) {
         return;
     }
 
-    cube_table_clear(ct);
+    // an image's slots and algs are only borrowed from the mapping
+    if (ct->image) {
+        table_image_unmap(ct->image);
+    } else {
+        cube_table_clear(ct);
+    }
 
-    free(ct->table);
+    cube_map_destroy(&ct->map);
     free(ct);
 }
 
 void cube_table_print(cube_table_s *ct) {
     printf("   index  |               cube string representation            | algorithm\n");
     printf("------------------------------------------------------------------------------\n");
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        if (ct->table[idx].algs.list != NULL) {
+    bool prev_used = false;
+    for (size_t idx = 0; idx < cube_table_size(ct); idx++) {
+        shift_cube_s key;
+        cube_table_algs_s algs;
+        bool used = cube_table_slot(ct, idx, &key, &algs);
+        if (used) {
+            alg_s alg = cube_table_alg(&algs, 0);
             printf("%10zu ", idx);
-            print_cube_line_colors(ct->table[idx].key);
-            print_alg(&ct->table[idx].algs.list[0]);
-        }
-
-        if (idx != 0) {
-            if (ct->table[idx].algs.list == NULL && ct->table[idx-1].algs.list != NULL) {
-                printf("                                    ...                                    \n");
-            }
+            print_cube_line_colors(key);
+            print_alg(&alg);
+        } else if (prev_used) {
+            printf("                                    ...                                    \n");
         }
+        prev_used = used;
     }
 }
 
 size_t cube_table_entries(const cube_table_s *ct) {
-    return ct->entries;
+    return ct->image ? ct->image_map.entries : ct->map.entries;
 }
 
 size_t cube_table_size(const cube_table_s *ct) {
-    return ct->size;
+    return ct->image ? ct->image_map.capacity : ct->map.capacity;
+}
+
+hash_table_stats_s cube_table_stats(const cube_table_s *ct) {
+    return ct->image ? cube_image_map_stats(&ct->image_map) : cube_map_stats(&ct->map);
 }
 
 void cube_table_print_algs(const cube_table_s *ct) {
-    for (size_t idx = 0; idx < ct->size; idx++) {
-        print_alg(&ct->table[idx].algs.list[0]);
+    for (size_t idx = 0; idx < cube_table_size(ct); idx++) {
+        shift_cube_s key;
+        cube_table_algs_s algs;
+        if (!cube_table_slot(ct, idx, &key, &algs)) continue;
+        alg_s alg = cube_table_alg(&algs, 0);
+        print_alg(&alg);
     }
-}
\ No newline at end of file
+}
+
+// the image is the table's groups and slots exactly as they are hashed, then
+// every alg's record in entry order, then their moves one byte each. The
+// records' moves offsets count from the start of the payload, so the moves
+// can be found without knowing how many records there are
+bool cube_table_write_image(const cube_table_s *ct, const char *path) {
+    size_t capacity = cube_table_size(ct);
+    shift_cube_s key;
+    cube_table_algs_s algs;
+
+    size_t num_algs = 0;
+    size_t num_moves = 0;
+    for (size_t idx = 0; idx < capacity; idx++) {
+        if (!cube_table_slot(ct, idx, &key, &algs)) continue;
+        num_algs += algs.num_algs;
+        for (size_t i = 0; i < algs.num_algs; i++) {
+            num_moves += cube_table_alg(&algs, i).length;
+        }
+    }
+
+    size_t groups_size = hash_table_groups_size(capacity);
+    size_t slots_size = capacity * sizeof(cube_image_map_slot_s);
+    size_t moves_start = groups_size + slots_size + num_algs * sizeof(cube_table_image_alg_s);
+    size_t payload_size = moves_start + num_moves;
+    uint8_t *payload = (uint8_t*)calloc(payload_size, 1);
+    cube_image_map_slot_s *slots = (cube_image_map_slot_s*)(payload + groups_size);
+    cube_table_image_alg_s *image_algs = (cube_table_image_alg_s*)(payload + groups_size + slots_size);
+
+    if (ct->image) {
+        cube_image_map_export_groups(&ct->image_map, (hash_table_group_s*)payload);
+    } else {
+        cube_map_export_groups(&ct->map, (hash_table_group_s*)payload);
+    }
+
+    size_t alg = 0;
+    size_t moves_offset = moves_start;
+    for (size_t idx = 0; idx < capacity; idx++) {
+        if (!cube_table_slot(ct, idx, &key, &algs)) continue;
+
+        slots[idx] = (cube_image_map_slot_s) {
+            .key = key,
+            .value = {.first_alg = alg, .num_algs = algs.num_algs},
+        };
+        for (size_t i = 0; i < algs.num_algs; i++) {
+            alg_s moves = cube_table_alg(&algs, i);
+            image_algs[alg++] = (cube_table_image_alg_s) {
+                .moves_offset = moves_offset,
+                .length = moves.length,
+            };
+            memcpy(&payload[moves_offset], moves.moves, moves.length);
+            moves_offset += moves.length;
+        }
+    }
+
+    bool written = table_image_write(path, TABLE_IMAGE_F2L, cube_table_entries(ct), capacity,
+                                     payload, payload_size);
+    free(payload);
+    return written;
+}
+
+// only the header was checked when the image was mapped, so every entry's algs
+// and their moves have to be checked to be inside the payload and the table has to
+// have room left for every probe to end, which keeps a corrupt image from being
+// read out of bounds
+static bool cube_image_valid(const table_image_s *image, const cube_image_map_s *map, size_t algs_start) {
+    size_t payload_size = image->header->payload_size;
+    const cube_table_image_alg_s *image_algs = (const cube_table_image_alg_s*)(image->payload + algs_start);
+    size_t max_algs = (payload_size - algs_start) / sizeof(cube_table_image_alg_s);
+
+    size_t entries = 0;
+    for (size_t idx = 0; idx < map->capacity; idx++) {
+        if (!cube_image_map_slot_used(map, idx)) continue;
+        const cube_table_image_entry_s *entry = &map->slots[idx].value;
+        if (entry->first_alg > max_algs || entry->num_algs > max_algs - entry->first_alg) {
+            return false;
+        }
+        for (size_t alg = entry->first_alg; alg < entry->first_alg + entry->num_algs; alg++) {
+            if (image_algs[alg].length > UINT8_MAX ||
+                !table_image_moves_valid(image, image_algs[alg].moves_offset, image_algs[alg].length)) {
+                return false;
+            }
+        }
+        entries++;
+    }
+    return entries == map->entries && entries <= map->capacity - map->capacity/8;
+}
+
+cube_table_s* cube_table_from_image(const char *path, const char *source_path) {
+    table_image_s *image = table_image_map(path, TABLE_IMAGE_F2L, &source_path, 1);
+    if (!image) {
+        return NULL;
+    }
+
+    size_t capacity = image->header->table_size;
+    size_t groups_size = hash_table_groups_size(capacity);
+    size_t slots_size = capacity * sizeof(cube_image_map_slot_s);
+    if (capacity < HASH_TABLE_GROUP_SIZE || (capacity & (capacity - 1)) ||
+        image->header->payload_size < groups_size + slots_size) {
+        table_image_unmap(image);
+        return NULL;
+    }
+
+    cube_image_map_s image_map;
+    cube_image_map_borrow(&image_map, (const hash_table_group_s*)image->payload,
+                          (const cube_image_map_slot_s*)(image->payload + groups_size),
+                          capacity, image->header->num_records);
+    if (!cube_image_valid(image, &image_map, groups_size + slots_size)) {
+        fprintf(stderr, "Ignoring corrupt table image %s\n", path);
+        table_image_unmap(image);
+        return NULL;
+    }
+
+    cube_table_s *ct = (cube_table_s*)malloc(sizeof(cube_table_s));
+    if (!ct) {
+        table_image_unmap(image);
+        return NULL;
+    }
+    ct->map = (cube_map_s) {0};
+    ct->image = image;
+    ct->image_map = image_map;
+    ct->image_algs = (const cube_table_image_alg_s*)(image->payload + groups_size + slots_size);
+    ct->image_moves = image->payload;
+
+    return ct;
+}
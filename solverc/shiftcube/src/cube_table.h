@@ -6,24 +6,52 @@
 
 #include "main.h"
 #include "alg.h"
+#include "hash_table.h"
 #include "shift_cube.h"
+#include "table_image.h"
+
+HASH_TABLE_DEFINE(cube_map, shift_cube_s, alg_list_s, compare_cubes)
+
+// a table image stores its slots as they are, so each entry is a run of alg
+// records after the slots, and each alg an offset to its moves
+typedef struct {
+    uint32_t first_alg;
+    uint32_t num_algs;
+} cube_table_image_entry_s;
 
 typedef struct {
-    shift_cube_s key;
-    alg_list_s algs;
-} entry_s;
+    uint32_t moves_offset;
+    uint32_t length;
+} cube_table_image_alg_s;
+
+HASH_TABLE_DEFINE(cube_image_map, shift_cube_s, cube_table_image_entry_s, compare_cubes)
 
 typedef struct cube_table {
-    size_t entries;
-    size_t size;
+    cube_map_s map;
 
-    entry_s *table;
+    // non-NULL when the table is a mapped table image, which makes it read
+    // only. image_map borrows the image's slots and map is left empty
+    table_image_s *image;
+    cube_image_map_s image_map;
+    const cube_table_image_alg_s *image_algs;
+    const move_t *image_moves;
 } cube_table_s;
 
-cube_table_s* cube_table_create(size_t size);
+// an entry's algs from either kind of table, cube_table_alg gets one of them
+typedef struct {
+    size_t num_algs;
+    const alg_s *list;
+    const cube_table_image_alg_s *image_algs;
+    const move_t *image_moves;
+} cube_table_algs_s;
+
+cube_table_s* cube_table_create(size_t num_entries);
 bool cube_table_insert(cube_table_s *ct, const shift_cube_s *key, const alg_s *moves);
 bool cube_table_insert_if_new(cube_table_s *ct, const shift_cube_s *key, const alg_s *moves);
+// only finds algs in tables built in memory, tables loaded from an image need cube_table_get
 const alg_list_s* cube_table_lookup(const cube_table_s *ct, const shift_cube_s *cube);
+bool cube_table_get(const cube_table_s *ct, const shift_cube_s *cube, cube_table_algs_s *algs);
+alg_s cube_table_alg(const cube_table_algs_s *algs, size_t index);
 void cube_table_free(cube_table_s *ct);
 void cube_table_clear(cube_table_s *ct);
 void cube_table_print(cube_table_s *ct);
@@ -31,5 +59,9 @@ void cube_table_print_algs(const cube_table_s *ct);
 
 size_t cube_table_entries(const cube_table_s *ct);
 size_t cube_table_size(const cube_table_s *ct);
+hash_table_stats_s cube_table_stats(const cube_table_s *ct);
+
+bool cube_table_write_image(const cube_table_s *ct, const char *path);
+cube_table_s* cube_table_from_image(const char *path, const char *source_path);
 
 #endif // CUBE_TABLE_H
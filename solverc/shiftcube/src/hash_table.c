@@ -0,0 +1,14 @@
+#include "hash_table.h"
+
+void hash_table_print_stats(const char *name, const hash_table_stats_s *stats) {
+    printf("%s: %zu entries in %zu slots (%.1f%% full), %.3f groups probed on average, %zu at most\n",
+           name, stats->entries, stats->capacity,
+           stats->capacity ? 100.0 * stats->entries / stats->capacity : 0.0,
+           stats->mean_probe, stats->max_probe);
+
+    printf("    probe length:");
+    for (size_t probes = 0; probes < HASH_TABLE_PROBE_HISTOGRAM; probes++) {
+        printf(" %zu%s:%zu", probes + 1, probes + 1 == HASH_TABLE_PROBE_HISTOGRAM ? "+" : "", stats->histogram[probes]);
+    }
+    printf("\n");
+}
@@ -0,0 +1,368 @@
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include "main.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// The open addressing table every cube keyed table is built on. Each slot has a
+// metadata byte, HASH_TABLE_EMPTY or the top 7 bits of its key's hash, and slots
+// are probed a group of 16 at a time by comparing those bytes all at once, so a
+// key is only compared when its 7 bits already match. The capacity is a power
+// of two and the table doubles whenever an insert would leave it more than
+// 7/8 full, so inserting never fails for lack of room.
+//
+// Every group also remembers the generation it was last written in. Clearing
+// starts a new generation, which makes every group read as empty without
+// touching it, and a stale group is wiped the first time a key lands in it.
+//
+// HASH_TABLE_DEFINE(name, key_type, value_type, key_equal) instantiates
+// name_s and its functions, where key_equal compares two const key_type* and
+// the hash covers every byte of key_type, so keys can't have padding.
+// HASH_TABLE_DEFINE_HASHED takes a key_hash(const key_type*) instead, for
+// keys whose callers keep their hash up to date themselves and pass it to
+// name_find_hashed and name_insert_hashed.
+// Pointers to values stay valid until the next insert of a new key.
+//
+// name_export_groups and name_borrow let a table be written out as its groups
+// followed by its slots and then used in place, say from a mapped file, as
+// long as nothing inserts into, clears or destroys the borrowed table.
+
+#define HASH_TABLE_GROUP_SIZE 16
+#define HASH_TABLE_EMPTY 0x80
+
+#define HASH_TABLE_PROBE_HISTOGRAM 8
+
+// a group's metadata and generation share a cache line, so a lookup that
+// misses only ever touches the one line
+typedef struct {
+    uint8_t meta[HASH_TABLE_GROUP_SIZE];
+    uint32_t generation;
+    uint8_t padding[12];
+} hash_table_group_s;
+
+typedef struct {
+    size_t entries;
+    size_t capacity;
+    size_t max_probe;  // groups looked at to find the hardest to find key
+    double mean_probe; // groups looked at to find a key, on average
+    // keys found at each probe length from 1 group up, the last counts every longer probe too
+    size_t histogram[HASH_TABLE_PROBE_HISTOGRAM];
+} hash_table_stats_s;
+
+void hash_table_print_stats(const char *name, const hash_table_stats_s *stats);
+
+// the smallest capacity that holds num_entries without growing
+static inline size_t hash_table_capacity_for(size_t num_entries) {
+    size_t capacity = HASH_TABLE_GROUP_SIZE;
+    while (capacity - capacity/8 < num_entries) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+static inline size_t hash_table_groups_size(size_t capacity) {
+    return capacity / HASH_TABLE_GROUP_SIZE * sizeof(hash_table_group_s);
+}
+
+static inline uint64_t hash_table_hash(const void *key, size_t size) {
+    const uint8_t *bytes = key;
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ size;
+
+    while (size > 0) {
+        uint64_t word = 0;
+        size_t chunk = size < sizeof(word) ? size : sizeof(word);
+        memcpy(&word, bytes, chunk);
+        hash = (hash ^ word) * 0xbf58476d1ce4e5b9ull;
+        hash ^= hash >> 31;
+        bytes += chunk;
+        size  -= chunk;
+    }
+
+    // murmur3's finalizer, every input bit reaches both the tag and the group
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static inline uint8_t hash_table_tag(uint64_t hash) {
+    return hash >> 57;
+}
+
+#if !defined(__SSE2__) && !(defined(__aarch64__) && defined(__ARM_NEON))
+// one bit per byte of word whose top bit is set, in byte order
+static inline uint32_t hash_table_top_bits(uint64_t word) {
+    return (((word & 0x8080808080808080ull) >> 7) * 0x0102040810204080ull) >> 56;
+}
+#endif
+
+// bit i is set when slot i of the group has the metadata byte tag. Without
+// SIMD a byte right above a match can show up as a false positive, which only
+// costs a key comparison
+static inline uint32_t hash_table_group_match(const uint8_t *group, uint8_t tag) {
+#if defined(__SSE2__)
+    __m128i meta = _mm_loadu_si128((const __m128i*)group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(meta, _mm_set1_epi8(tag)));
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    static const uint8_t lane_bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t matches = vandq_u8(vceqq_u8(vld1q_u8(group), vdupq_n_u8(tag)), vld1q_u8(lane_bits));
+    return vaddv_u8(vget_low_u8(matches)) | ((uint32_t)vaddv_u8(vget_high_u8(matches)) << 8);
+#else
+    uint32_t mask = 0;
+    for (size_t half = 0; half < 2; half++) {
+        uint64_t word;
+        memcpy(&word, group + 8*half, sizeof(word));
+        word ^= 0x0101010101010101ull * tag;
+        mask |= hash_table_top_bits((word - 0x0101010101010101ull) & ~word) << (8*half);
+    }
+    return mask;
+#endif
+}
+
+// bit i is set when slot i of the group is empty, tags never have the top bit set
+static inline uint32_t hash_table_group_match_empty(const uint8_t *group) {
+#if defined(__SSE2__)
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    return hash_table_group_match(group, HASH_TABLE_EMPTY);
+#else
+    uint32_t mask = 0;
+    for (size_t half = 0; half < 2; half++) {
+        uint64_t word;
+        memcpy(&word, group + 8*half, sizeof(word));
+        mask |= hash_table_top_bits(word) << (8*half);
+    }
+    return mask;
+#endif
+}
+
+#define HASH_TABLE_ALL_SLOTS ((1u << HASH_TABLE_GROUP_SIZE) - 1)
+
+#define HASH_TABLE_DEFINE(name, key_type, value_type, key_equal)                                    \
+static inline uint64_t name##_key_hash(const key_type *key) {                                       \
+    return hash_table_hash(key, sizeof(key_type));                                                  \
+}                                                                                                   \
+HASH_TABLE_DEFINE_HASHED(name, key_type, value_type, key_equal, name##_key_hash)
+
+#define HASH_TABLE_DEFINE_HASHED(name, key_type, value_type, key_equal, key_hash)                   \
+typedef struct {                                                                                    \
+    key_type key;                                                                                   \
+    value_type value;                                                                               \
+} name##_slot_s;                                                                                    \
+                                                                                                    \
+typedef struct name {                                                                               \
+    size_t entries;                                                                                 \
+    size_t capacity;                                                                                \
+    size_t max_entries;                                                                             \
+    uint32_t generation;                                                                            \
+                                                                                                    \
+    void *group_memory; /* groups is this aligned to a group */                                     \
+    hash_table_group_s *groups;                                                                     \
+    name##_slot_s *slots;                                                                           \
+} name##_s;                                                                                         \
+                                                                                                    \
+static inline void name##_destroy(name##_s *t) {                                                    \
+    free(t->group_memory);                                                                          \
+    free(t->slots);                                                                                 \
+    t->group_memory = NULL;                                                                         \
+    t->groups = NULL;                                                                               \
+    t->slots = NULL;                                                                                \
+}                                                                                                   \
+                                                                                                    \
+static inline bool name##_init(name##_s *t, size_t num_entries) {                                   \
+    size_t capacity = hash_table_capacity_for(num_entries);                                         \
+    /* every group starts out stale, so none of the slots need initialising */                      \
+    size_t num_groups = capacity / HASH_TABLE_GROUP_SIZE;                                           \
+    t->group_memory = calloc(num_groups + 1, sizeof(hash_table_group_s));                           \
+    t->groups = (hash_table_group_s*)(((uintptr_t)t->group_memory + sizeof(hash_table_group_s) - 1) & \
+                                      ~(uintptr_t)(sizeof(hash_table_group_s) - 1));                \
+    t->slots = (name##_slot_s*)malloc(capacity * sizeof(name##_slot_s));                            \
+    t->entries     = 0;                                                                             \
+    t->capacity    = capacity;                                                                      \
+    t->max_entries = capacity - capacity/8;                                                         \
+    t->generation  = 1;                                                                             \
+    if (!t->group_memory || !t->slots) {                                                            \
+        name##_destroy(t);                                                                          \
+        return false;                                                                               \
+    }                                                                                               \
+    return true;                                                                                    \
+}                                                                                                   \
+                                                                                                    \
+static inline bool name##_group_live(const name##_s *t, size_t group) {                             \
+    return t->groups[group].generation == t->generation;                                            \
+}                                                                                                   \
+                                                                                                    \
+static inline bool name##_slot_used(const name##_s *t, size_t index) {                              \
+    const hash_table_group_s *group = &t->groups[index / HASH_TABLE_GROUP_SIZE];                    \
+    return group->generation == t->generation &&                                                    \
+           group->meta[index % HASH_TABLE_GROUP_SIZE] != HASH_TABLE_EMPTY;                          \
+}                                                                                                   \
+                                                                                                    \
+static inline name##_slot_s* name##_find_hashed(const name##_s *t, const key_type *key, uint64_t hash) { \
+    uint8_t tag = hash_table_tag(hash);                                                             \
+    size_t group_mask = t->capacity / HASH_TABLE_GROUP_SIZE - 1;                                    \
+    size_t group = hash & group_mask;                                                               \
+                                                                                                    \
+    /* triangular steps visit every group of a power of two table */                                \
+    for (size_t step = 1; name##_group_live(t, group); step++) {                                    \
+        const uint8_t *meta = t->groups[group].meta;                                                \
+        for (uint32_t match = hash_table_group_match(meta, tag); match; match &= match - 1) {       \
+            name##_slot_s *slot = &t->slots[group * HASH_TABLE_GROUP_SIZE + __builtin_ctz(match)];  \
+            if (key_equal(&slot->key, key)) {                                                       \
+                return slot;                                                                        \
+            }                                                                                       \
+        }                                                                                           \
+        if (hash_table_group_match_empty(meta)) {                                                   \
+            break;                                                                                  \
+        }                                                                                           \
+        group = (group + step) & group_mask;                                                        \
+    }                                                                                               \
+    return NULL;                                                                                    \
+}                                                                                                   \
+                                                                                                    \
+static inline name##_slot_s* name##_find(const name##_s *t, const key_type *key) {                  \
+    return name##_find_hashed(t, key, key_hash(key));                                               \
+}                                                                                                   \
+                                                                                                    \
+/* the first free slot on the probe sequence of hash, whose key isn't in the table */               \
+static inline name##_slot_s* name##_claim(name##_s *t, uint64_t hash) {                             \
+    size_t group_mask = t->capacity / HASH_TABLE_GROUP_SIZE - 1;                                    \
+    size_t group = hash & group_mask;                                                               \
+                                                                                                    \
+    for (size_t step = 1; ; step++) {                                                               \
+        uint8_t *meta = t->groups[group].meta;                                                      \
+        uint32_t empty = HASH_TABLE_ALL_SLOTS;                                                      \
+        if (name##_group_live(t, group)) {                                                          \
+            empty = hash_table_group_match_empty(meta);                                             \
+        } else {                                                                                    \
+            memset(meta, HASH_TABLE_EMPTY, HASH_TABLE_GROUP_SIZE);                                  \
+            t->groups[group].generation = t->generation;                                            \
+        }                                                                                           \
+                                                                                                    \
+        if (empty) {                                                                                \
+            size_t index = group * HASH_TABLE_GROUP_SIZE + __builtin_ctz(empty);                    \
+            meta[index % HASH_TABLE_GROUP_SIZE] = hash_table_tag(hash);                             \
+            t->entries++;                                                                           \
+            return &t->slots[index];                                                                \
+        }                                                                                           \
+        group = (group + step) & group_mask;                                                        \
+    }                                                                                               \
+}                                                                                                   \
+                                                                                                    \
+/* makes room for num_entries without growing again, false if that didn't fit */                    \
+static inline bool name##_reserve(name##_s *t, size_t num_entries) {                                \
+    if (num_entries <= t->max_entries) {                                                            \
+        return true;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    name##_s bigger;                                                                                \
+    if (!name##_init(&bigger, num_entries)) {                                                       \
+        return false;                                                                               \
+    }                                                                                               \
+                                                                                                    \
+    for (size_t index = 0; index < t->capacity; index++) {                                          \
+        if (name##_slot_used(t, index)) {                                                           \
+            uint64_t hash = key_hash(&t->slots[index].key);                                         \
+            *name##_claim(&bigger, hash) = t->slots[index];                                         \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    name##_destroy(t);                                                                              \
+    *t = bigger;                                                                                    \
+    return true;                                                                                    \
+}                                                                                                   \
+                                                                                                    \
+/* the slot holding key, which is added if it's new and then has to have its */                     \
+/* value filled in, *inserted says which. NULL if the table couldn't grow */                        \
+static inline name##_slot_s* name##_insert_hashed(name##_s *t, const key_type *key, uint64_t hash,  \
+                                                 bool *inserted) {                                  \
+    name##_slot_s *slot = name##_find_hashed(t, key, hash);                                         \
+    if (slot) {                                                                                     \
+        *inserted = false;                                                                          \
+        return slot;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    if (t->entries >= t->max_entries && !name##_reserve(t, 2*t->max_entries)) {                     \
+        return NULL;                                                                                \
+    }                                                                                               \
+                                                                                                    \
+    slot = name##_claim(t, hash);                                                                   \
+    slot->key = *key;                                                                               \
+    *inserted = true;                                                                               \
+    return slot;                                                                                    \
+}                                                                                                   \
+                                                                                                    \
+static inline name##_slot_s* name##_insert(name##_s *t, const key_type *key, bool *inserted) {      \
+    return name##_insert_hashed(t, key, key_hash(key), inserted);                                   \
+}                                                                                                   \
+                                                                                                    \
+static inline void name##_clear(name##_s *t) {                                                      \
+    /* only once every 4 billion clears does a group's stale generation come back around */         \
+    if (++t->generation == 0) {                                                                     \
+        for (size_t group = 0; group < t->capacity / HASH_TABLE_GROUP_SIZE; group++) {              \
+            t->groups[group].generation = 0;                                                        \
+        }                                                                                           \
+        t->generation = 1;                                                                          \
+    }                                                                                               \
+    t->entries = 0;                                                                                 \
+}                                                                                                   \
+                                                                                                    \
+/* copies the groups so that every group is live in generation 1 and the stale */                   \
+/* ones are empty, which is what name_borrow expects */                                             \
+static inline void name##_export_groups(const name##_s *t, hash_table_group_s *groups) {            \
+    for (size_t group = 0; group < t->capacity / HASH_TABLE_GROUP_SIZE; group++) {                  \
+        groups[group] = (hash_table_group_s) {.generation = 1};                                     \
+        if (name##_group_live(t, group)) {                                                          \
+            memcpy(groups[group].meta, t->groups[group].meta, HASH_TABLE_GROUP_SIZE);               \
+        } else {                                                                                    \
+            memset(groups[group].meta, HASH_TABLE_EMPTY, HASH_TABLE_GROUP_SIZE);                    \
+        }                                                                                           \
+    }                                                                                               \
+}                                                                                                   \
+                                                                                                    \
+/* a read only table over exported groups and the slots that go with them */                        \
+static inline void name##_borrow(name##_s *t, const hash_table_group_s *groups,                     \
+                                 const name##_slot_s *slots, size_t capacity, size_t entries) {     \
+    t->entries      = entries;                                                                      \
+    t->capacity     = capacity;                                                                     \
+    t->max_entries  = entries;                                                                      \
+    t->generation   = 1;                                                                            \
+    t->group_memory = NULL;                                                                         \
+    t->groups       = (hash_table_group_s*)groups;                                                  \
+    t->slots        = (name##_slot_s*)slots;                                                        \
+}                                                                                                   \
+                                                                                                    \
+/* walks every key's probe sequence again, so it costs about a lookup per entry */                  \
+static inline hash_table_stats_s name##_stats(const name##_s *t) {                                  \
+    hash_table_stats_s stats = {.entries = t->entries, .capacity = t->capacity};                    \
+    size_t group_mask = t->capacity / HASH_TABLE_GROUP_SIZE - 1;                                    \
+    size_t total_probes = 0;                                                                        \
+                                                                                                    \
+    for (size_t index = 0; index < t->capacity; index++) {                                          \
+        if (!name##_slot_used(t, index)) continue;                                                  \
+                                                                                                    \
+        uint64_t hash = key_hash(&t->slots[index].key);                                             \
+        size_t group = hash & group_mask;                                                           \
+        size_t probes = 1;                                                                          \
+        while (group != index / HASH_TABLE_GROUP_SIZE) {                                            \
+            group = (group + probes) & group_mask;                                                  \
+            probes++;                                                                               \
+        }                                                                                           \
+                                                                                                    \
+        total_probes += probes;                                                                     \
+        if (probes > stats.max_probe) stats.max_probe = probes;                                     \
+        stats.histogram[(probes < HASH_TABLE_PROBE_HISTOGRAM ? probes : HASH_TABLE_PROBE_HISTOGRAM) - 1]++; \
+    }                                                                                               \
+                                                                                                    \
+    stats.mean_probe = t->entries ? (double)total_probes / t->entries : 0.0;                        \
+    return stats;                                                                                   \
+}
+
+#endif // HASH_TABLE_H
@@ -1,11 +1,16 @@
+#define _GNU_SOURCE
 #include "main.h"
 #include "alg.h"
 #include "servoCoder.h"
 #include "shift_cube.h"
 #include "solver.h"
+#include "table_image.h"
 #include "tests.h"
 
+#include <pthread.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 typedef enum input {
     INPUT_SCRAMBLE,
@@ -16,15 +21,31 @@ typedef enum input {
 typedef enum output {
     OUTPUT_ALG,
     OUTPUT_SERVOCODE,
+    OUTPUT_SERVOSTREAM,
     NUM_OUTPUTS,
 } output_e;
 
 #define help_str \
     "Usage: ./solver [OPTION]... INPUT...\n" \
+    "  or:  ./solver --server [OPTION]...\n" \
+    "  or:  ./solver --batch [FILE] [OPTION]...\n" \
     "Solve input as scramble algorithm or from a valid shiftcube state.\n" \
     "\n" \
     "  -i, --input      specify input mode, either scramble or shiftcube\n" \
-    "  -o, --output     specify output mode, either alg or servocode\n" \
+    "  -o, --output     specify output mode, either alg, servocode or servostream\n" \
+    "  -s, --server     load the tables once then solve one request per line of stdin\n" \
+    "  -b, --batch      solve every line of FILE, or stdin without FILE, on parallel workers\n" \
+    "  -j, --jobs       number of batch workers, defaults to one per core\n" \
+    "  -k, --candidates keep up to K distinct solutions and output the one whose servocode\n" \
+    "                   runs fastest, defaults to 1. Only servocode output compares them\n" \
+    "      --slack      moves longer than the shortest solution a candidate may be, defaults to 2\n" \
+    "  -d, --deadline   give each solve MS milliseconds, then use the best solution found by\n" \
+    "                   then. Defaults to no deadline, solving always waits for a first solution\n" \
+    "      --log-improvements  print each shorter solution a solve finds and when to stderr\n" \
+    "      --compile-tables  compile the text tables into binary images that load\n" \
+    "                   faster, rerun after changing any of the text tables\n" \
+    "      --verify-tables  check every table image against its checksum then exit, loading\n" \
+    "                   only checks their headers\n" \
     "      --help       show this message then exit\n" \
     "\n" \
     "Inputs:\n" \
@@ -33,14 +54,576 @@ typedef enum output {
     "Outputs:\n" \
     "  alg              prints the solution as an algorithm.\n" \
     "  servocode        print converted solution in servocode.\n" \
+    "  servostream      print the servocode in 'chunk: <servocode>' lines as it is found, the\n" \
+    "                   xcross first, then 'done'. Not available in batch mode\n" \
+    "\n" \
+    "Server mode:\n" \
+    "  Each line of stdin is a request of the form '[-i INPUT] [-o OUTPUT] INPUT...', where\n" \
+    "  -i and -o default to the options the server was started with. Each request is answered\n" \
+    "  with exactly one line, either the solution or a line starting with 'error:', apart from\n" \
+    "  servostream requests whose chunks come first. An empty line, 'quit' or end of input\n" \
+    "  stops the server.\n" \
+    "\n" \
+    "Batch mode:\n" \
+    "  Lines take the same form as server requests. Every line is answered in input order\n" \
+    "  with '<milliseconds> <result>', the time the line took to solve followed by what server\n" \
+    "  mode would print. Throughput is reported on stderr once the input runs out.\n" \
     "\n" \
     "Examples:\n" \
     "./solver -i scramble -o servocode \"F U2 R3\"  Apply the input scramble to a cube then output solution as servocode\n" \
-    "./solver -o alg \"F2 B2 R2 L2 U2 D2\"          Apply the algorithm to a cube then output solution alg.\n"
+    "./solver -o alg \"F2 B2 R2 L2 U2 D2\"          Apply the algorithm to a cube then output solution alg.\n" \
+    "./solver -s -i shiftcube -o servocode       Serve shiftcube solves as servocode on stdin/stdout.\n" \
+    "./solver -b scrambles.txt -j 4              Solve every scramble in scrambles.txt on 4 workers.\n" \
+    "./solver -k 8 -o servocode \"F U2 R3\"       Output the fastest servocode of up to 8 solutions.\n" \
+    "./solver -d 50 --log-improvements \"F U2 R3\" Output the best solution found within 50ms.\n" \
+    "./solver -s -i shiftcube -o servostream     Serve servocode in chunks the robot can start on early.\n"
+
+// maximum number of whitespace separated words in one server request
+#define MAX_REQUEST_WORDS 64
+// how many lines batch mode may have in flight ahead of the next one to print
+#define BATCH_WINDOW 256
+// how many alg sections a streamed servocode chunk commits to, and how many it
+// looks at to decide how to leave the last of them
+#define STREAM_CHUNK_SECTIONS 6
+#define STREAM_WINDOW_SECTIONS 12
+
+typedef struct {
+    cube_table_s *f2l_table;
+    cube_alg_table_s *ll_table;
+    inter_move_table_s *inter_move_table;
+} solver_tables_s;
+
+// how every solver context is set up, from the command line
+typedef struct {
+    uint8_t max_candidates;
+    uint8_t length_slack;
+    uint32_t deadline_ms;
+    bool log_improvements;
+} solver_options_s;
+
+// the outcome of one solve, kept apart from printing so batch mode can print
+// results in input order no matter which worker finished first
+typedef struct {
+    output_e output;
+    alg_s *solve;               // NULL if the request failed
+    RobotSolution servo_code;
+    char error[96];
+} request_result_s;
+
+// handles -i and -o at argv[*i], returns 1 if one was consumed and 0 if argv[*i]
+// isn't an input/output option. If the option is invalid -1 is returned and
+// error is pointed at a description of the problem
+static int parse_io_option(int argc, char *argv[], size_t *i, input_e *input, output_e *output,
+                           const char **error) {
+    if (!strcmp("-i", argv[*i]) || !strcmp("--input", argv[*i])) {
+        if (++*i == argc) {
+            *error = "Input option not provided.";
+            return -1;
+        }
+        if (!strcmp("scramble", argv[*i])) {
+            *input = INPUT_SCRAMBLE;
+        } else if (!strcmp("shiftcube", argv[*i])) {
+            *input = INPUT_SHIFTCUBE;
+        } else {
+            *error = "Invalid input option provided.";
+            return -1;
+        }
+        return 1;
+    } else if (!strcmp("-o", argv[*i]) || !strcmp("--output", argv[*i])) {
+        if (++*i == argc) {
+            *error = "Output option not provided.";
+            return -1;
+        }
+        if (!strcmp("alg", argv[*i])) {
+            *output = OUTPUT_ALG;
+        } else if (!strcmp("servocode", argv[*i])) {
+            *output = OUTPUT_SERVOCODE;
+        } else if (!strcmp("servostream", argv[*i])) {
+            *output = OUTPUT_SERVOSTREAM;
+        } else {
+            *error = "Invalid output option provided.";
+            return -1;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+static solver_ctx_s* create_solver_ctx(const solver_tables_s *tables, const solver_options_s *options) {
+    solver_ctx_s *ctx = solver_ctx_create(tables->f2l_table, tables->ll_table);
+    if (!ctx) {
+        return NULL;
+    }
+    if (!solver_ctx_set_candidates(ctx, options->max_candidates, options->length_slack)) {
+        solver_ctx_free(ctx);
+        return NULL;
+    }
+    solver_ctx_set_deadline(ctx, options->deadline_ms);
+    solver_ctx_log_improvements(ctx, options->log_improvements ? stderr : NULL);
+    return ctx;
+}
+
+// fills cube from the 6 hexadecimal faces, returns the first face that isn't
+// a valid shiftcube face or FACE_NULL if they all were
+static face_e cube_from_faces(char *faces[NUM_FACES], shift_cube_s *cube) {
+    for (face_e face = FACE_U; face < NUM_FACES; face++) {
+        char *end_ptr;
+        uint32_t face_data = strtoul(faces[face], &end_ptr, 16);
+        if (faces[face] == end_ptr || face_data > SOLVED_FACE_D) {
+            return face;
+        }
+        cube->state[face] = face_data;
+    }
+    return FACE_NULL;
+}
+
+typedef struct {
+    const alg_s *solve;
+    const inter_move_table_s *inter_move_table;
+    RobotSolution servo_code;
+} servo_job_s;
+
+static void* compile_servo_job(void *arg) {
+    servo_job_s *job = (servo_job_s*)arg;
+    job->servo_code = servoCode_compiler_layered(job->solve, job->inter_move_table);
+    return NULL;
+}
+
+// compiles every candidate, each on its own thread apart from the first which
+// the calling thread takes, and returns the one the robot runs fastest
+static size_t fastest_servo_code(alg_s **candidates, size_t num_candidates,
+                                 const inter_move_table_s *inter_move_table, RobotSolution *servo_codes) {
+    servo_job_s jobs[num_candidates];
+    pthread_t threads[num_candidates];
+    bool threaded[num_candidates];
+    for (size_t i = 0; i < num_candidates; i++) {
+        jobs[i] = (servo_job_s) {candidates[i], inter_move_table, {NULL, 0}};
+        threaded[i] = (i > 0 && !pthread_create(&threads[i], NULL, compile_servo_job, &jobs[i]));
+    }
+    for (size_t i = 0; i < num_candidates; i++) {
+        if (!threaded[i]) {
+            compile_servo_job(&jobs[i]);
+        }
+    }
+
+    size_t fastest = 0;
+    for (size_t i = 0; i < num_candidates; i++) {
+        if (threaded[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        servo_codes[i] = jobs[i].servo_code;
+        if (servo_codes[i].duration < servo_codes[fastest].duration) {
+            fastest = i;
+        }
+    }
+    return fastest;
+}
+
+static void print_servo_code(RobotSolution servo_code) {
+    for (size_t i = 0; i < servo_code.size; i++) {
+        RobotState_s state = servo_code.solution[i];
+        print_RobotState(state); printf(" ");
+    } printf("\n");
+}
+
+// prints every chunk stream has ready, each is flushed straight away so the robot
+// can get going on it
+static void print_servo_chunks(servo_stream_s *stream, uint8_t chunk_sections, uint8_t window_sections) {
+    RobotSolution chunk = servo_stream_next(stream, chunk_sections, window_sections);
+    while (chunk.solution) {
+        printf("chunk: ");
+        print_servo_code(chunk);
+        fflush(stdout);
+        free(chunk.solution);
+        chunk = servo_stream_next(stream, chunk_sections, window_sections);
+    }
+}
+
+// solves cube the way solve_into_result does but prints the xcross's servocode as
+// soon as it's found, before the rest of the solve is searched for. The rest follows
+// in chunks and result is left with the whole solve
+static void stream_into_result(shift_cube_s cube, solver_tables_s *tables, solver_ctx_s *ctx,
+                               request_result_s *result) {
+    result->solve = NULL;
+    if (!tables->inter_move_table) {
+        tables->inter_move_table = inter_move_table_load();
+    }
+    servo_stream_s *stream = servo_stream_create(tables->inter_move_table);
+    if (!stream) {
+        snprintf(result->error, sizeof(result->error), "Failed to start a servocode stream.");
+        return;
+    }
+
+    alg_s *solve = solve_cube_xcross(ctx, cube);
+    if (!solve || !servo_stream_feed(stream, solve)) {
+        alg_free(solve);
+        servo_stream_free(stream);
+        snprintf(result->error, sizeof(result->error), "Failed to find a solution, cube was probably invalid.");
+        return;
+    }
+    // the xcross is committed as a whole, there's nothing after it to look ahead to yet
+    print_servo_chunks(stream, UINT8_MAX, UINT8_MAX);
+
+    apply_alg(&cube, solve);
+    alg_s *rest = solve_cube_from_xcross(ctx, cube);
+    if (!rest || !servo_stream_feed(stream, rest)) {
+        alg_free(rest);
+        alg_free(solve);
+        servo_stream_free(stream);
+        snprintf(result->error, sizeof(result->error), "Failed to find a solution after the xcross.");
+        return;
+    }
+    print_servo_chunks(stream, STREAM_CHUNK_SECTIONS, STREAM_WINDOW_SECTIONS);
+
+    alg_concat(solve, rest);
+    alg_free(rest);
+    servo_stream_free(stream);
+    result->solve = solve;
+}
+
+// solves cube into result, compiling it to servocode if that was requested. With
+// more than one candidate the one with the fastest servocode is kept
+static void solve_into_result(shift_cube_s cube, output_e output, solver_tables_s *tables,
+                              solver_ctx_s *ctx, request_result_s *result) {
+    result->output = output;
+    result->servo_code = (RobotSolution) {NULL, 0};
+    if (output == OUTPUT_SERVOSTREAM) {
+        stream_into_result(cube, tables, ctx, result);
+        return;
+    }
+    alg_s *candidates[SOLVER_MAX_CANDIDATES];
+    size_t num_candidates = solve_cube_candidates(ctx, cube, candidates);
+    if (num_candidates == 0) {
+        result->solve = NULL;
+        snprintf(result->error, sizeof(result->error), "Failed to find a solution, cube was probably invalid.");
+        return;
+    }
+
+    size_t chosen = 0;
+    if (output == OUTPUT_SERVOCODE) {
+        // servocode is only loaded on the first request that needs it, unless
+        // the server or batch already loaded it up front
+        if (!tables->inter_move_table) {
+            tables->inter_move_table = inter_move_table_load();
+        }
+        RobotSolution servo_codes[num_candidates];
+        chosen = fastest_servo_code(candidates, num_candidates, tables->inter_move_table, servo_codes);
+        result->servo_code = servo_codes[chosen];
+        for (size_t i = 0; i < num_candidates; i++) {
+            if (i != chosen) free(servo_codes[i].solution);
+        }
+    }
+
+    result->solve = candidates[chosen];
+    for (size_t i = 0; i < num_candidates; i++) {
+        if (i != chosen) alg_free(candidates[i]);
+    }
+}
+
+// prints the solution in the requested output on a single line
+static void print_result(const request_result_s *result) {
+    if (!result->solve) {
+        printf("error: %s\n", result->error);
+    } else if (result->output == OUTPUT_ALG) {
+        print_alg(result->solve);
+    } else if (result->output == OUTPUT_SERVOCODE) {
+        print_servo_code(result->servo_code);
+    } else if (result->output == OUTPUT_SERVOSTREAM) {
+        // the chunks are already out
+        printf("done\n");
+    }
+}
+
+static void free_result(request_result_s *result) {
+    alg_free(result->solve);
+    free(result->servo_code.solution);
+    result->solve = NULL;
+    result->servo_code = (RobotSolution) {NULL, 0};
+}
+
+// handles a single server or batch request line using input and output unless
+// the line overrides them. Batch mode prints whole lines out of its workers, so
+// it passes can_stream as false
+static void solve_request(char *line, input_e input, output_e output, bool can_stream, solver_tables_s *tables,
+                          solver_ctx_s *ctx, request_result_s *result) {
+    result->solve = NULL;
+    result->servo_code = (RobotSolution) {NULL, 0};
+
+    char *words[MAX_REQUEST_WORDS];
+    size_t num_words = 0;
+    char *save_ptr;
+    for (char *word = strtok_r(line, " \t\r\n", &save_ptr); word; word = strtok_r(NULL, " \t\r\n", &save_ptr)) {
+        if (num_words == MAX_REQUEST_WORDS) {
+            snprintf(result->error, sizeof(result->error), "Too many words in request.");
+            return;
+        }
+        words[num_words++] = word;
+    }
+
+    size_t i = 0;
+    for (; i < num_words; i++) {
+        const char *error;
+        int parsed = parse_io_option(num_words, words, &i, &input, &output, &error);
+        if (parsed == -1) {
+            snprintf(result->error, sizeof(result->error), "%s", error);
+            return;
+        } else if (parsed == 0) {
+            break;
+        }
+    }
+    if (output == OUTPUT_SERVOSTREAM && !can_stream) {
+        snprintf(result->error, sizeof(result->error), "servostream output isn't available in batch mode.");
+        return;
+    }
+
+    shift_cube_s cube = SOLVED_SHIFTCUBE;
+    if (input == INPUT_SCRAMBLE) {
+        // alg_from_str wants the whole scramble as one string
+        char scramble[MAX_REQUEST_WORDS*4] = "";
+        for (; i < num_words; i++) {
+            strncat(scramble, words[i], sizeof(scramble) - strlen(scramble) - 2);
+            strcat(scramble, " ");
+        }
+        alg_s *scramble_alg = alg_from_str(scramble);
+        if (!scramble_alg) {
+            snprintf(result->error, sizeof(result->error), "Provided scramble was an invalid algorithm.");
+            return;
+        }
+        apply_alg(&cube, scramble_alg);
+        alg_free(scramble_alg);
+    } else if (input == INPUT_SHIFTCUBE) {
+        if (num_words - i != NUM_FACES) {
+            snprintf(result->error, sizeof(result->error), "Expected 6 faces for shiftcube input.");
+            return;
+        }
+        face_e bad_face = cube_from_faces(&words[i], &cube);
+        if (bad_face != FACE_NULL) {
+            snprintf(result->error, sizeof(result->error), "%d doesn't convert to a valid shiftcube face", bad_face);
+            return;
+        }
+    }
+
+    solve_into_result(cube, output, tables, ctx, result);
+}
+
+// reads every table image in full, which loading them never does
+static bool verify_tables() {
+    bool valid = table_image_verify(F2L_IMAGE_PATH, TABLE_IMAGE_F2L);
+    valid = table_image_verify(LL_IMAGE_PATH, TABLE_IMAGE_LL) && valid;
+    valid = table_image_verify(INTER_MOVE_TABLE_IMAGE_PATH, TABLE_IMAGE_INTER_MOVE) && valid;
+    return valid;
+}
+
+// parses every text table and writes it back out as a binary table image
+static int compile_tables() {
+    cube_table_s *f2l_table = gen_f2l_table();
+    cube_alg_table_s *ll_table = gen_last_layer_table();
+    inter_move_table_s *inter_move_table = inter_move_table_create();
+
+    bool written = cube_table_write_image(f2l_table, F2L_IMAGE_PATH) &&
+                   cube_alg_table_write_image(ll_table, LL_IMAGE_PATH) &&
+                   inter_move_table_write_image(inter_move_table, INTER_MOVE_TABLE_IMAGE_PATH);
+    if (written && verify_tables()) {
+        printf("Wrote %s, %s and %s\n", F2L_IMAGE_PATH, LL_IMAGE_PATH, INTER_MOVE_TABLE_IMAGE_PATH);
+    } else {
+        written = false;
+    }
+
+    inter_move_table_free(inter_move_table);
+    cube_table_free(f2l_table);
+    cube_alg_table_free(ll_table);
+    return written ? 0 : 1;
+}
+
+// reads requests from stdin until an empty line, "quit" or EOF, answering each
+// on stdout so the caller only pays for table generation once
+static int run_server(input_e input, output_e output, solver_tables_s *tables, solver_ctx_s *ctx) {
+    // load the servo table before the first request rather than during it. A
+    // request that asks for servo output on its own still loads it lazily
+    if (output != OUTPUT_ALG && !tables->inter_move_table) {
+        tables->inter_move_table = inter_move_table_load();
+    }
+
+    char *line = NULL;
+    size_t len = 0;
+    while (getline(&line, &len, stdin) != -1) {
+        if (line[0] == '\n' || !strcmp("quit\n", line)) {
+            break;
+        }
+        request_result_s result;
+        solve_request(line, input, output, true, tables, ctx, &result);
+        print_result(&result);
+        free_result(&result);
+        fflush(stdout);
+    }
+    free(line);
+    return 0;
+}
+
+typedef struct {
+    char *line;
+    bool done;
+    double milliseconds;
+    request_result_s result;
+} batch_slot_s;
+
+// Workers take turns reading the next line, solve it on their own context and
+// leave the result in the line's slot of a ring buffer. The main thread prints
+// the slots strictly in input order, which is also what frees them for reuse.
+typedef struct {
+    FILE *input_file;
+    input_e input;
+    output_e output;
+    solver_tables_s *tables;
+
+    pthread_mutex_t lock;
+    pthread_cond_t slot_done;
+    pthread_cond_t slot_free;
+    size_t next_read;
+    size_t next_print;
+    bool end_of_input;
+    batch_slot_s slots[BATCH_WINDOW];
+} batch_s;
+
+typedef struct {
+    batch_s *batch;
+    solver_ctx_s *ctx;
+} batch_worker_s;
+
+static double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec)*1e3 + (end->tv_nsec - start->tv_nsec)/1e6;
+}
+
+static void* batch_worker(void *arg) {
+    batch_s *batch = ((batch_worker_s*)arg)->batch;
+    solver_ctx_s *ctx = ((batch_worker_s*)arg)->ctx;
+
+    pthread_mutex_lock(&batch->lock);
+    while (true) {
+        while (!batch->end_of_input && batch->next_read - batch->next_print == BATCH_WINDOW) {
+            pthread_cond_wait(&batch->slot_free, &batch->lock);
+        }
+        if (batch->end_of_input) {
+            break;
+        }
+
+        char *line = NULL;
+        size_t len = 0;
+        if (getline(&line, &len, batch->input_file) == -1) {
+            free(line);
+            batch->end_of_input = true;
+            pthread_cond_broadcast(&batch->slot_done);
+            pthread_cond_broadcast(&batch->slot_free);
+            break;
+        }
+        batch_slot_s *slot = &batch->slots[batch->next_read++ % BATCH_WINDOW];
+        slot->line = line;
+        pthread_mutex_unlock(&batch->lock);
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        solve_request(line, batch->input, batch->output, false, batch->tables, ctx, &slot->result);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        slot->milliseconds = elapsed_ms(&start, &end);
+
+        pthread_mutex_lock(&batch->lock);
+        slot->done = true;
+        pthread_cond_broadcast(&batch->slot_done);
+    }
+    pthread_mutex_unlock(&batch->lock);
+    return NULL;
+}
+
+// solves every line of input_file on num_workers threads, each with its own
+// solver context, printing '<milliseconds> <result>' for every line in order
+static int run_batch(FILE *input_file, size_t num_workers, input_e input, output_e output, solver_tables_s *tables,
+                     const solver_options_s *options) {
+    // load the servo table up front, the workers can't load it lazily
+    if (!tables->inter_move_table) {
+        tables->inter_move_table = inter_move_table_load();
+    }
+
+    batch_s *batch = (batch_s*)calloc(1, sizeof(batch_s));
+    batch->input_file = input_file;
+    batch->input = input;
+    batch->output = output;
+    batch->tables = tables;
+    pthread_mutex_init(&batch->lock, NULL);
+    pthread_cond_init(&batch->slot_done, NULL);
+    pthread_cond_init(&batch->slot_free, NULL);
+
+    batch_worker_s workers[num_workers];
+    pthread_t threads[num_workers];
+    size_t num_threads = 0;
+    for (; num_threads < num_workers; num_threads++) {
+        workers[num_threads].batch = batch;
+        workers[num_threads].ctx = create_solver_ctx(tables, options);
+        if (!workers[num_threads].ctx ||
+            pthread_create(&threads[num_threads], NULL, batch_worker, &workers[num_threads])) {
+            solver_ctx_free(workers[num_threads].ctx);
+            break;
+        }
+    }
+    if (num_threads == 0) {
+        printf("Couldn't start any batch workers.\n");
+        free(batch);
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_mutex_lock(&batch->lock);
+    while (true) {
+        batch_slot_s *slot = &batch->slots[batch->next_print % BATCH_WINDOW];
+        while (!slot->done && !(batch->end_of_input && batch->next_print == batch->next_read)) {
+            pthread_cond_wait(&batch->slot_done, &batch->lock);
+        }
+        if (!slot->done) {
+            break;
+        }
+        pthread_mutex_unlock(&batch->lock);
+
+        printf("%.3f ", slot->milliseconds);
+        print_result(&slot->result);
+        fflush(stdout);
+        free_result(&slot->result);
+        free(slot->line);
+
+        pthread_mutex_lock(&batch->lock);
+        slot->done = false;
+        batch->next_print++;
+        pthread_cond_broadcast(&batch->slot_free);
+    }
+    pthread_mutex_unlock(&batch->lock);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (size_t worker = 0; worker < num_threads; worker++) {
+        pthread_join(threads[worker], NULL);
+        solver_ctx_free(workers[worker].ctx);
+    }
+
+    double seconds = elapsed_ms(&start, &end)/1e3;
+    fprintf(stderr, "Solved %zu cubes in %.2fs on %zu workers (%.1f cubes/s)\n",
+            batch->next_print, seconds, num_threads, batch->next_print/seconds);
+
+    pthread_cond_destroy(&batch->slot_done);
+    pthread_cond_destroy(&batch->slot_free);
+    pthread_mutex_destroy(&batch->lock);
+    free(batch);
+    return 0;
+}
 
 int main(int argc, char *argv[]) {
     input_e input = INPUT_SCRAMBLE;
     output_e output = OUTPUT_ALG;
+    bool server = false;
+    bool batch = false;
+    const char *batch_path = NULL;
+    long num_jobs = 0;
+    long max_candidates = 1;
+    long length_slack = 2;
+    long deadline_ms = 0;
+    bool log_improvements = false;
     if (argc == 1) {
         printf("Not enough arguments provided.\n");
         printf("Try './solver --help' for more information.\n");
@@ -50,32 +633,55 @@ int main(int argc, char *argv[]) {
     size_t i = 1;
     // check for optional inputs
     for (; i < argc; i++) {
-        if (!strcmp("-i", argv[i]) || !strcmp("--input", argv[i])) {
-            if (++i == argc) {
-                printf("Input option not provided.\n");
+        const char *error;
+        int parsed = parse_io_option(argc, argv, &i, &input, &output, &error);
+        if (parsed == -1) {
+            printf("%s\n", error);
+            return 1;
+        } else if (parsed == 1) {
+            continue;
+        }
+
+        if (!strcmp("-s", argv[i]) || !strcmp("--server", argv[i])) {
+            server = true;
+        } else if (!strcmp("-b", argv[i]) || !strcmp("--batch", argv[i])) {
+            batch = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                batch_path = argv[++i];
+            }
+        } else if (!strcmp("-j", argv[i]) || !strcmp("--jobs", argv[i])) {
+            char *end;
+            if (++i == argc || (num_jobs = strtol(argv[i], &end, 10)) < 1 || *end != '\0') {
+                printf("Number of jobs must be a positive integer.\n");
                 return 1;
             }
-            if (!strcmp("scramble", argv[i])) {
-                input = INPUT_SCRAMBLE;
-            } else if (!strcmp("shiftcube", argv[i])) {
-                input = INPUT_SHIFTCUBE;
-            } else {
-                printf("Invalid input option provided: %s\n", argv[i]);
+        } else if (!strcmp("-k", argv[i]) || !strcmp("--candidates", argv[i])) {
+            char *end;
+            if (++i == argc || (max_candidates = strtol(argv[i], &end, 10)) < 1 ||
+                max_candidates > SOLVER_MAX_CANDIDATES || *end != '\0') {
+                printf("Number of candidates must be between 1 and %d.\n", SOLVER_MAX_CANDIDATES);
                 return 1;
             }
-        } else if (!strcmp("-o", argv[i]) || !strcmp("--output", argv[i])) {
-            if (++i == argc) {
-                printf("Output option not provided.\n");
+        } else if (!strcmp("--slack", argv[i])) {
+            char *end;
+            if (++i == argc || (length_slack = strtol(argv[i], &end, 10)) < 0 || length_slack > UINT8_MAX ||
+                *end != '\0') {
+                printf("Slack must be a number of moves.\n");
                 return 1;
             }
-            if (!strcmp("alg", argv[i])) {
-                output = OUTPUT_ALG;
-            } else if (!strcmp("servocode", argv[i])) {
-                output = OUTPUT_SERVOCODE;
-            } else {
-                printf("Invalid output option provided: %s\n", argv[i]);
+        } else if (!strcmp("-d", argv[i]) || !strcmp("--deadline", argv[i])) {
+            char *end;
+            if (++i == argc || (deadline_ms = strtol(argv[i], &end, 10)) < 1 || deadline_ms > UINT32_MAX ||
+                *end != '\0') {
+                printf("Deadline must be a positive number of milliseconds.\n");
                 return 1;
             }
+        } else if (!strcmp("--log-improvements", argv[i])) {
+            log_improvements = true;
+        } else if (!strcmp("--compile-tables", argv[i])) {
+            return compile_tables();
+        } else if (!strcmp("--verify-tables", argv[i])) {
+            return verify_tables() ? 0 : 1;
         } else if (!strcmp("--help", argv[i])) {
             printf(help_str);
             return 0;
@@ -86,7 +692,25 @@ int main(int argc, char *argv[]) {
 
     shift_cube_s cube = SOLVED_SHIFTCUBE;
 
-    if (input == INPUT_SCRAMBLE) {
+    FILE *batch_file = stdin;
+    if (server || batch) {
+        if (i != argc) {
+            printf("%s mode takes its inputs from %s.\n", server ? "Server" : "Batch", server ? "stdin" : "a file or stdin");
+            return 1;
+        }
+        if (server && batch) {
+            printf("Server and batch mode can't be combined.\n");
+            return 1;
+        }
+        if (batch && output == OUTPUT_SERVOSTREAM) {
+            printf("servostream output isn't available in batch mode.\n");
+            return 1;
+        }
+        if (batch_path && !(batch_file = fopen(batch_path, "r"))) {
+            printf("Couldn't open %s\n", batch_path);
+            return 1;
+        }
+    } else if (input == INPUT_SCRAMBLE) {
         if (i + 1 != argc) {
             printf("Too many input parameters for scramble.\n");
             return 1;
@@ -99,48 +723,64 @@ int main(int argc, char *argv[]) {
         apply_alg(&cube, scramble_alg);
         alg_free(scramble_alg);
     } else if (input == INPUT_SHIFTCUBE) {
-        if (argc - i != 6) {
+        if (argc - i != NUM_FACES) {
             printf("Too many faces passed for shiftcube input.\n");
             return 1;
         }
-        for (face_e face = FACE_U; i < argc; face++, i++) {
-            char *end_ptr;
-            uint32_t face_data = strtoul(argv[i], &end_ptr, 16);
-            if (argv[i] == end_ptr || face_data > SOLVED_FACE_D) {
-                printf("%d doesn't convert to a valid shiftcube face\n", face);
-                return 1;
-            }
-            cube.state[face] = face_data;
+        face_e bad_face = cube_from_faces(&argv[i], &cube);
+        if (bad_face != FACE_NULL) {
+            printf("%d doesn't convert to a valid shiftcube face\n", bad_face);
+            return 1;
         }
     }
 
-    init_solver();
-    cube_table_s *f2l_table = gen_f2l_table();
-    cube_alg_table_s *ll_table = gen_last_layer_table();
-    alg_s *solve = solve_cube(cube, f2l_table, ll_table);
-    if (!solve) {
-        printf("Invalid cube:\n");
-        print_cube_map_colors(cube);
-        return 1;
-    }
+    solver_tables_s tables = {
+        .f2l_table = load_f2l_table(),
+        .ll_table = load_last_layer_table(),
+        .inter_move_table = NULL,
+    };
 
-    if (output == OUTPUT_ALG) {
-        print_alg(solve);
-    } else if (output == OUTPUT_SERVOCODE) {
-        inter_move_table_s *inter_move_table = inter_move_table_create();
-        RobotSolution servo_code = servoCode_compiler_Ofastest(solve, inter_move_table);
-        for (size_t i = 0; i < servo_code.size; i++) {
-            RobotState_s state = servo_code.solution[i];
-            print_RobotState(state); printf(" ");
-        } printf("\n");
-        free(servo_code.solution);
-        inter_move_table_free(inter_move_table);
+    solver_options_s options = {
+        .max_candidates = max_candidates,
+        .length_slack = length_slack,
+        .deadline_ms = deadline_ms,
+        .log_improvements = log_improvements,
+    };
+
+    int ret = 0;
+    if (batch) {
+        if (num_jobs == 0) {
+            num_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        ret = run_batch(batch_file, num_jobs < 1 ? 1 : num_jobs, input, output, &tables, &options);
+        if (batch_file != stdin) {
+            fclose(batch_file);
+        }
+    } else {
+        solver_ctx_s *ctx = create_solver_ctx(&tables, &options);
+        if (server) {
+            ret = run_server(input, output, &tables, ctx);
+        } else {
+            request_result_s result;
+            solve_into_result(cube, output, &tables, ctx, &result);
+            if (result.solve) {
+                print_result(&result);
+            } else {
+                printf("%s\n", result.error);
+                printf("Invalid cube:\n");
+                print_cube_map_colors(cube);
+                ret = 1;
+            }
+            free_result(&result);
+        }
+        solver_ctx_free(ctx);
     }
 
-    alg_free(solve);
-    cube_table_free(f2l_table);
-    cube_alg_table_free(ll_table);
-    cleanup_solver();
+    if (tables.inter_move_table) {
+        inter_move_table_free(tables.inter_move_table);
+    }
+    cube_table_free(tables.f2l_table);
+    cube_alg_table_free(tables.ll_table);
 
-    return 0;
+    return ret;
 }
@@ -14,6 +14,11 @@ static const char* F2L_PATH = "../../ALGORITHMS/FULL_F2L_ALGORITHMS.txt";
 static const char* INTER_MOVE_TABLE_PATH = "../../servoCoding/ServoOptimizationTable.txt";
 static const char* INTER_MOVE_TABLE_RSS_PATH = "../../servoCoding/ServoOptimizationTable_rootpaths.txt";
 
+// binary images of the tables above, written by ./solver --compile-tables
+static const char* LL_IMAGE_PATH = "../../ALGORITHMS/FULL_1LLL_ALGORITHMS.bin";
+static const char* F2L_IMAGE_PATH = "../../ALGORITHMS/FULL_F2L_ALGORITHMS.bin";
+static const char* INTER_MOVE_TABLE_IMAGE_PATH = "../../servoCoding/ServoOptimizationTable.bin";
+
 typedef enum face : uint8_t {
     FACE_U = 0,
     FACE_R = 1,
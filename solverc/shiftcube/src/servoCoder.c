@@ -8,12 +8,20 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include "solver_print.h"
+#include "table_image.h"
+#include "hash_table.h"
 #include <assert.h>
+#include <math.h>
+#include <string.h>
 
 #define INTER_MOVE_TABLE_CAPACITY 162
 #define INTER_MOVE_TABLE_PATHS_PER_NODE_NONRSS 735
 #define INTER_MOVE_TABLE_PATHS_PER_NODE_RSS 736
 
+// States between moves are indexed densely by orientation and robot state, e, s
+// and w are always engaged between moves so they aren't part of the index.
+#define LAYER_STATES (24*162)
+
 /*
 #define halfTurn 500 //in Milliseconds
 #define quarterTurn 350 //in Milliseconds
@@ -32,6 +40,12 @@ typedef struct DijkstraPath {
     size_t size;
 } DijkstraPath_s;
 
+static inline bool compare_inter_path_keys(const uint32_t* key1, const uint32_t* key2) {
+    return *key1 == *key2;
+}
+// (start, end state) -> index of the first path between them
+HASH_TABLE_DEFINE(inter_path_map, uint32_t, uint16_t, compare_inter_path_keys)
+
 typedef struct {                                                  // There will be 735 of these lying around
     State_s endState; // 4 bytes
     uint32_t singleMoveQualifications; // 4 bytes
@@ -45,6 +59,8 @@ typedef struct {                                                  // There will
     RSS_sub_entry_s* paths; // // 4 on 32-bit and 8 on 64-bit
     size_t length; // 4 on 32-bit and 8 on 64-bit
     size_t size;// 4 on 32-bit and 8 on 64-bit
+    const uint16_t* move_paths; // indexes of the paths that end able to do each move, in order
+    uint16_t first_move_path[NUM_MOVES+1]; // move's paths start at move_paths[first_move_path[move]]
 } RSS_entry_s; // 16 on 32-bit and 28 on 64-bit
 
 typedef struct {                                                  // There will be 67620 of these lying around
@@ -60,12 +76,17 @@ typedef struct {                                                  // There will
     sub_entry_s* paths; // 4 on 32-bit and 8 on 64-bit
     size_t length; // 4 on 32-bit and 8 on 64-bit
     size_t size; // 4 on 32-bit and 8 on 64-bit
+    const uint16_t* move_paths; // same as in RSS_entry_s
+    uint16_t first_move_path[NUM_MOVES+1];
 } inter_move_entry_s; // 14 on 32-bit and 26 on 64-bit
 
 typedef struct inter_move_table {
     RSS_entry_s RSS; // already counted for
     size_t size; // 4 on 32-bit and 8 on 64-bit
     inter_move_entry_s *table; // 4 on 32-bit and 8 on 64-bit
+    table_image_s *image; // set when every path points into a mapped table image
+    uint16_t *move_paths; // backs every entry's move_paths
+    inter_path_map_s end_paths;
 } inter_move_table_s; // 8 new bytes on 32-bit and 16 new bytes on 64-bit
 //    So on total, this inter-move-table will take up:                  *                                             *
 //                                                on 32-bit, (11760 + 26688 + 16 + 1081920 + 1174728 + 2268 + 8)  = 2297388 bytes
@@ -154,6 +175,7 @@ static const face_e ROT_TRAINS[6][4] = {
     {FACE_F, FACE_R, FACE_B, FACE_L},
 };
 static bool RobotStateNum_can_do_move[18][1296];
+static uint8_t divided_orientations[24][24]; // multiplied_orientations[o][divided_orientations[o][p]] == p
 
 /////////////////////////////////////////////// PRIVATE FUNCTION PROTOTYPES /////////////////////////////////////////
 bool inter_move_table_insert(inter_move_table_s *ht, const char* line);
@@ -163,12 +185,16 @@ void insert_root_lines_into_inter_move_table(inter_move_table_s* INTER_MOVE_TABL
 static inline size_t inter_move_table_get_index(const inter_move_table_s *ht, const RobotState_s *key);
 const RSS_entry_s* inter_move_table_get_RSS(const inter_move_table_s *ht);
 const inter_move_entry_s* inter_move_table_lookup(const inter_move_table_s *ht, const RobotState_s *key);
+bool inter_move_table_index(inter_move_table_s *ht);
+const RSS_sub_entry_s* inter_move_table_RSS_path_to(const inter_move_table_s *ht, const State_s *end);
+const sub_entry_s* inter_move_table_path_between(const inter_move_table_s *ht, const State_s *start, const State_s *end);
 
 Orientation_arr6_s Arr6_from_Orientation(Orientation_s O);
 Orientation_s Orientation_from_Arr6(Orientation_arr6_s arr6);
 Orientation_arr6_s multiply_arr6s(Orientation_arr6_s arr1, Orientation_arr6_s arr2);
 static inline uint8_t orientationNum(Orientation_s O);
 static inline Orientation_s orientation_from_num(uint8_t num);
+static inline uint16_t layer_state_index(const State_s* state);
 State_s Undefault_EndState(State_s origin, State_s OGendState);
 State_s stateNum_to_state(uint16_t stateNum);
 void print_RobotState(RobotState_s servos);
@@ -438,11 +464,18 @@ inter_move_table_s* inter_move_table_create() {
     ht->RSS.size = INTER_MOVE_TABLE_PATHS_PER_NODE_RSS;
     ht->RSS.startState = ROBOT_START_STATE;
     ht->size = INTER_MOVE_TABLE_CAPACITY;
+    ht->image = NULL;
+    ht->move_paths = NULL;
+    ht->end_paths = (inter_path_map_s) {0};
 
     init_RobotStateNum_can_do_move();
 
     insert_normal_lines_into_inter_move_table(ht, INTER_MOVE_TABLE_PATH);
     insert_root_lines_into_inter_move_table(ht, INTER_MOVE_TABLE_RSS_PATH);
+    if (!inter_move_table_index(ht)) {
+        inter_move_table_free(ht);
+        return NULL;
+    }
 
     /*
     size_t numSubEntries = 0;
@@ -490,26 +523,278 @@ const inter_move_entry_s* inter_move_table_lookup(const inter_move_table_s *ht,
 
     return (index == ht->size) ? NULL : &ht->table[index];
 }
+// lists every entry's paths by the moves they leave the robot able to do, and
+// maps each (start, end state) to the first path between them, the RSS's paths
+// are keyed with the start INTER_MOVE_TABLE_CAPACITY
+bool inter_move_table_index(inter_move_table_s *ht) {
+    for (uint8_t O = 0; O < 24; O++) {
+        for (uint8_t P = 0; P < 24; P++) {
+            divided_orientations[O][multiplied_orientations[O][P]] = P;
+        }
+    }
+
+    size_t num_paths = ht->RSS.length;
+    size_t num_move_paths = 0;
+    for (size_t pathInd = 0; pathInd < ht->RSS.length; pathInd++) {
+        num_move_paths += __builtin_popcount(ht->RSS.paths[pathInd].singleMoveQualifications);
+    }
+    for (size_t entryInd = 0; entryInd < ht->size; entryInd++) {
+        num_paths += ht->table[entryInd].length;
+        for (size_t pathInd = 0; pathInd < ht->table[entryInd].length; pathInd++) {
+            num_move_paths += __builtin_popcount(ht->table[entryInd].paths[pathInd].singleMoveQualifications);
+        }
+    }
+    ht->move_paths = (uint16_t*)malloc(num_move_paths*sizeof(uint16_t));
+    if (!ht->move_paths || !inter_path_map_init(&ht->end_paths, num_paths)) {
+        printf("Failed to allocate the inter move table's indexes.\n");
+        return false;
+    }
+
+    uint16_t* move_paths = ht->move_paths;
+    ht->RSS.move_paths = move_paths;
+    for (move_e move = 0; move < NUM_MOVES; move++) {
+        ht->RSS.first_move_path[move] = move_paths - ht->RSS.move_paths;
+        for (size_t pathInd = 0; pathInd < ht->RSS.length; pathInd++) {
+            if ((ht->RSS.paths[pathInd].singleMoveQualifications>>move)&1) *move_paths++ = pathInd;
+        }
+    } ht->RSS.first_move_path[NUM_MOVES] = move_paths - ht->RSS.move_paths;
+    for (size_t pathInd = 0; pathInd < ht->RSS.length; pathInd++) {
+        uint32_t key = INTER_MOVE_TABLE_CAPACITY*LAYER_STATES + layer_state_index(&ht->RSS.paths[pathInd].endState);
+        bool inserted;
+        inter_path_map_slot_s *slot = inter_path_map_insert(&ht->end_paths, &key, &inserted);
+        if (!slot) return false;
+        if (inserted) slot->value = pathInd;
+    }
+
+    for (size_t entryInd = 0; entryInd < ht->size; entryInd++) {
+        inter_move_entry_s* entry = &ht->table[entryInd];
+        entry->move_paths = move_paths;
+        for (move_e move = 0; move < NUM_MOVES; move++) {
+            entry->first_move_path[move] = move_paths - entry->move_paths;
+            for (size_t pathInd = 0; pathInd < entry->length; pathInd++) {
+                if ((entry->paths[pathInd].singleMoveQualifications>>move)&1) *move_paths++ = pathInd;
+            }
+        } entry->first_move_path[NUM_MOVES] = move_paths - entry->move_paths;
+        for (size_t pathInd = 0; pathInd < entry->length; pathInd++) {
+            uint32_t key = entryInd*LAYER_STATES + layer_state_index(&entry->paths[pathInd].endState);
+            bool inserted;
+            inter_path_map_slot_s *slot = inter_path_map_insert(&ht->end_paths, &key, &inserted);
+            if (!slot) return false;
+            if (inserted) slot->value = pathInd;
+        }
+    }
+    return true;
+}
+const RSS_sub_entry_s* inter_move_table_RSS_path_to(const inter_move_table_s *ht, const State_s *end) {
+    uint32_t key = INTER_MOVE_TABLE_CAPACITY*LAYER_STATES + layer_state_index(end);
+    const inter_path_map_slot_s *slot = inter_path_map_find(&ht->end_paths, &key);
+    return slot ? &ht->RSS.paths[slot->value] : NULL;
+}
+// end is where the path leaves the robot, paths store it as seen from start
+const sub_entry_s* inter_move_table_path_between(const inter_move_table_s *ht, const State_s *start, const State_s *end) {
+    size_t index = inter_move_table_get_index(ht, &start->servos);
+    if (index == ht->size) return NULL;
+    State_s endState = *end;
+    endState.persp = orientation_from_num(divided_orientations[orientationNum(start->persp)][orientationNum(end->persp)]);
+    uint32_t key = index*LAYER_STATES + layer_state_index(&endState);
+    const inter_path_map_slot_s *slot = inter_path_map_find(&ht->end_paths, &key);
+    return slot ? &ht->table[index].paths[slot->value] : NULL;
+}
 void inter_move_table_free(inter_move_table_s *ht) {
     if (ht == NULL || ht->table == NULL) {
         free(ht);
         return;
     }
+    // paths loaded from an image live in the mapping
+    bool free_paths = (ht->image == NULL);
     //printf("freeing RSS.paths..\n");
-    for (size_t subEntryInd = 0; subEntryInd < ht->RSS.length; subEntryInd++) {
+    for (size_t subEntryInd = 0; free_paths && subEntryInd < ht->RSS.length; subEntryInd++) {
         free(ht->RSS.paths[subEntryInd].path);
     } free(ht->RSS.paths);
     //printf("freeing table stuff..\n");
     for (size_t entryInd = 0; entryInd < ht->size; entryInd++) {
-        for (size_t subEntryInd = 0; subEntryInd < ht->table[entryInd].length; subEntryInd++) {
+        for (size_t subEntryInd = 0; free_paths && subEntryInd < ht->table[entryInd].length; subEntryInd++) {
             free(ht->table[entryInd].paths[subEntryInd].path);
         } free(ht->table[entryInd].paths);
     } //printf("freeing table..\n");
     free(ht->table);
+    free(ht->move_paths);
+    inter_path_map_destroy(&ht->end_paths);
+    table_image_unmap(ht->image);
     //printf("freeing ht..\n");
     free(ht);
 }
 
+// The image starts with inter_move_image_counts_s, then one entry per table slot,
+// then the path records of every slot in order followed by the RSS path records,
+// then the RSS paths' states and finally the normal paths' robot states.
+typedef struct {
+    uint32_t num_paths;
+    uint32_t num_RSS_paths;
+    uint32_t num_RSS_states;
+    uint32_t num_robot_states;
+} inter_move_image_counts_s;
+typedef struct {
+    RobotState_s startState;
+    uint16_t reserved;
+    uint32_t first_path;
+    uint32_t num_paths;
+} inter_move_image_entry_s;
+typedef struct {
+    State_s endState;
+    uint32_t singleMoveQualifications;
+    float distance;
+    float action;
+    uint32_t path_offset;
+    uint32_t path_size;
+} inter_move_image_path_s;
+
+bool inter_move_table_write_image(const inter_move_table_s *ht, const char *path) {
+    inter_move_image_counts_s counts = {0, ht->RSS.length, 0, 0};
+    for (size_t entryInd = 0; entryInd < ht->size; entryInd++) {
+        counts.num_paths += ht->table[entryInd].length;
+        for (size_t subEntryInd = 0; subEntryInd < ht->table[entryInd].length; subEntryInd++) {
+            counts.num_robot_states += ht->table[entryInd].paths[subEntryInd].size;
+        }
+    }
+    for (size_t subEntryInd = 0; subEntryInd < ht->RSS.length; subEntryInd++) {
+        counts.num_RSS_states += ht->RSS.paths[subEntryInd].size;
+    }
+
+    size_t entries_offset = sizeof(inter_move_image_counts_s);
+    size_t paths_offset = entries_offset + ht->size*sizeof(inter_move_image_entry_s);
+    size_t RSS_states_offset = paths_offset + (counts.num_paths + counts.num_RSS_paths)*sizeof(inter_move_image_path_s);
+    size_t robot_states_offset = RSS_states_offset + counts.num_RSS_states*sizeof(State_s);
+    size_t payload_size = robot_states_offset + counts.num_robot_states*sizeof(RobotState_s);
+
+    uint8_t *payload = (uint8_t*)calloc(payload_size, 1);
+    inter_move_image_entry_s *entries = (inter_move_image_entry_s*)(payload + entries_offset);
+    inter_move_image_path_s *paths = (inter_move_image_path_s*)(payload + paths_offset);
+    State_s *RSS_states = (State_s*)(payload + RSS_states_offset);
+    RobotState_s *robot_states = (RobotState_s*)(payload + robot_states_offset);
+    memcpy(payload, &counts, sizeof(counts));
+
+    size_t pathInd = 0;
+    size_t stateInd = 0;
+    for (size_t entryInd = 0; entryInd < ht->size; entryInd++) {
+        const inter_move_entry_s *entry = &ht->table[entryInd];
+        entries[entryInd] = (inter_move_image_entry_s) {
+            .startState = entry->startState,
+            .first_path = pathInd,
+            .num_paths = entry->length,
+        };
+        for (size_t subEntryInd = 0; subEntryInd < entry->length; subEntryInd++) {
+            const sub_entry_s *sub_entry = &entry->paths[subEntryInd];
+            paths[pathInd++] = (inter_move_image_path_s) {
+                .endState = sub_entry->endState,
+                .singleMoveQualifications = sub_entry->singleMoveQualifications,
+                .distance = sub_entry->distance,
+                .action = sub_entry->action,
+                .path_offset = stateInd,
+                .path_size = sub_entry->size,
+            };
+            memcpy(&robot_states[stateInd], sub_entry->path, sub_entry->size*sizeof(RobotState_s));
+            stateInd += sub_entry->size;
+        }
+    }
+    stateInd = 0;
+    for (size_t subEntryInd = 0; subEntryInd < ht->RSS.length; subEntryInd++) {
+        const RSS_sub_entry_s *sub_entry = &ht->RSS.paths[subEntryInd];
+        paths[pathInd++] = (inter_move_image_path_s) {
+            .endState = sub_entry->endState,
+            .singleMoveQualifications = sub_entry->singleMoveQualifications,
+            .distance = sub_entry->distance,
+            .action = sub_entry->action,
+            .path_offset = stateInd,
+            .path_size = sub_entry->size,
+        };
+        memcpy(&RSS_states[stateInd], sub_entry->path, sub_entry->size*sizeof(State_s));
+        stateInd += sub_entry->size;
+    }
+
+    bool written = table_image_write(path, TABLE_IMAGE_INTER_MOVE, counts.num_paths + counts.num_RSS_paths,
+                                     ht->size, payload, payload_size);
+    free(payload);
+    return written;
+}
+
+inter_move_table_s* inter_move_table_from_image(const char *path) {
+    const char *sources[2] = {INTER_MOVE_TABLE_PATH, INTER_MOVE_TABLE_RSS_PATH};
+    table_image_s *image = table_image_map(path, TABLE_IMAGE_INTER_MOVE, sources, 2);
+    if (!image) {
+        return NULL;
+    }
+    if (image->header->table_size != INTER_MOVE_TABLE_CAPACITY) {
+        table_image_unmap(image);
+        return NULL;
+    }
+
+    inter_move_image_counts_s counts;
+    memcpy(&counts, image->payload, sizeof(counts));
+    const inter_move_image_entry_s *entries = (const inter_move_image_entry_s*)(image->payload + sizeof(counts));
+    const inter_move_image_path_s *paths = (const inter_move_image_path_s*)&entries[INTER_MOVE_TABLE_CAPACITY];
+    const State_s *RSS_states = (const State_s*)&paths[counts.num_paths + counts.num_RSS_paths];
+    const RobotState_s *robot_states = (const RobotState_s*)&RSS_states[counts.num_RSS_states];
+
+    inter_move_table_s *ht = (inter_move_table_s*)malloc(sizeof(inter_move_table_s));
+    ht->table = (inter_move_entry_s*)calloc(INTER_MOVE_TABLE_CAPACITY, sizeof(inter_move_entry_s));
+    ht->size = INTER_MOVE_TABLE_CAPACITY;
+    ht->image = image;
+    ht->move_paths = NULL;
+    ht->end_paths = (inter_path_map_s) {0};
+
+    init_RobotStateNum_can_do_move();
+
+    for (size_t entryInd = 0; entryInd < ht->size; entryInd++) {
+        const inter_move_image_entry_s *entry = &entries[entryInd];
+        if (entry->num_paths == 0) continue;
+
+        ht->table[entryInd].startState = entry->startState;
+        ht->table[entryInd].paths = (sub_entry_s*)malloc(entry->num_paths*sizeof(sub_entry_s));
+        ht->table[entryInd].length = entry->num_paths;
+        ht->table[entryInd].size = entry->num_paths;
+        for (size_t subEntryInd = 0; subEntryInd < entry->num_paths; subEntryInd++) {
+            const inter_move_image_path_s *image_path = &paths[entry->first_path + subEntryInd];
+            ht->table[entryInd].paths[subEntryInd] = (sub_entry_s) {
+                .endState = image_path->endState,
+                .singleMoveQualifications = image_path->singleMoveQualifications,
+                .distance = image_path->distance,
+                .action = image_path->action,
+                .path = (RobotState_s*)&robot_states[image_path->path_offset],
+                .size = image_path->path_size,
+            };
+        }
+    }
+
+    ht->RSS.startState = ROBOT_START_STATE;
+    ht->RSS.paths = (RSS_sub_entry_s*)malloc(counts.num_RSS_paths*sizeof(RSS_sub_entry_s));
+    ht->RSS.length = counts.num_RSS_paths;
+    ht->RSS.size = counts.num_RSS_paths;
+    for (size_t subEntryInd = 0; subEntryInd < counts.num_RSS_paths; subEntryInd++) {
+        const inter_move_image_path_s *image_path = &paths[counts.num_paths + subEntryInd];
+        ht->RSS.paths[subEntryInd] = (RSS_sub_entry_s) {
+            .endState = image_path->endState,
+            .singleMoveQualifications = image_path->singleMoveQualifications,
+            .distance = image_path->distance,
+            .action = image_path->action,
+            .path = (State_s*)&RSS_states[image_path->path_offset],
+            .size = image_path->path_size,
+        };
+    }
+    if (!inter_move_table_index(ht)) {
+        inter_move_table_free(ht);
+        return NULL;
+    }
+
+    return ht;
+}
+
+// prefers the compiled image and falls back to parsing the text tables
+inter_move_table_s* inter_move_table_load() {
+    inter_move_table_s *ht = inter_move_table_from_image(INTER_MOVE_TABLE_IMAGE_PATH);
+    return ht ? ht : inter_move_table_create();
+}
+
 Orientation_arr6_s Arr6_from_Orientation(Orientation_s O) {
     Orientation_arr6_s wheres06;
     wheres06.faces[O.face] = FACE_F;
@@ -823,6 +1108,12 @@ void state_after_opposite_moves_pair(move_e move1, move_e move2, State_s state,
         *len = 1;
     }
 }
+// pair as the moves the robot has to do when it's in persp
+static inline MovePair MovePair_in_persp(MovePair pair, Orientation_s persp) {
+    pair.move1 = move_through_orientationNum[orientationNum(persp)][pair.move1];
+    if (!MovePair_is_singleMove(pair)) pair.move2 = move_through_orientationNum[orientationNum(persp)][pair.move2];
+    return pair;
+}
 bool endstate_can_do_MovePair_RSS(MovePair pair, uint32_t singleMoveQualifications) {
     if (MovePair_is_singleMove(pair)) {
         return (singleMoveQualifications>>pair.move1)&1;
@@ -886,21 +1177,10 @@ void servoCode_compiler_Dijkstra(MinHeap* minheap, MovePair* alg_sections, uint8
     MinHeapNode* current_node = MinHeap_pluck_min(minheap); //printf("\tline 797\n");
 
     const RSS_entry_s* RSS = inter_move_table_get_RSS(INTER_MOVE_TABLE);
-    if (MovePair_is_singleMove(alg_sections[0])) { //printf("\tline 822\n");
-        for (size_t pathInd = 0; pathInd < RSS->length; pathInd++) {
-            const RSS_sub_entry_s* path = &RSS->paths[pathInd];
-            State_s endState = path->endState; //printf("\t\t\tsingleMoveQualifications was %zu\n", path->singleMoveQualifications);
-            if ((((path->singleMoveQualifications)>>(alg_sections[0].move1))&1)) {
-                MinHeap_update_key(minheap, &endState, 0, true, path->distance, path->action, current_node);
-            }
-        }
-    } else { //printf("\tline 830\n");
-        for (size_t pathInd = 0; pathInd < RSS->length; pathInd++) {
-            const RSS_sub_entry_s* path = &RSS->paths[pathInd];
-            State_s endState = path->endState;
-            if ((((path->singleMoveQualifications)>>alg_sections[0].move1)&1) && (((path->singleMoveQualifications)>>alg_sections[0].move2)&1)) {
-                MinHeap_update_key(minheap, &endState, 0, true, path->distance, path->action, current_node);
-            }
+    for (uint16_t i = RSS->first_move_path[alg_sections[0].move1]; i < RSS->first_move_path[alg_sections[0].move1+1]; i++) {
+        const RSS_sub_entry_s* path = &RSS->paths[RSS->move_paths[i]];
+        if (endstate_can_do_MovePair_RSS(alg_sections[0], path->singleMoveQualifications)) {
+            MinHeap_update_key(minheap, &path->endState, 0, true, path->distance, path->action, current_node);
         }
     }
     if (state_can_do_MovePair(alg_sections[0], current_node->state)) {
@@ -919,24 +1199,12 @@ void servoCode_compiler_Dijkstra(MinHeap* minheap, MovePair* alg_sections, uint8
             MovePair pair = alg_sections[N+1];
             const inter_move_entry_s* entry = inter_move_table_lookup(INTER_MOVE_TABLE, &current_node->state.servos);
 
-            if (MovePair_is_singleMove(pair)) {
-                pair.move1 = move_through_orientationNum[orientationNum(current_node->state.persp)][pair.move1];
-                for (size_t pathInd = 0; pathInd < entry->length; pathInd++) {
-                    const sub_entry_s* path = &entry->paths[pathInd];
-                    State_s endState = Undefault_EndState(current_node->state, path->endState);
-                    if ((((path->singleMoveQualifications)>>pair.move1)&1)) {
-                        MinHeap_update_key(minheap, &endState, N+1, true, current_node->distance + path->distance, current_node->action + path->action, current_node);
-                    }
-                }
-            } else {
-                pair.move1 = move_through_orientationNum[orientationNum(current_node->state.persp)][pair.move1];
-                pair.move2 = move_through_orientationNum[orientationNum(current_node->state.persp)][pair.move2];
-                for (size_t pathInd = 0; pathInd < entry->length; pathInd++) {
-                    const sub_entry_s* path = &entry->paths[pathInd];
+            pair = MovePair_in_persp(pair, current_node->state.persp);
+            for (uint16_t i = entry->first_move_path[pair.move1]; i < entry->first_move_path[pair.move1+1]; i++) {
+                const sub_entry_s* path = &entry->paths[entry->move_paths[i]];
+                if (endstate_can_do_MovePair_RSS(pair, path->singleMoveQualifications)) {
                     State_s endState = Undefault_EndState(current_node->state, path->endState);
-                    if ((((path->singleMoveQualifications)>>pair.move1)&1) && (((path->singleMoveQualifications)>>pair.move2)&1)) {
-                        MinHeap_update_key(minheap, &endState, N+1, true, current_node->distance + path->distance, current_node->action + path->action, current_node);
-                    }
+                    MinHeap_update_key(minheap, &endState, N+1, true, current_node->distance + path->distance, current_node->action + path->action, current_node);
                 }
             }
             if (state_can_do_MovePair(alg_sections[N+1], current_node->state)) {
@@ -947,7 +1215,7 @@ void servoCode_compiler_Dijkstra(MinHeap* minheap, MovePair* alg_sections, uint8
     } free(stateAfterMove_arr);
     MinHeapNode* new_node = MinHeap_pluck_min(minheap);
     while (new_node->distance == current_node->distance) {
-        if (new_node && new_node->action < current_node->action && 
+        if (new_node && (new_node->action < current_node->action || (new_node->action == current_node->action && new_node < current_node)) && 
             new_node->algorithm_index == numAlgSecs-1 && 
             !(new_node->isBefore)
         ) current_node = new_node;
@@ -983,34 +1251,35 @@ RobotSolution Form_RobotSolution_from_DijkstraPath(DijkstraPath_s Dijkstra, cons
     size_t interpaths_lengths[Dijkstra.size];
     for (size_t i = 0; i < Dijkstra.size; i++) interpaths_lengths[i] = 0;
 
-    if (Dijkstra.path[0+1].isBefore == 1) {
-        const RSS_entry_s* RSS = inter_move_table_get_RSS(INTER_MOVE_TABLE);
-        for (size_t pathInd = 0; pathInd < RSS->length; pathInd++) {
-            if (compare_states(&Dijkstra.path[0+1].state, &RSS->paths[pathInd].endState)) {
-                interpaths_lengths[0] = RSS->paths[pathInd].size;
+    // a path picked up mid solve starts from wherever the robot was left, not from the RSS
+    float duration = 0;
+    size_t first_inter_path = 0;
+    if (State_is_ROBOT_START_STATE(&Dijkstra.path[0].state)) {
+        first_inter_path = 1;
+        if (Dijkstra.path[0+1].isBefore == 1) {
+            const RSS_sub_entry_s* path = inter_move_table_RSS_path_to(INTER_MOVE_TABLE, &Dijkstra.path[0+1].state);
+            if (path) {
+                duration += path->distance;
+                interpaths_lengths[0] = path->size;
                 interpaths_paths[0] = (RobotState_s*)malloc((interpaths_lengths[0])*sizeof(RobotState_s));
                 for (int j = 0; j < interpaths_lengths[0]; j++) {
-                    interpaths_paths[0][j] = RSS->paths[pathInd].path[j].servos;
+                    interpaths_paths[0][j] = path->path[j].servos;
                 }
-                break;
             }
-        }
+        } else duration += calc_weight_of_step(&Dijkstra.path[0].state, &Dijkstra.path[0+1].state);
     }
-    for (size_t i = 1; i < Dijkstra.size-1; i++) {
+    for (size_t i = first_inter_path; i < Dijkstra.size-1; i++) {
         if (Dijkstra.path[i+1].isBefore == 1) {
-            const inter_move_entry_s* entry = inter_move_table_lookup(INTER_MOVE_TABLE, &Dijkstra.path[i].state.servos);
-            for (size_t pathInd = 0; pathInd < entry->length; pathInd++) {
-                State_s endState = Undefault_EndState(Dijkstra.path[i].state, entry->paths[pathInd].endState);
-                if (compare_states(&Dijkstra.path[i+1].state, &endState)) {
-                    interpaths_lengths[i] = entry->paths[pathInd].size;
-                    interpaths_paths[i] = (RobotState_s*)malloc((interpaths_lengths[i])*sizeof(RobotState_s));
-                    for (int j = 0; j < interpaths_lengths[i]; j++) {
-                        interpaths_paths[i][j] = entry->paths[pathInd].path[j];
-                    }
-                    break;
+            const sub_entry_s* path = inter_move_table_path_between(INTER_MOVE_TABLE, &Dijkstra.path[i].state, &Dijkstra.path[i+1].state);
+            if (path) {
+                duration += path->distance;
+                interpaths_lengths[i] = path->size;
+                interpaths_paths[i] = (RobotState_s*)malloc((interpaths_lengths[i])*sizeof(RobotState_s));
+                for (int j = 0; j < interpaths_lengths[i]; j++) {
+                    interpaths_paths[i][j] = path->path[j];
                 }
             }
-        }
+        } else duration += calc_weight_of_step(&Dijkstra.path[i].state, &Dijkstra.path[i+1].state);
     }
 
     size_t ROBOT_SOLUTION_LENGTH = Dijkstra.size;
@@ -1031,11 +1300,16 @@ RobotSolution Form_RobotSolution_from_DijkstraPath(DijkstraPath_s Dijkstra, cons
     } //printf("----------------------------\n");
     return (RobotSolution) {
         .solution = ROBOT_SOLUTION,
-        .size = ROBOT_SOLUTION_LENGTH
+        .size = ROBOT_SOLUTION_LENGTH,
+        .duration = duration
     };
 }
 
 RobotSolution servoCode_compiler_Ofastest(const alg_s* alg, const inter_move_table_s* INTER_MOVE_TABLE) {
+    // an already solved cube needs no servo movement at all
+    if (alg->length == 0) {
+        return (RobotSolution) {NULL, 0};
+    }
     //////////////////////////// BUILD ALG_SECTIONS/////////////////////////////
     //printf("line 943\n");
     MovePair alg_sections[alg->length];
@@ -1061,4 +1335,230 @@ RobotSolution servoCode_compiler_Ofastest(const alg_s* alg, const inter_move_tab
     //printf("line 964\n");
     free(Dijkstra.path);
     return SOLUTION;
-}
\ No newline at end of file
+}
+// Every alg section is one layer of the search graph: the states right before its move and
+// the states right after it.
+#define LAYER_PARENT_PREV 0x8000
+#define LAYER_PARENT_START 0xFFFF
+
+typedef struct {
+    float distance[LAYER_STATES];
+    float action[LAYER_STATES];
+} servo_layer_s;
+
+typedef struct servo_stream {
+    const inter_move_table_s* INTER_MOVE_TABLE;
+    State_s state; // where the last committed chunk leaves the robot
+    MovePair* sections;
+    size_t numAlgSecs;
+    size_t nextAlgSec; // first section no chunk has committed yet
+} servo_stream_s;
+
+static inline uint16_t layer_state_index(const State_s* state) {
+    return orientationNum(state->persp)*162 + inter_move_table_hash(&state->servos);
+}
+static inline State_s layer_state_from_index(uint16_t index) {
+    uint16_t hash = index%162;
+    return (State_s) {
+        .persp = orientation_from_num(index/162),
+        .servos = (RobotState_s) {
+            .n = hash/81, .e = 1, .s = 1, .w = 1,
+            .U = (hash/27)%3, .R = (hash/9)%3, .D = (hash/3)%3, .L = hash%3
+        }
+    };
+}
+static void layer_reset(servo_layer_s* layer) {
+    for (size_t index = 0; index < LAYER_STATES; index++) {
+        layer->distance[index] = INFINITY;
+        layer->action[index] = INFINITY;
+    }
+}
+static inline void layer_relax(servo_layer_s* layer, uint16_t* argmin, uint16_t index, float distance, float action, uint16_t parent) {
+    if (distance < layer->distance[index] || (distance == layer->distance[index] && action < layer->action[index])) {
+        layer->distance[index] = distance;
+        layer->action[index] = action;
+        argmin[index] = parent;
+    }
+}
+static void layer_relax_move_edges(servo_layer_s* layer, uint16_t* argmin, MovePair pair, const State_s* state, float distance, float action, uint16_t parent) {
+    State_s stateAfterMove_arr[4];
+    uint8_t stateAfterMove_len;
+    state_after_MovePair(pair, *state, &stateAfterMove_len, stateAfterMove_arr);
+    for (uint8_t stateAfterMoveInd = 0; stateAfterMoveInd < stateAfterMove_len; stateAfterMoveInd++) {
+        const State_s* next = &stateAfterMove_arr[stateAfterMoveInd];
+        layer_relax(layer, argmin, layer_state_index(next), distance + calc_weight_of_step(state, next), action + calc_action_of_step(state, next), parent);
+    }
+}
+static void layer_relax_inter_move_edges(servo_layer_s* layer, uint16_t* argmin, MovePair pair, const State_s* state, float distance, float action, uint16_t parent, const inter_move_table_s* INTER_MOVE_TABLE) {
+    const inter_move_entry_s* entry = inter_move_table_lookup(INTER_MOVE_TABLE, &state->servos);
+    uint8_t perspNum = orientationNum(state->persp);
+    pair = MovePair_in_persp(pair, state->persp);
+    for (uint16_t i = entry->first_move_path[pair.move1]; i < entry->first_move_path[pair.move1+1]; i++) {
+        const sub_entry_s* path = &entry->paths[entry->move_paths[i]];
+        if (!endstate_can_do_MovePair_RSS(pair, path->singleMoveQualifications)) continue;
+        uint16_t index = multiplied_orientations[perspNum][orientationNum(path->endState.persp)]*162 + inter_move_table_hash(&path->endState.servos);
+        layer_relax(layer, argmin, index, distance + path->distance, action + path->action, parent);
+    }
+}
+
+// Finds the fastest way through the first numAlgSecs sections from start, which is either the
+// robot's start state or the state right after some earlier move, and returns the path as far
+// as the end of the first commit_sections of them.
+static DijkstraPath_s layered_path(const MovePair* alg_sections, uint8_t numAlgSecs, State_s start, uint8_t commit_sections, const inter_move_table_s* INTER_MOVE_TABLE) {
+    // argmins[2*N] leads into the states before section N and argmins[2*N+1] into the ones
+    // after it, only the distances of the layers being relaxed are kept around
+    uint16_t (*argmins)[LAYER_STATES] = malloc(2*numAlgSecs*sizeof(*argmins));
+    servo_layer_s* layers = malloc(3*sizeof(servo_layer_s));
+    servo_layer_s* prev_after = &layers[0];
+    servo_layer_s* before = &layers[1];
+    servo_layer_s* after = &layers[2];
+
+    for (uint8_t N = 0; N < numAlgSecs; N++) {
+        MovePair pair = alg_sections[N];
+        uint16_t* before_argmin = argmins[2*N];
+        uint16_t* after_argmin = argmins[2*N+1];
+        layer_reset(before);
+        layer_reset(after);
+
+        if (N == 0 && State_is_ROBOT_START_STATE(&start)) {
+            const RSS_entry_s* RSS = inter_move_table_get_RSS(INTER_MOVE_TABLE);
+            for (uint16_t i = RSS->first_move_path[pair.move1]; i < RSS->first_move_path[pair.move1+1]; i++) {
+                const RSS_sub_entry_s* path = &RSS->paths[RSS->move_paths[i]];
+                if (endstate_can_do_MovePair_RSS(pair, path->singleMoveQualifications)) {
+                    layer_relax(before, before_argmin, layer_state_index(&path->endState), path->distance, path->action, LAYER_PARENT_START);
+                }
+            }
+            if (state_can_do_MovePair(pair, start)) {
+                layer_relax_move_edges(after, after_argmin, pair, &start, 0, 0, LAYER_PARENT_START);
+            }
+        } else if (N == 0) {
+            layer_relax_inter_move_edges(before, before_argmin, pair, &start, 0, 0, LAYER_PARENT_START, INTER_MOVE_TABLE);
+            if (state_can_do_MovePair(pair, start)) {
+                layer_relax_move_edges(after, after_argmin, pair, &start, 0, 0, LAYER_PARENT_START);
+            }
+        } else {
+            for (uint16_t index = 0; index < LAYER_STATES; index++) {
+                if (prev_after->distance[index] == INFINITY) continue;
+                State_s state = layer_state_from_index(index);
+                float distance = prev_after->distance[index];
+                float action = prev_after->action[index];
+                layer_relax_inter_move_edges(before, before_argmin, pair, &state, distance, action, LAYER_PARENT_PREV | index, INTER_MOVE_TABLE);
+                if (state_can_do_MovePair(pair, state)) {
+                    layer_relax_move_edges(after, after_argmin, pair, &state, distance, action, LAYER_PARENT_PREV | index);
+                }
+            }
+        }
+        for (uint16_t index = 0; index < LAYER_STATES; index++) {
+            if (before->distance[index] == INFINITY) continue;
+            State_s state = layer_state_from_index(index);
+            layer_relax_move_edges(after, after_argmin, pair, &state, before->distance[index], before->action[index], index);
+        }
+        servo_layer_s* swap = prev_after;
+        prev_after = after;
+        after = swap;
+    }
+
+    uint16_t end = 0;
+    for (uint16_t index = 1; index < LAYER_STATES; index++) {
+        if (prev_after->distance[index] < prev_after->distance[end] ||
+            (prev_after->distance[index] == prev_after->distance[end] && prev_after->action[index] < prev_after->action[end])) end = index;
+    }
+
+    ////////// Walk the argmins back into the same path the Dijkstra compiler forms //////////
+    MinHeapNode reversed[2*numAlgSecs+1];
+    size_t length = 0;
+    size_t committed = 0; // how many of the reversed nodes lie past the committed sections
+    size_t layer = 2*numAlgSecs-1;
+    uint16_t index = end;
+    while (true) {
+        if (layer/2 >= commit_sections) committed++;
+        reversed[length++] = (MinHeapNode) {
+            .state = layer_state_from_index(index),
+            .algorithm_index = layer/2,
+            .isBefore = !(layer&1)
+        };
+        uint16_t parent = argmins[layer][index];
+        if (parent == LAYER_PARENT_START) break;
+        layer -= ((layer&1) && (parent & LAYER_PARENT_PREV)) ? 2 : 1;
+        index = parent & ~LAYER_PARENT_PREV;
+    }
+    reversed[length++] = (MinHeapNode) {.state = start, .algorithm_index = -1, .isBefore = false};
+    free(argmins);
+    free(layers);
+
+    DijkstraPath_s path = {.path = (MinHeapNode*)malloc((length-committed)*sizeof(MinHeapNode)), .size = length-committed};
+    for (size_t i = 0; i < path.size; i++) {
+        path.path[i] = reversed[length-1-i];
+    }
+    return path;
+}
+
+RobotSolution servoCode_compiler_layered(const alg_s* alg, const inter_move_table_s* INTER_MOVE_TABLE) {
+    if (alg->length == 0) {
+        return (RobotSolution) {NULL, 0};
+    }
+    MovePair alg_sections[alg->length];
+    uint8_t numAlgSecs = 0;
+    Load_alg_chunks(alg, alg_sections, &numAlgSecs);
+
+    DijkstraPath_s path = layered_path(alg_sections, numAlgSecs, ROBOT_START_STATE, numAlgSecs, INTER_MOVE_TABLE);
+    RobotSolution SOLUTION = Form_RobotSolution_from_DijkstraPath(path, INTER_MOVE_TABLE);
+    free(path.path);
+    return SOLUTION;
+}
+
+servo_stream_s* servo_stream_create(const inter_move_table_s* INTER_MOVE_TABLE) {
+    servo_stream_s* stream = (servo_stream_s*)malloc(sizeof(servo_stream_s));
+    if (!stream) {
+        return NULL;
+    }
+    stream->INTER_MOVE_TABLE = INTER_MOVE_TABLE;
+    stream->state = ROBOT_START_STATE;
+    stream->sections = NULL;
+    stream->numAlgSecs = 0;
+    stream->nextAlgSec = 0;
+    return stream;
+}
+void servo_stream_free(servo_stream_s* stream) {
+    if (stream == NULL) return;
+    free(stream->sections);
+    free(stream);
+}
+bool servo_stream_feed(servo_stream_s* stream, const alg_s* alg) {
+    if (alg->length == 0) {
+        return true;
+    }
+    MovePair* sections = (MovePair*)realloc(stream->sections, (stream->numAlgSecs + alg->length)*sizeof(MovePair));
+    if (!sections) {
+        printf("Failed to grow the servo stream's sections.\n");
+        return false;
+    }
+    // algs fed separately never share a section, the robot may already be doing the first
+    uint8_t numAlgSecs = 0;
+    Load_alg_chunks(alg, sections + stream->numAlgSecs, &numAlgSecs);
+    stream->sections = sections;
+    stream->numAlgSecs += numAlgSecs;
+    return true;
+}
+RobotSolution servo_stream_next(servo_stream_s* stream, uint8_t chunk_sections, uint8_t window_sections) {
+    size_t pending = stream->numAlgSecs - stream->nextAlgSec;
+    if (pending == 0) {
+        return (RobotSolution) {NULL, 0};
+    }
+    uint8_t window = (pending < window_sections) ? pending : window_sections;
+    uint8_t commit = (window < chunk_sections) ? window : chunk_sections;
+
+    bool from_start = State_is_ROBOT_START_STATE(&stream->state);
+    DijkstraPath_s path = layered_path(&stream->sections[stream->nextAlgSec], window, stream->state, commit, stream->INTER_MOVE_TABLE);
+    RobotSolution chunk = Form_RobotSolution_from_DijkstraPath(path, stream->INTER_MOVE_TABLE);
+    stream->state = path.path[path.size-1].state;
+    stream->nextAlgSec += commit;
+    free(path.path);
+
+    // only the very first chunk repeats the state the robot is already in
+    if (!from_start) {
+        memmove(chunk.solution, chunk.solution+1, (chunk.size-1)*sizeof(RobotState_s));
+        chunk.size--;
+    }
+    return chunk;
+}
@@ -26,9 +26,11 @@ typedef struct State_s {
 typedef struct RobotSolution {
     RobotState_s* solution;
     size_t size;
+    float duration; // predicted seconds the robot takes to run the solution
 } RobotSolution;
 
 typedef struct inter_move_table inter_move_table_s;
+typedef struct servo_stream servo_stream_s;
 
 void print_RobotState(RobotState_s servos);
 void print_State(State_s state);
@@ -36,10 +38,22 @@ uint16_t RobotState_to_uint16t(const RobotState_s* state);
 bool compare_states(const State_s* state1, const State_s* state2);
 
 inter_move_table_s* inter_move_table_create();
+inter_move_table_s* inter_move_table_load();
+bool inter_move_table_write_image(const inter_move_table_s *ht, const char *path);
+inter_move_table_s* inter_move_table_from_image(const char *path);
 void inter_move_table_free(inter_move_table_s *ht);
 size_t inter_move_table_hash(const RobotState_s *key);
 
 size_t total_nodes_from_alg_secs(MovePair* alg_sections, uint8_t numAlgSecs);
 RobotSolution servoCode_compiler_Ofastest(const alg_s* alg, const inter_move_table_s* INTER_MOVE_TABLE);
+RobotSolution servoCode_compiler_layered(const alg_s* alg, const inter_move_table_s* INTER_MOVE_TABLE);
+
+// compiles an alg in chunks while more of it is still being fed in: each next() optimizes over
+// window_sections of the pending moves and commits the first chunk_sections of them, later
+// chunks carry on from where the last one left the robot
+servo_stream_s* servo_stream_create(const inter_move_table_s* INTER_MOVE_TABLE);
+void servo_stream_free(servo_stream_s* stream);
+bool servo_stream_feed(servo_stream_s* stream, const alg_s* alg);
+RobotSolution servo_stream_next(servo_stream_s* stream, uint8_t chunk_sections, uint8_t window_sections);
 
 #endif // SERVOCODER_H
\ No newline at end of file
@@ -8,25 +8,118 @@
 #include "cube_alg_table.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <sys/types.h>
+#include <time.h>
+
+// search nodes between reads of the clock while a deadline is set
+#define CLOCK_CHECK_INTERVAL 512
+
+
+// everything a single solve writes to, so solves on different contexts can run
+// at the same time. The F2L and last layer tables are only ever read
+typedef struct solver_ctx {
+    const cube_table_s *f2l_table;
+    const cube_alg_table_s *ll_table;
+
+    cube_alg_table_s *xcross_start_ct;
+    cube_alg_table_s *xcross_end_ct;
+
+    // the distinct solves found so far, shortest first
+    uint8_t max_candidates;
+    uint8_t length_slack;
+    uint8_t num_candidates;
+    alg_s *candidates[SOLVER_MAX_CANDIDATES];
+
+    // with a budget the search stops at the deadline, as long as it found a solve
+    uint32_t budget_ms;
+    struct timespec started;
+    struct timespec deadline;
+    uint16_t until_clock_check;
+    bool out_of_time;
+    FILE *improvement_log;
+} solver_ctx_s;
+
+solver_ctx_s* solver_ctx_create(const cube_table_s *f2l_table, const cube_alg_table_s *ll_table) {
+    solver_ctx_s *ctx = (solver_ctx_s*)malloc(sizeof(solver_ctx_s));
+    if (!ctx) {
+        return NULL;
+    }
 
+    ctx->f2l_table = f2l_table;
+    ctx->ll_table  = ll_table;
+    ctx->max_candidates = 1;
+    ctx->length_slack   = 0;
+    ctx->num_candidates = 0;
+    ctx->budget_ms = 0;
+    ctx->out_of_time = false;
+    ctx->improvement_log = NULL;
+    // far fewer than the cube_table_depth_sizes[5] states within 5 moves are
+    // ever reached in one solve, and the tables grow if a solve needs more
+    ctx->xcross_start_ct = cube_alg_table_create(262144);
+    ctx->xcross_end_ct   = cube_alg_table_create(262144);
+    if (!ctx->xcross_start_ct || !ctx->xcross_end_ct) {
+        solver_ctx_free(ctx);
+        return NULL;
+    }
 
-static cube_alg_table_s *xcross_start_ct = NULL;
-static cube_alg_table_s *xcross_end_ct   = NULL;
+    return ctx;
+}
+
+void solver_ctx_free(solver_ctx_s *ctx) {
+    if (ctx == NULL) return;
+    cube_alg_table_free(ctx->xcross_start_ct);
+    cube_alg_table_free(ctx->xcross_end_ct);
+    free(ctx);
+}
 
-bool init_solver() {
-    xcross_start_ct = cube_alg_table_create(cube_table_depth_sizes[5]);
-    xcross_end_ct   = cube_alg_table_create(cube_table_depth_sizes[5]);
-    if (!xcross_start_ct || !xcross_end_ct) {
+bool solver_ctx_set_candidates(solver_ctx_s *ctx, uint8_t max_candidates, uint8_t length_slack) {
+    if (max_candidates == 0 || max_candidates > SOLVER_MAX_CANDIDATES) {
+        printf("Can only keep between 1 and %d candidate solves.\n", SOLVER_MAX_CANDIDATES);
         return false;
     }
-
+    ctx->max_candidates = max_candidates;
+    ctx->length_slack   = length_slack;
     return true;
 }
 
-void cleanup_solver() {
-    cube_alg_table_free(xcross_start_ct);
-    cube_alg_table_free(xcross_end_ct);
+void solver_ctx_set_deadline(solver_ctx_s *ctx, uint32_t budget_ms) {
+    ctx->budget_ms = budget_ms;
+}
+
+void solver_ctx_log_improvements(solver_ctx_s *ctx, FILE *log) {
+    ctx->improvement_log = log;
+}
+
+static double ms_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec)*1e3 + (now.tv_nsec - start->tv_nsec)/1e6;
+}
+
+// starts the clock on ctx's budget for a new solve
+static void solve_started(solver_ctx_s *ctx) {
+    ctx->num_candidates = 0;
+    ctx->out_of_time = false;
+    ctx->until_clock_check = CLOCK_CHECK_INTERVAL;
+    clock_gettime(CLOCK_MONOTONIC, &ctx->started);
+    ctx->deadline.tv_sec  = ctx->started.tv_sec + ctx->budget_ms/1000 + (ctx->started.tv_nsec + (ctx->budget_ms%1000)*1000000L)/1000000000L;
+    ctx->deadline.tv_nsec = (ctx->started.tv_nsec + (ctx->budget_ms%1000)*1000000L)%1000000000L;
+}
+
+// true once the budget has run out, which never happens before the first solve
+// is found so there's always one to hand back
+static bool out_of_time(solver_ctx_s *ctx) {
+    if (ctx == NULL || ctx->budget_ms == 0 || ctx->num_candidates == 0) return false;
+    if (ctx->out_of_time) return true;
+    if (--ctx->until_clock_check > 0) return false;
+
+    ctx->until_clock_check = CLOCK_CHECK_INTERVAL;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ctx->out_of_time = now.tv_sec > ctx->deadline.tv_sec ||
+                       (now.tv_sec == ctx->deadline.tv_sec && now.tv_nsec >= ctx->deadline.tv_nsec);
+    return ctx->out_of_time;
 }
 
 shift_cube_s get_f2l_pair(const shift_cube_s *cube, uint8_t pair) {
@@ -98,8 +191,11 @@ alg_s* solve_stage(shift_cube_s cube, shift_cube_s mask) {
     return alg;
 }
 
-int bidirectional_recursion(shift_cube_s *cube, cube_alg_table_s *our_ct, 
+int bidirectional_recursion(solver_ctx_s *ctx, shift_cube_s *cube, cube_alg_table_s *our_ct,
                             cube_alg_table_s *other_ct, alg_s *alg, uint8_t depth) {
+    if (out_of_time(ctx)) {
+        return -1;
+    }
     if (depth == 0) {
         if (!cube_alg_table_lookup(our_ct, cube)) {
             cube_alg_table_insert_if_new(our_ct, cube, alg);
@@ -130,9 +226,10 @@ int bidirectional_recursion(shift_cube_s *cube, cube_alg_table_s *our_ct,
 
         alg_append(alg, move);
         apply_move(cube, move);
-        if (bidirectional_recursion(cube, our_ct, other_ct, alg, depth - 1)) {
-            // we did it!
-            return 1;
+        int found = bidirectional_recursion(ctx, cube, our_ct, other_ct, alg, depth - 1);
+        if (found) {
+            // we did it! Or ran out of time
+            return found;
         }
 
         // keep going, move didn't pan out
@@ -168,7 +265,7 @@ alg_s* bidirectional_search(const shift_cube_s *start, const shift_cube_s *goal,
     bool found = false;
 
     for (uint8_t depth = 0; depth <= start_depth; depth++) {
-        if (bidirectional_recursion(&start_cube, start_ct, end_ct, start_alg, depth)) {
+        if (bidirectional_recursion(NULL, &start_cube, start_ct, end_ct, start_alg, depth)) {
             alg_free(end_alg);
             end_alg = alg_copy(cube_alg_table_lookup(end_ct, &start_cube));
             found = true;
@@ -177,7 +274,7 @@ alg_s* bidirectional_search(const shift_cube_s *start, const shift_cube_s *goal,
 
         if (max_depth % 2 == 1) break;
 
-        if (bidirectional_recursion(&end_cube, end_ct, start_ct, end_alg, depth)) {
+        if (bidirectional_recursion(NULL, &end_cube, end_ct, start_ct, end_alg, depth)) {
             alg_free(start_alg);
             start_alg = alg_copy(cube_alg_table_lookup(start_ct, &end_cube));
             found = true;
@@ -198,11 +295,39 @@ alg_s* bidirectional_search(const shift_cube_s *start, const shift_cube_s *goal,
     }
 }
 
-static alg_s* xcross_search(const shift_cube_s *start, const shift_cube_s *goal) {
-    if (!xcross_start_ct || !xcross_end_ct) {
+// searches one more depth from both sides of an xcross, returns 1 once they meet
+// with start_alg and end_alg leading to where they did, 0 if they didn't and -1
+// if ctx ran out of time
+static int xcross_search_depth(solver_ctx_s *ctx, shift_cube_s *start_cube, shift_cube_s *end_cube,
+                               alg_s **start_alg, alg_s **end_alg, uint8_t depth) {
+    int found = bidirectional_recursion(ctx, start_cube, ctx->xcross_start_ct, ctx->xcross_end_ct, *start_alg, depth);
+    if (found == 1) {
+        alg_free(*end_alg);
+        *end_alg = alg_copy(cube_alg_table_lookup(ctx->xcross_end_ct, start_cube));
+    }
+    if (found) return found;
+
+    found = bidirectional_recursion(ctx, end_cube, ctx->xcross_end_ct, ctx->xcross_start_ct, *end_alg, depth);
+    if (found == 1) {
+        alg_free(*start_alg);
+        *start_alg = alg_copy(cube_alg_table_lookup(ctx->xcross_start_ct, end_cube));
+    }
+    return found;
+}
+
+static alg_s* xcross_join(alg_s *start_alg, alg_s *end_alg) {
+    if (!start_alg || !end_alg) {
+        alg_free(start_alg);
+        alg_free(end_alg);
         return NULL;
     }
+    alg_invert(end_alg);
+    alg_concat(start_alg, end_alg);
+    alg_free(end_alg);
+    return start_alg;
+}
 
+static alg_s* xcross_search(solver_ctx_s *ctx, const shift_cube_s *start, const shift_cube_s *goal) {
     alg_s *start_alg = alg_create(5);
     alg_s *end_alg   = alg_create(5);
 
@@ -210,26 +335,17 @@ static alg_s* xcross_search(const shift_cube_s *start, const shift_cube_s *goal)
     shift_cube_s end_cube   = *goal;
 
     for (uint8_t depth = 0; depth <= 5; depth++) {
-        if (bidirectional_recursion(&start_cube, xcross_start_ct, xcross_end_ct, start_alg, depth)) {
-            alg_free(end_alg);
-            end_alg = alg_copy(cube_alg_table_lookup(xcross_end_ct, &start_cube));
-            break;
-        }
-
-        if (bidirectional_recursion(&end_cube, xcross_end_ct, xcross_start_ct, end_alg, depth)) {
+        int found = xcross_search_depth(ctx, &start_cube, &end_cube, &start_alg, &end_alg, depth);
+        if (found == -1) {
             alg_free(start_alg);
-            start_alg = alg_copy(cube_alg_table_lookup(xcross_start_ct, &end_cube));
+            alg_free(end_alg);
+            return NULL;
+        } else if (found) {
             break;
         }
     }
 
-    if (!start_alg || !end_alg) return NULL;
-
-    alg_invert(end_alg);
-    alg_concat(start_alg, end_alg);
-
-    alg_free(end_alg);
-    return start_alg;
+    return xcross_join(start_alg, end_alg);
 }
 
 alg_s* solve_cross(shift_cube_s cube) {
@@ -239,28 +355,59 @@ alg_s* solve_cross(shift_cube_s cube) {
     return bidirectional_search(&cube, &goal_cube, 8);
 }
 
-static void last_layer_stage(const shift_cube_s *cube, alg_s **best, const alg_s *xsolve,
+// keeps solve if it's one of the max_candidates shortest distinct solves within
+// length_slack of the shortest, solves of the same length stay in the order
+// they were found
+static void candidates_insert(solver_ctx_s *ctx, alg_s *solve) {
+    uint8_t num = ctx->num_candidates;
+    if ((num == ctx->max_candidates && ctx->candidates[num - 1]->length <= solve->length) ||
+        (num > 0 && solve->length > ctx->candidates[0]->length + ctx->length_slack)) {
+        alg_free(solve);
+        return;
+    }
+    for (uint8_t i = 0; i < num; i++) {
+        if (ctx->candidates[i]->length == solve->length &&
+            !memcmp(ctx->candidates[i]->moves, solve->moves, solve->length*sizeof(move_t))) {
+            alg_free(solve);
+            return;
+        }
+    }
+
+    if (num == ctx->max_candidates) {
+        alg_free(ctx->candidates[--num]);
+    }
+    uint8_t pos = num;
+    for (; pos > 0 && ctx->candidates[pos - 1]->length > solve->length; pos--) {
+        ctx->candidates[pos] = ctx->candidates[pos - 1];
+    }
+    ctx->candidates[pos] = solve;
+    num++;
+    if (pos == 0 && ctx->improvement_log) {
+        fprintf(ctx->improvement_log, "improvement: %hhu moves after %.3f ms\n", solve->length, ms_since(&ctx->started));
+    }
+
+    // a new shortest solve can leave the longest ones out of the slack
+    while (ctx->candidates[num - 1]->length > ctx->candidates[0]->length + ctx->length_slack) {
+        alg_free(ctx->candidates[--num]);
+    }
+    ctx->num_candidates = num;
+}
+
+static void last_layer_stage(const shift_cube_s *cube, solver_ctx_s *ctx, const alg_s *xsolve,
                              const alg_s *f2l_solve, const cube_alg_table_s *ll_table) {
     alg_s *solve = alg_copy(xsolve);
     alg_concat(solve, f2l_solve);
 
-    const alg_s *last_layer_alg = cube_alg_table_lookup(ll_table, cube);
-    if (last_layer_alg != NULL) {
-        alg_concat(solve, last_layer_alg);
+    alg_s last_layer_alg;
+    if (cube_alg_table_get(ll_table, cube, &last_layer_alg)) {
+        alg_concat(solve, &last_layer_alg);
     }
 
     alg_simplify(solve);
-
-    if (*best && (*best)->length <= solve->length) {
-        alg_free(solve);
-        return;
-    }
-
-    alg_free(*best);
-    *best = solve;
+    candidates_insert(ctx, solve);
 }
 
-static void f2l_stage(shift_cube_s cube, alg_s **best, const alg_s *xsolve,
+static void f2l_stage(shift_cube_s cube, solver_ctx_s *ctx, const alg_s *xsolve,
                       alg_s *f2l_solve, const cube_table_s *f2l_table,
                       const cube_alg_table_s *ll_table, uint8_t depth) {
 
@@ -269,18 +416,43 @@ static void f2l_stage(shift_cube_s cube, alg_s **best, const alg_s *xsolve,
 
     // we solved F2L! Proceed to the last layer
     if (compare_cubes(&cube_f2l_bits, &solved_f2l_bits)) {
-        last_layer_stage(&cube, best, xsolve, f2l_solve, ll_table);
+        last_layer_stage(&cube, ctx, xsolve, f2l_solve, ll_table);
         return;
     }
     if (depth == 0) printf("5TH PAIR?!\n");
+    if (out_of_time(ctx)) return;
+
+    // against a deadline, the pairs with the shortest algs go first
+    uint8_t pair_order[4] = {0, 1, 2, 3};
+    if (ctx->budget_ms) {
+        uint8_t shortest[4];
+        for (uint8_t pair = 0; pair < 4; pair++) {
+            shift_cube_s pair_mask = get_f2l_pair(&cube, pair);
+            cube_table_algs_s pair_algs = {0};
+            cube_table_get(f2l_table, &pair_mask, &pair_algs);
+            shortest[pair] = UINT8_MAX;
+            for (size_t alg = 0; alg < pair_algs.num_algs; alg++) {
+                uint8_t length = cube_table_alg(&pair_algs, alg).length;
+                if (length < shortest[pair]) shortest[pair] = length;
+            }
+        }
+        for (uint8_t i = 1; i < 4; i++) {
+            for (uint8_t j = i; j > 0 && shortest[pair_order[j]] < shortest[pair_order[j - 1]]; j--) {
+                uint8_t swap = pair_order[j];
+                pair_order[j] = pair_order[j - 1];
+                pair_order[j - 1] = swap;
+            }
+        }
+    }
 
-    for (uint8_t pair = 0; pair < 4; pair++) {
+    for (uint8_t i = 0; i < 4; i++) {
+        uint8_t pair = pair_order[i];
         shift_cube_s pair_mask = get_f2l_pair(&cube, pair);
         shift_cube_s solved_pair_mask = get_f2l_pair(&SOLVED_SHIFTCUBE, pair);
         if (compare_cubes(&pair_mask, &solved_pair_mask)) continue;
 
-        const alg_list_s *pair_algs = cube_table_lookup(f2l_table, &pair_mask);
-        if (!pair_algs) {
+        cube_table_algs_s pair_algs;
+        if (!cube_table_get(f2l_table, &pair_mask, &pair_algs)) {
             //printf("THERE ARE NO PAIR ALGS FOR PAIR %hhu\n", pair);
             //print_cube_map_colors(cube);
             //printf("THE XCROSS SOLVE WAS: ");
@@ -288,23 +460,68 @@ static void f2l_stage(shift_cube_s cube, alg_s **best, const alg_s *xsolve,
             return;
         }
 
-        for (size_t alg = 0; alg < pair_algs->num_algs; alg++) {
+        for (size_t alg = 0; alg < pair_algs.num_algs; alg++) {
+            alg_s pair_alg = cube_table_alg(&pair_algs, alg);
             //if (compare_algs(xsolve, "B2 R B' L' F L F") && compare_algs(f2l_solve, "L2 B L U' B' L B2 D B' U B D' B2")) {
             //    print_cube_map_colors(cube);
-            //    print_alg(&(pair_algs->list[alg]));
+            //    print_alg(&pair_alg);
             //}
             shift_cube_s new_cube = cube;
-            apply_alg(&new_cube, &pair_algs->list[alg]);
+            apply_alg(&new_cube, &pair_alg);
             size_t old_len = f2l_solve->length;
-            alg_concat(f2l_solve, &pair_algs->list[alg]);
-            f2l_stage(new_cube, best, xsolve, f2l_solve, f2l_table, ll_table, depth-1);
+            alg_concat(f2l_solve, &pair_alg);
+            f2l_stage(new_cube, ctx, xsolve, f2l_solve, f2l_table, ll_table, depth-1);
             f2l_solve->length -= f2l_solve->length - old_len;
         }
     }
 }
 
-static void xcross_stage(shift_cube_s cube, alg_s **best,
-                         const cube_table_s *f2l_table, const cube_alg_table_s *ll_table) {
+// searches the pairs' xcrosses side by side a depth at a time, so that the F2L
+// after the shortest ones is searched first and an early deadline still ends up
+// with a good solve
+static void xcross_stage_shortest_first(solver_ctx_s *ctx, shift_cube_s cube) {
+    shift_cube_s mask_cube   = get_edges(&cube, FACE_D, FACE_NULL);
+    shift_cube_s target_cube = get_edges(&SOLVED_SHIFTCUBE, FACE_D, FACE_NULL);
+
+    shift_cube_s start_cubes[4], end_cubes[4];
+    alg_s *start_algs[4], *end_algs[4];
+    for (uint8_t pair = 0; pair < 4; pair++) {
+        shift_cube_s cube_pair_mask   = get_f2l_pair(&cube, pair);
+        shift_cube_s target_pair_mask = get_f2l_pair(&SOLVED_SHIFTCUBE, pair);
+        start_cubes[pair] = ored_cube(&mask_cube, &cube_pair_mask);
+        end_cubes[pair]   = ored_cube(&target_cube, &target_pair_mask);
+        start_algs[pair]  = alg_create(5);
+        end_algs[pair]    = alg_create(5);
+    }
+
+    bool searched[4] = {false, false, false, false};
+    for (uint8_t depth = 0; depth <= 5 && !ctx->out_of_time; depth++) {
+        for (uint8_t pair = 0; pair < 4 && !ctx->out_of_time; pair++) {
+            if (searched[pair]) continue;
+            int found = xcross_search_depth(ctx, &start_cubes[pair], &end_cubes[pair], &start_algs[pair], &end_algs[pair], depth);
+            if (found != 1) continue;
+
+            searched[pair] = true;
+            alg_s *xcross_alg = xcross_join(start_algs[pair], end_algs[pair]);
+            start_algs[pair] = end_algs[pair] = NULL;
+            if (!xcross_alg) continue;
+
+            shift_cube_s new_cube = cube;
+            apply_alg(&new_cube, xcross_alg);
+            alg_s *f2l_solve = alg_create(10);
+            f2l_stage(new_cube, ctx, xcross_alg, f2l_solve, ctx->f2l_table, ctx->ll_table, 3);
+            alg_free(f2l_solve);
+            alg_free(xcross_alg);
+        }
+    }
+
+    for (uint8_t pair = 0; pair < 4; pair++) {
+        alg_free(start_algs[pair]);
+        alg_free(end_algs[pair]);
+    }
+}
+
+static void xcross_stage(solver_ctx_s *ctx, shift_cube_s cube) {
     shift_cube_s mask_cube   = get_edges(&cube, FACE_D, FACE_NULL);
     shift_cube_s target_cube = get_edges(&SOLVED_SHIFTCUBE, FACE_D, FACE_NULL);
 
@@ -313,7 +530,7 @@ static void xcross_stage(shift_cube_s cube, alg_s **best,
         shift_cube_s target_pair_mask = get_f2l_pair(&SOLVED_SHIFTCUBE, pair);
         shift_cube_s start_cube       = ored_cube(&mask_cube, &cube_pair_mask);
         shift_cube_s goal_cube        = ored_cube(&target_cube, &target_pair_mask);
-        alg_s *xcross_alg             = xcross_search(&start_cube, &goal_cube);
+        alg_s *xcross_alg             = xcross_search(ctx, &start_cube, &goal_cube);
         if (!xcross_alg) {
             return;
         }
@@ -321,29 +538,112 @@ static void xcross_stage(shift_cube_s cube, alg_s **best,
         shift_cube_s new_cube = cube;
         apply_alg(&new_cube, xcross_alg);
         alg_s *f2l_solve = alg_create(10);
-        f2l_stage(new_cube, best, xcross_alg, f2l_solve, f2l_table, ll_table, 3);
+        f2l_stage(new_cube, ctx, xcross_alg, f2l_solve, ctx->f2l_table, ctx->ll_table, 3);
         alg_free(f2l_solve);
         alg_free(xcross_alg);
     }
 }
 
-alg_s* solve_cube(shift_cube_s cube, const cube_table_s *f2l_table, const cube_alg_table_s *ll_table) {
-    if (!f2l_table || !ll_table) {
+size_t solve_cube_candidates(solver_ctx_s *ctx, shift_cube_s cube, alg_s **candidates) {
+    if (!ctx->f2l_table || !ctx->ll_table) {
         printf("No F2L or last layer table was provided!");
     }
 
-    alg_s *best_solve = NULL;
-    xcross_stage(cube, &best_solve, f2l_table, ll_table);
-    cube_alg_table_clear(xcross_start_ct);
-    cube_alg_table_clear(xcross_end_ct);
+    solve_started(ctx);
+    if (ctx->budget_ms) {
+        xcross_stage_shortest_first(ctx, cube);
+    } else {
+        xcross_stage(ctx, cube);
+    }
+    cube_alg_table_clear(ctx->xcross_start_ct);
+    cube_alg_table_clear(ctx->xcross_end_ct);
 
-    if (best_solve == NULL) printf("Failed to find a solution, cube was probably invalid.\n");
+    memcpy(candidates, ctx->candidates, ctx->num_candidates*sizeof(alg_s*));
+    return ctx->num_candidates;
+}
 
-    return best_solve;
+alg_s* solve_cube(solver_ctx_s *ctx, shift_cube_s cube) {
+    alg_s *candidates[SOLVER_MAX_CANDIDATES];
+    size_t num_candidates = solve_cube_candidates(ctx, cube, candidates);
+    for (size_t i = 1; i < num_candidates; i++) {
+        alg_free(candidates[i]);
+    }
+    return num_candidates ? candidates[0] : NULL;
+}
+
+alg_s* solve_cube_deadline(solver_ctx_s *ctx, shift_cube_s cube, uint32_t budget_ms) {
+    uint32_t ctx_budget_ms = ctx->budget_ms;
+    ctx->budget_ms = budget_ms;
+    alg_s *solve = solve_cube(ctx, cube);
+    ctx->budget_ms = ctx_budget_ms;
+    return solve;
+}
+
+// searches the pairs' xcrosses side by side a depth at a time like
+// xcross_stage_shortest_first. Once any pair's meets, every pair has been
+// searched to that depth, so the shortest of the ones that met there is the
+// shortest xcross of any pair
+alg_s* solve_cube_xcross(solver_ctx_s *ctx, shift_cube_s cube) {
+    shift_cube_s mask_cube   = get_edges(&cube, FACE_D, FACE_NULL);
+    shift_cube_s target_cube = get_edges(&SOLVED_SHIFTCUBE, FACE_D, FACE_NULL);
+
+    shift_cube_s start_cubes[4], end_cubes[4];
+    alg_s *start_algs[4], *end_algs[4];
+    for (uint8_t pair = 0; pair < 4; pair++) {
+        shift_cube_s cube_pair_mask   = get_f2l_pair(&cube, pair);
+        shift_cube_s target_pair_mask = get_f2l_pair(&SOLVED_SHIFTCUBE, pair);
+        start_cubes[pair] = ored_cube(&mask_cube, &cube_pair_mask);
+        end_cubes[pair]   = ored_cube(&target_cube, &target_pair_mask);
+        start_algs[pair]  = alg_create(5);
+        end_algs[pair]    = alg_create(5);
+    }
+
+    // the budget covers solve_cube_from_xcross as well
+    solve_started(ctx);
+    alg_s *xcross_alg = NULL;
+    for (uint8_t depth = 0; depth <= 5 && !xcross_alg && !ctx->out_of_time; depth++) {
+        for (uint8_t pair = 0; pair < 4 && !ctx->out_of_time; pair++) {
+            int found = xcross_search_depth(ctx, &start_cubes[pair], &end_cubes[pair], &start_algs[pair], &end_algs[pair], depth);
+            if (found != 1) continue;
+
+            alg_s *pair_alg = xcross_join(start_algs[pair], end_algs[pair]);
+            start_algs[pair] = end_algs[pair] = NULL;
+            if (pair_alg && (!xcross_alg || pair_alg->length < xcross_alg->length)) {
+                alg_free(xcross_alg);
+                xcross_alg = pair_alg;
+            } else {
+                alg_free(pair_alg);
+            }
+        }
+    }
+    cube_alg_table_clear(ctx->xcross_start_ct);
+    cube_alg_table_clear(ctx->xcross_end_ct);
+
+    for (uint8_t pair = 0; pair < 4; pair++) {
+        alg_free(start_algs[pair]);
+        alg_free(end_algs[pair]);
+    }
+    return xcross_alg;
+}
+
+alg_s* solve_cube_from_xcross(solver_ctx_s *ctx, shift_cube_s cube) {
+    alg_s *xsolve    = alg_create(0);
+    alg_s *f2l_solve = alg_create(10);
+    ctx->num_candidates = 0;
+    ctx->out_of_time = false;
+    f2l_stage(cube, ctx, xsolve, f2l_solve, ctx->f2l_table, ctx->ll_table, 3);
+    alg_free(f2l_solve);
+    alg_free(xsolve);
+
+    for (uint8_t i = 1; i < ctx->num_candidates; i++) {
+        alg_free(ctx->candidates[i]);
+    }
+    return ctx->num_candidates ? ctx->candidates[0] : NULL;
 }
 
 cube_alg_table_s* gen_last_layer_table() {
-    cube_alg_table_s *ll_table = cube_alg_table_create(131009);
+    // sized for the 62208 1lll states, it grows if the file has more
+    cube_alg_table_s *ll_table = cube_alg_table_create(62208);
     alg_list_s *ll_algs = alg_list_from_file(LL_PATH);
 
     for (size_t i = 0; i < ll_algs->num_algs; i++) {
@@ -359,7 +659,8 @@ cube_alg_table_s* gen_last_layer_table() {
 }
 
 cube_table_s* gen_f2l_table() {
-    cube_table_s *f2l_table = cube_table_create(2909);
+    // sized for the 1532 F2L cases in the file, it grows if there are more
+    cube_table_s *f2l_table = cube_table_create(1532);
     alg_list_s *f2l_algs = alg_list_from_file(F2L_PATH);
 
     const shift_cube_s solved_f2l_bits = masked_cube(&SOLVED_SHIFTCUBE, &f2l_4mask);
@@ -382,3 +683,15 @@ cube_table_s* gen_f2l_table() {
     alg_list_free(f2l_algs);
     return f2l_table;
 }
+
+// the load functions prefer the compiled table images and fall back to
+// generating the tables from the text algorithm files
+cube_alg_table_s* load_last_layer_table() {
+    cube_alg_table_s *ll_table = cube_alg_table_from_image(LL_IMAGE_PATH, LL_PATH);
+    return ll_table ? ll_table : gen_last_layer_table();
+}
+
+cube_table_s* load_f2l_table() {
+    cube_table_s *f2l_table = cube_table_from_image(F2L_IMAGE_PATH, F2L_PATH);
+    return f2l_table ? f2l_table : gen_f2l_table();
+}
@@ -7,22 +7,51 @@
 #include "cube_table.h"
 #include "cube_alg_table.h"
 
-bool init_solver();
-void cleanup_solver();
+// most distinct solves solve_cube_candidates can keep
+#define SOLVER_MAX_CANDIDATES 16
+
+// scratch tables for one solve at a time, see solver.c
+typedef struct solver_ctx solver_ctx_s;
+
+solver_ctx_s* solver_ctx_create(const cube_table_s *f2l_table, const cube_alg_table_s *ll_table);
+void solver_ctx_free(solver_ctx_s *ctx);
+// keep up to max_candidates solves that are at most length_slack moves longer
+// than the shortest, 1 and 0 by default
+bool solver_ctx_set_candidates(solver_ctx_s *ctx, uint8_t max_candidates, uint8_t length_slack);
+// gives every solve budget_ms before it settles for the best solve found so far,
+// 0 lets solves run to completion as they do by default
+void solver_ctx_set_deadline(solver_ctx_s *ctx, uint32_t budget_ms);
+// writes a timestamped line to log whenever a solve finds a shorter solution,
+// NULL turns it off again
+void solver_ctx_log_improvements(solver_ctx_s *ctx, FILE *log);
 
 int stage_recursion(shift_cube_s *cube, const shift_cube_s *mask, const shift_cube_s *goal, alg_s *moves, uint8_t depth);
 alg_s* solve_stage(shift_cube_s cube, shift_cube_s mask);
 
-int bidirectional_recursion(shift_cube_s *cube, cube_alg_table_s *our_ct, 
+// returns 1 once it meets other_ct, and -1 if ctx, which may be NULL, ran out of time
+int bidirectional_recursion(solver_ctx_s *ctx, shift_cube_s *cube, cube_alg_table_s *our_ct,
                             cube_alg_table_s *other_ct, alg_s *moves, uint8_t depth);
 alg_s* bidirectional_search(const shift_cube_s *start, const shift_cube_s *goal, uint8_t max_depth);
 
 alg_s* solve_cross(shift_cube_s cube);
 
-alg_s* solve_cube(shift_cube_s cube, const cube_table_s *f2l_table, const cube_alg_table_s *ll_table);
+alg_s* solve_cube(solver_ctx_s *ctx, shift_cube_s cube);
+// solve_cube with budget_ms instead of ctx's own deadline. Only returns later than
+// that if no solve at all was found in time
+alg_s* solve_cube_deadline(solver_ctx_s *ctx, shift_cube_s cube, uint32_t budget_ms);
+// fills candidates with the distinct solves ctx keeps, shortest first, and
+// returns how many there are. The caller owns them
+size_t solve_cube_candidates(solver_ctx_s *ctx, shift_cube_s cube, alg_s **candidates);
+// the two halves of solve_cube, for starting on the xcross before the rest is
+// found. Only the shortest xcross of the four pairs is tried, so together they
+// can come out a few moves longer than solve_cube
+alg_s* solve_cube_xcross(solver_ctx_s *ctx, shift_cube_s cube);
+alg_s* solve_cube_from_xcross(solver_ctx_s *ctx, shift_cube_s cube_after_xcross);
 alg_s* solve_f2l(shift_cube_s cube);
 
 cube_table_s* gen_f2l_table();
 cube_alg_table_s* gen_last_layer_table();
+cube_table_s* load_f2l_table();
+cube_alg_table_s* load_last_layer_table();
 
 #endif // SOLVER_H
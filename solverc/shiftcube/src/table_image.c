@@ -0,0 +1,128 @@
+#define _GNU_SOURCE
+#include "table_image.h"
+#include "move.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint32_t fnv1a(const uint8_t *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool table_image_write(const char *path, table_image_kind_e kind, uint32_t num_records,
+                       uint32_t table_size, const void *payload, size_t payload_size) {
+    table_image_header_s header = {
+        .version = TABLE_IMAGE_VERSION,
+        .kind = kind,
+        .payload_size = payload_size,
+        .checksum = fnv1a(payload, payload_size),
+        .num_records = num_records,
+        .table_size = table_size,
+    };
+    memcpy(header.magic, TABLE_IMAGE_MAGIC, sizeof(header.magic));
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        printf("Couldn't open %s for writing\n", path);
+        return false;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                   fwrite(payload, 1, payload_size, fp) == payload_size;
+    if (fclose(fp) != 0 || !written) {
+        printf("Failed to write table image %s\n", path);
+        remove(path);
+        return false;
+    }
+    return true;
+}
+
+// an image older than the text it was compiled from is treated as missing
+static bool image_is_stale(const struct stat *image_stat, const char *const *source_paths, size_t num_sources) {
+    for (size_t i = 0; i < num_sources; i++) {
+        struct stat source_stat;
+        if (stat(source_paths[i], &source_stat) == 0 && source_stat.st_mtime > image_stat->st_mtime) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// only the header is checked, running the checksum would read every page of the
+// payload and make loading as slow as reading the whole file
+table_image_s* table_image_map(const char *path, table_image_kind_e kind,
+                               const char *const *source_paths, size_t num_sources) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    struct stat image_stat;
+    if (fstat(fd, &image_stat) == -1 || image_stat.st_size < sizeof(table_image_header_s) ||
+        image_is_stale(&image_stat, source_paths, num_sources)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *mapping = mmap(NULL, image_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+
+    const table_image_header_s *header = mapping;
+    const uint8_t *payload = (const uint8_t*)mapping + sizeof(table_image_header_s);
+    if (memcmp(header->magic, TABLE_IMAGE_MAGIC, sizeof(header->magic)) ||
+        header->version != TABLE_IMAGE_VERSION || header->kind != kind ||
+        header->payload_size != image_stat.st_size - sizeof(table_image_header_s)) {
+        fprintf(stderr, "Ignoring invalid or outdated table image %s\n", path);
+        munmap(mapping, image_stat.st_size);
+        return NULL;
+    }
+
+    table_image_s *image = (table_image_s*)malloc(sizeof(table_image_s));
+    image->mapping = mapping;
+    image->mapping_size = image_stat.st_size;
+    image->header = header;
+    image->payload = payload;
+    return image;
+}
+
+bool table_image_verify(const char *path, table_image_kind_e kind) {
+    table_image_s *image = table_image_map(path, kind, NULL, 0);
+    if (image == NULL) {
+        printf("%s is missing or has an invalid header\n", path);
+        return false;
+    }
+
+    bool valid = image->header->checksum == fnv1a(image->payload, image->header->payload_size);
+    if (!valid) {
+        printf("%s doesn't match its checksum\n", path);
+    }
+    table_image_unmap(image);
+    return valid;
+}
+
+bool table_image_moves_valid(const table_image_s *image, size_t offset, size_t length) {
+    size_t payload_size = image->header->payload_size;
+    if (offset > payload_size || length > payload_size - offset) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (image->payload[offset + i] >= NUM_MOVES) return false;
+    }
+    return true;
+}
+
+void table_image_unmap(table_image_s *image) {
+    if (image == NULL) return;
+    munmap(image->mapping, image->mapping_size);
+    free(image);
+}
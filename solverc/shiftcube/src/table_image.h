@@ -0,0 +1,48 @@
+#ifndef TABLE_IMAGE_H
+#define TABLE_IMAGE_H
+
+#include "main.h"
+
+// bump this whenever the layout of any image payload changes, images with a
+// different version are ignored and the text tables are parsed instead
+#define TABLE_IMAGE_VERSION 3
+
+static const char TABLE_IMAGE_MAGIC[8] = {'R', 'C', 'S', 'T', 'A', 'B', 'L', 'E'};
+
+typedef enum : uint32_t {
+    TABLE_IMAGE_LL,
+    TABLE_IMAGE_F2L,
+    TABLE_IMAGE_INTER_MOVE,
+    NUM_TABLE_IMAGES
+} table_image_kind_e;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint64_t payload_size;
+    uint32_t checksum;      // FNV-1a of the payload
+    uint32_t num_records;
+    uint32_t table_size;    // number of slots the table was hashed into
+    uint8_t reserved[28];
+} table_image_header_s; // 64 bytes, so a mapped payload starts on a cache line
+
+typedef struct table_image {
+    void *mapping;
+    size_t mapping_size;
+    const table_image_header_s *header;
+    const uint8_t *payload;
+} table_image_s;
+
+bool table_image_write(const char *path, table_image_kind_e kind, uint32_t num_records,
+                       uint32_t table_size, const void *payload, size_t payload_size);
+table_image_s* table_image_map(const char *path, table_image_kind_e kind,
+                               const char *const *source_paths, size_t num_sources);
+// reads the whole payload to check it against the header's checksum, which
+// table_image_map skips
+bool table_image_verify(const char *path, table_image_kind_e kind);
+// false unless the length moves at offset are all inside the payload and all real moves
+bool table_image_moves_valid(const table_image_s *image, size_t offset, size_t length);
+void table_image_unmap(table_image_s *image);
+
+#endif // TABLE_IMAGE_H
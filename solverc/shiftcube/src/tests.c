@@ -1,5 +1,7 @@
 #include "tests.h"
 
+#include <math.h>
+#include <string.h>
 #include <time.h>
 
 #define NUM_TESTS 9
@@ -163,10 +165,9 @@ void test_cube18B_moves() {
 }
 
 void test_cube_solve(const char** scrambles, int num_tests) {
-    init_solver();
-
     cube_table_s *f2l_table = gen_f2l_table();
     cube_alg_table_s *last_layer_table = gen_last_layer_table();
+    solver_ctx_s *ctx = solver_ctx_create(f2l_table, last_layer_table);
 //    print_alg_length_frequencies(last_layer_table);
 
     alg_s *alg = NULL;
@@ -179,7 +180,7 @@ void test_cube_solve(const char** scrambles, int num_tests) {
         alg = alg_from_alg_str(scrambles[test]);
         printf("Testing scramble: %s\n", scrambles[test]);
         apply_alg(&cube, alg);
-        alg_s *solve = solve_cube(cube, f2l_table, last_layer_table);
+        alg_s *solve = solve_cube(ctx, cube);
         apply_alg(&cube, solve);
         if (!compare_cubes(&cube, &SOLVED_SHIFTCUBE)) {
             printf("It didn't solve it, this is bad...\n");
@@ -194,10 +195,9 @@ void test_cube_solve(const char** scrambles, int num_tests) {
     printf("Average solve length: %f\n", sum / num_tests);
     printf("\n");
 
+    solver_ctx_free(ctx);
     cube_table_free(f2l_table);
     cube_alg_table_free(last_layer_table);
-
-    cleanup_solver();
 }
 
 void test_simplifier_1case(char* algstr, char* simplifiedalgstr) {
@@ -260,12 +260,104 @@ void test_servoCoderC(const char** scrambles, size_t num_tests) {
     inter_move_table_free(INTER_MOVE_TABLE);
 }
 
+// the layered compiler has to come up with exactly the servocode of the dijkstra one
+void test_servoCoder_layered(const char** scrambles, size_t num_tests) {
+    inter_move_table_s* INTER_MOVE_TABLE = inter_move_table_create();
+    for (size_t i = 0; i < num_tests; i++) {
+        alg_s* alg = alg_from_alg_str(scrambles[i]);
+        RobotSolution fastest = servoCode_compiler_Ofastest(alg, INTER_MOVE_TABLE);
+        RobotSolution layered = servoCode_compiler_layered(alg, INTER_MOVE_TABLE);
+        bool same = (fastest.size == layered.size);
+        for (size_t j = 0; same && j < fastest.size; j++) {
+            same = (RobotState_to_uint16t(&fastest.solution[j]) == RobotState_to_uint16t(&layered.solution[j]));
+        }
+        if (!same) {
+            printf("Layered servocode differs for: %s\n", scrambles[i]);
+        }
+        alg_free(alg);
+        free(fastest.solution);
+        free(layered.solution);
+    }
+    inter_move_table_free(INTER_MOVE_TABLE);
+}
+
+void test_solve_deadline(const char** scrambles, size_t num_tests) {
+    cube_table_s *f2l_table = gen_f2l_table();
+    cube_alg_table_s *last_layer_table = gen_last_layer_table();
+    solver_ctx_s *ctx = solver_ctx_create(f2l_table, last_layer_table);
+
+    for (size_t test = 0; test < num_tests; test++) {
+        shift_cube_s scrambled = SOLVED_SHIFTCUBE;
+        alg_s *alg = alg_from_alg_str(scrambles[test]);
+        apply_alg(&scrambled, alg);
+        alg_s *solve = solve_cube(ctx, scrambled);
+
+        // even a budget that's gone before the first solve is found has to solve it
+        for (uint32_t budget_ms = 1; budget_ms <= 1000; budget_ms *= 10) {
+            alg_s *hurried = solve_cube_deadline(ctx, scrambled, budget_ms);
+            shift_cube_s cube = scrambled;
+            if (hurried) apply_alg(&cube, hurried);
+            if (!hurried || !compare_cubes(&cube, &SOLVED_SHIFTCUBE)) {
+                printf("A %ums deadline didn't solve: %s\n", budget_ms, scrambles[test]);
+            } else if (budget_ms == 1000 && hurried->length != solve->length) {
+                printf("A %ums deadline found %hhu moves instead of %hhu for: %s\n", budget_ms, hurried->length, solve->length, scrambles[test]);
+            }
+            alg_free(hurried);
+        }
+        alg_free(solve);
+        alg_free(alg);
+    }
+
+    solver_ctx_free(ctx);
+    cube_table_free(f2l_table);
+    cube_alg_table_free(last_layer_table);
+}
+
+void test_servo_stream(const char** scrambles, size_t num_tests) {
+    inter_move_table_s* INTER_MOVE_TABLE = inter_move_table_create();
+    for (size_t i = 0; i < num_tests; i++) {
+        alg_s* alg = alg_from_alg_str(scrambles[i]);
+        RobotSolution layered = servoCode_compiler_layered(alg, INTER_MOVE_TABLE);
+
+        // one chunk over the whole alg is just the layered compile
+        servo_stream_s* stream = servo_stream_create(INTER_MOVE_TABLE);
+        servo_stream_feed(stream, alg);
+        RobotSolution whole = servo_stream_next(stream, UINT8_MAX, UINT8_MAX);
+        bool same = (whole.size == layered.size);
+        for (size_t j = 0; same && j < whole.size; j++) {
+            same = (RobotState_to_uint16t(&whole.solution[j]) == RobotState_to_uint16t(&layered.solution[j]));
+        }
+        if (!same) {
+            printf("Whole stream servocode differs for: %s\n", scrambles[i]);
+        }
+        free(whole.solution);
+        servo_stream_free(stream);
+
+        // chunks that can still see the end of the alg can't lose any time
+        stream = servo_stream_create(INTER_MOVE_TABLE);
+        servo_stream_feed(stream, alg);
+        float duration = 0;
+        for (RobotSolution chunk = servo_stream_next(stream, 3, UINT8_MAX); chunk.solution; chunk = servo_stream_next(stream, 3, UINT8_MAX)) {
+            duration += chunk.duration;
+            free(chunk.solution);
+        }
+        if (fabsf(duration - layered.duration) > 1e-3) {
+            printf("Chunked stream takes %f instead of %f for: %s\n", duration, layered.duration, scrambles[i]);
+        }
+        servo_stream_free(stream);
+
+        alg_free(alg);
+        free(layered.solution);
+    }
+    inter_move_table_free(INTER_MOVE_TABLE);
+}
+
 void test_solve_and_compile(const char** scrambles, size_t num_tests) {
-    init_solver();
     inter_move_table_s* INTER_MOVE_TABLE = inter_move_table_create();
 
     cube_table_s *f2l_table = gen_f2l_table();
     cube_alg_table_s *last_layer_table = gen_last_layer_table();
+    solver_ctx_s *ctx = solver_ctx_create(f2l_table, last_layer_table);
 
     alg_s *alg = NULL;
     shift_cube_s cube = SOLVED_SHIFTCUBE;
@@ -277,7 +369,7 @@ void test_solve_and_compile(const char** scrambles, size_t num_tests) {
         alg = alg_from_alg_str(scrambles[test]);
         printf("Testing scramble: %s\n", scrambles[test]);
         apply_alg(&cube, alg);
-        alg_s *solve = solve_cube(cube, f2l_table, last_layer_table);
+        alg_s *solve = solve_cube(ctx, cube);
         apply_alg(&cube, solve);
         if (!compare_cubes(&cube, &SOLVED_SHIFTCUBE)) {
             printf("It didn't solve it, this is bad...\n");
@@ -298,13 +390,56 @@ void test_solve_and_compile(const char** scrambles, size_t num_tests) {
     printf("Average solve length: %f\n", sum_algLengths / NUM_TESTS);
     printf("\n");
 
+    solver_ctx_free(ctx);
     cube_table_free(f2l_table);
     cube_alg_table_free(last_layer_table);
 
-    cleanup_solver();
     inter_move_table_free(INTER_MOVE_TABLE);
 }
 
+// every candidate has to solve the cube, be distinct and stay within the slack
+void test_solve_candidates(const char** scrambles, size_t num_tests) {
+    cube_table_s *f2l_table = gen_f2l_table();
+    cube_alg_table_s *last_layer_table = gen_last_layer_table();
+    solver_ctx_s *ctx = solver_ctx_create(f2l_table, last_layer_table);
+    solver_ctx_set_candidates(ctx, 8, 2);
+
+    for (size_t test = 0; test < num_tests; test++) {
+        shift_cube_s scrambled = SOLVED_SHIFTCUBE;
+        alg_s *alg = alg_from_alg_str(scrambles[test]);
+        apply_alg(&scrambled, alg);
+        alg_s *candidates[SOLVER_MAX_CANDIDATES];
+        size_t num_candidates = solve_cube_candidates(ctx, scrambled, candidates);
+        if (num_candidates == 0 || num_candidates > 8) {
+            printf("Got %zu candidates for: %s\n", num_candidates, scrambles[test]);
+        }
+        for (size_t i = 0; i < num_candidates; i++) {
+            shift_cube_s cube = scrambled;
+            apply_alg(&cube, candidates[i]);
+            if (!compare_cubes(&cube, &SOLVED_SHIFTCUBE)) {
+                printf("Candidate %zu didn't solve: %s\n", i, scrambles[test]);
+            }
+            if (candidates[i]->length < candidates[0]->length || candidates[i]->length > candidates[0]->length + 2) {
+                printf("Candidate %zu is out of order or past the slack for: %s\n", i, scrambles[test]);
+            }
+            for (size_t j = 0; j < i; j++) {
+                if (candidates[i]->length == candidates[j]->length &&
+                    !memcmp(candidates[i]->moves, candidates[j]->moves, candidates[i]->length*sizeof(move_t))) {
+                    printf("Candidates %zu and %zu are the same for: %s\n", j, i, scrambles[test]);
+                }
+            }
+        }
+        for (size_t i = 0; i < num_candidates; i++) {
+            alg_free(candidates[i]);
+        }
+        alg_free(alg);
+    }
+
+    solver_ctx_free(ctx);
+    cube_table_free(f2l_table);
+    cube_alg_table_free(last_layer_table);
+}
+
 void test_1LLL() {
     cube_alg_table_s *last_layer_table = gen_last_layer_table();
     LL_table_diagnostics(last_layer_table);
@@ -327,3 +462,97 @@ void test_LL_improvements() {
     cube_alg_table_free(uniq_1LLLs);
     cube_alg_table_free(last_layer_table);
 }
+
+static bool algs_equal(const alg_s *a, const alg_s *b) {
+    return a->length == b->length && !memcmp(a->moves, b->moves, a->length);
+}
+
+// the tables mapped from an image have to find the same algs as the tables
+// they were written from
+// overwrites the first offset of a slot's value, the way a torn write would
+static bool corrupt_image_slot(const char *path, size_t capacity, size_t slot_size, size_t idx) {
+    FILE *file = fopen(path, "r+b");
+    if (!file) return false;
+    uint32_t bad_offset = UINT32_MAX - 1;
+    long pos = (long)(sizeof(table_image_header_s) + hash_table_groups_size(capacity) +
+                      idx * slot_size + sizeof(shift_cube_s));
+    bool written = fseek(file, pos, SEEK_SET) == 0 && fwrite(&bad_offset, sizeof(bad_offset), 1, file) == 1;
+    fclose(file);
+    return written;
+}
+
+void test_table_images() {
+    const char *f2l_path = "test_f2l_image.bin";
+    const char *ll_path = "test_ll_image.bin";
+    cube_table_s *f2l_table = gen_f2l_table();
+    cube_alg_table_s *last_layer_table = gen_last_layer_table();
+    if (!cube_table_write_image(f2l_table, f2l_path) || !cube_alg_table_write_image(last_layer_table, ll_path)) {
+        printf("Couldn't write the table images\n");
+        return;
+    }
+
+    cube_table_s *f2l_image = cube_table_from_image(f2l_path, F2L_PATH);
+    cube_alg_table_s *ll_image = cube_alg_table_from_image(ll_path, LL_PATH);
+    if (!f2l_image || !ll_image) {
+        printf("Couldn't map the table images\n");
+        return;
+    }
+    if (cube_table_entries(f2l_image) != cube_table_entries(f2l_table) ||
+        cube_alg_table_entries(ll_image) != cube_alg_table_entries(last_layer_table)) {
+        printf("The table images have the wrong number of entries\n");
+    }
+
+    for (size_t idx = 0; idx < f2l_table->map.capacity; idx++) {
+        if (!cube_map_slot_used(&f2l_table->map, idx)) continue;
+        const alg_list_s *list = &f2l_table->map.slots[idx].value;
+        cube_table_algs_s algs;
+        if (!cube_table_get(f2l_image, &f2l_table->map.slots[idx].key, &algs) || algs.num_algs != list->num_algs) {
+            printf("F2L image is missing the algs of entry %zu\n", idx);
+            continue;
+        }
+        for (size_t i = 0; i < algs.num_algs; i++) {
+            alg_s alg = cube_table_alg(&algs, i);
+            if (!algs_equal(&alg, &list->list[i])) printf("F2L image has the wrong alg %zu of entry %zu\n", i, idx);
+        }
+    }
+
+    for (size_t idx = 0; idx < last_layer_table->map.capacity; idx++) {
+        if (!cube_alg_map_slot_used(&last_layer_table->map, idx)) continue;
+        alg_s alg;
+        if (!cube_alg_table_get(ll_image, &last_layer_table->map.slots[idx].key, &alg) ||
+            !algs_equal(&alg, &last_layer_table->map.slots[idx].value)) {
+            printf("LL image has the wrong alg for entry %zu\n", idx);
+        }
+    }
+
+    size_t f2l_slot = 0;
+    while (!cube_image_map_slot_used(&f2l_image->image_map, f2l_slot)) f2l_slot++;
+    size_t ll_slot = 0;
+    while (!cube_alg_image_map_slot_used(&ll_image->image_map, ll_slot)) ll_slot++;
+    size_t f2l_capacity = f2l_image->image_map.capacity;
+    size_t ll_capacity = ll_image->image_map.capacity;
+    cube_table_free(f2l_image);
+    cube_alg_table_free(ll_image);
+
+    // a corrupt slot has to make the loader fall back instead of reading past the payload
+    if (!corrupt_image_slot(f2l_path, f2l_capacity, sizeof(cube_image_map_slot_s), f2l_slot) ||
+        !corrupt_image_slot(ll_path, ll_capacity, sizeof(cube_alg_image_map_slot_s), ll_slot)) {
+        printf("Couldn't corrupt the table images\n");
+    } else {
+        f2l_image = cube_table_from_image(f2l_path, F2L_PATH);
+        ll_image = cube_alg_table_from_image(ll_path, LL_PATH);
+        if (f2l_image) {
+            printf("Mapped a corrupt F2L image\n");
+            cube_table_free(f2l_image);
+        }
+        if (ll_image) {
+            printf("Mapped a corrupt LL image\n");
+            cube_alg_table_free(ll_image);
+        }
+    }
+
+    cube_table_free(f2l_table);
+    cube_alg_table_free(last_layer_table);
+    remove(f2l_path);
+    remove(ll_path);
+}
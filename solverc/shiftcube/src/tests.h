@@ -19,7 +19,12 @@ void test_cube_solve(const char** scrambles, int NUM_TESTS);
 void test_simplifier_1case(char* algstr, char* simplifiedalgstr);
 void test_simplifer();
 void test_servoCoderC(const char** scrambles, size_t NUM_TESTS);
+void test_servoCoder_layered(const char** scrambles, size_t NUM_TESTS);
+void test_solve_candidates(const char** scrambles, size_t NUM_TESTS);
+void test_servo_stream(const char** scrambles, size_t NUM_TESTS);
+void test_solve_deadline(const char** scrambles, size_t NUM_TESTS);
 void test_solve_and_compile(const char** scrambles, size_t NUM_TESTS);
 void test_LL_improvements();
+void test_table_images();
 
 #endif // TESTS_H